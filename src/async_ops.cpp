@@ -0,0 +1,92 @@
+#include "async_ops.h"
+
+#include <chrono>
+#include <utility>
+
+uint64_t AsyncOps::begin() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t id = m_nextId++;
+    m_ops.emplace(id, Op{});
+    return id;
+}
+
+bool AsyncOps::complete(uint64_t opId, StdLogosResult result) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_ops.find(opId);
+        if (it == m_ops.end() || it->second.done) {
+            return false;
+        }
+        it->second.done = true;
+        it->second.result = result;
+
+        m_unclaimed.push_back(opId);
+        ++m_unclaimedCount;
+        while (m_unclaimedCount > kMaxUnclaimed && !m_unclaimed.empty()) {
+            auto victim = m_ops.find(m_unclaimed.front());
+            m_unclaimed.pop_front();
+            if (victim != m_ops.end() && victim->second.done) {
+                m_ops.erase(victim);
+                --m_unclaimedCount;
+            }
+        }
+        // Taken ids stay queued until eviction reaches them; rebuild once they
+        // outnumber the live ones so a caller that always takes cannot grow it.
+        if (m_unclaimed.size() > 2 * kMaxUnclaimed) {
+            std::deque<uint64_t> live;
+            for (uint64_t id : m_unclaimed) {
+                auto op = m_ops.find(id);
+                if (op != m_ops.end() && op->second.done) live.push_back(id);
+            }
+            m_unclaimed.swap(live);
+        }
+    }
+    m_cond.notify_all();
+
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    if (m_listener) {
+        m_listener(opId, result);
+    }
+    return true;
+}
+
+AsyncOps::Take AsyncOps::take(uint64_t opId, int64_t timeoutMs, StdLogosResult& out) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_ops.find(opId);
+    if (it == m_ops.end()) {
+        return Take::Unknown;
+    }
+    if (!it->second.done) {
+        auto settled = [&] {
+            it = m_ops.find(opId);
+            return it == m_ops.end() || it->second.done;
+        };
+        const auto wait = std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0);
+        if (!m_cond.wait_for(lock, wait, settled)) {
+            return Take::Pending;
+        }
+        // Evicted while we waited: another caller's burst pushed it out.
+        if (it == m_ops.end()) {
+            return Take::Unknown;
+        }
+    }
+    out = std::move(it->second.result);
+    m_ops.erase(it);
+    --m_unclaimedCount;
+    return Take::Done;
+}
+
+void AsyncOps::setListener(Listener listener) {
+    std::lock_guard<std::recursive_mutex> lock(m_listenerMutex);
+    m_listener = std::move(listener);
+}
+
+size_t AsyncOps::pendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ops.size() - m_unclaimedCount;
+}
+
+size_t AsyncOps::unclaimedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_unclaimedCount;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+#include "logos_result.h"
+
+// Results of the *Async ops. Each op gets an id up front; its reply lands here
+// from whichever thread nim-ffi answers on, and waits until operationResult()
+// takes it. A caller that only listens for operationCompleted never takes its
+// results, so unclaimed ones are evicted oldest-first past a fixed bound.
+class AsyncOps {
+public:
+    using Listener = std::function<void(uint64_t opId, const StdLogosResult& result)>;
+
+    /// Registers a pending op and returns its id. Ids start at 1, so 0 never
+    /// names an op.
+    uint64_t begin();
+
+    /// Stores the op's result and hands it to the listener. A second completion
+    /// of the same id, or one for an evicted id, is ignored and returns false;
+    /// cancelling an op is completing it early.
+    bool complete(uint64_t opId, StdLogosResult result);
+
+    enum class Take { Done, Pending, Unknown };
+
+    /// Waits up to timeoutMs (0 polls) for the op to complete. On Done the
+    /// result moves into `out` and the id is forgotten.
+    Take take(uint64_t opId, int64_t timeoutMs, StdLogosResult& out);
+
+    /// Called once per completion, outside the result lock. Clearing it waits
+    /// for a call already in progress, so the owner can tear down after.
+    void setListener(Listener listener);
+
+    size_t pendingCount() const;
+
+    /// Completed results nobody took yet.
+    size_t unclaimedCount() const;
+
+    static constexpr size_t kMaxUnclaimed = 1024;
+
+private:
+    struct Op {
+        bool done = false;
+        StdLogosResult result;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::unordered_map<uint64_t, Op> m_ops;
+    // Completion order of the unclaimed results, for eviction. May hold ids
+    // already taken; those are skipped when their turn comes.
+    std::deque<uint64_t> m_unclaimed;
+    size_t m_unclaimedCount = 0;
+    uint64_t m_nextId = 1;
+
+    // Recursive: a listener that submits another async op can see it fail at
+    // submit time, which completes it on the same thread.
+    std::recursive_mutex m_listenerMutex;
+    Listener m_listener;
+};
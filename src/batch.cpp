@@ -0,0 +1,198 @@
+#include "plugin.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Results of one batch() call. Shared with the reply callbacks, which can land
+// after batch() has returned on a per-op deadline.
+struct BatchState {
+    explicit BatchState(size_t n) : results(n), done(n, false), remaining(n) {}
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<StdLogosResult> results;
+    std::vector<bool> done;
+    size_t remaining;
+
+    // First writer wins: a reply after its op's deadline is dropped, and this
+    // returns false.
+    bool complete(size_t i, StdLogosResult r) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (done[i]) return false;
+        done[i] = true;
+        results[i] = std::move(r);
+        --remaining;
+        cond.notify_all();
+        return true;
+    }
+};
+
+std::vector<std::string> strings(const json& args, const char* key) {
+    return args.at(key).get<std::vector<std::string>>();
+}
+
+std::string str(const json& args, const char* key) {
+    return args.at(key).get<std::string>();
+}
+
+}  // namespace
+
+StdLogosResult Libp2pModuleImpl::batch(const std::string& opsJson) {
+    // Each entry maps an op's JSON args onto its *Via body and reports the
+    // await it would get as a blocking call, which is its default deadline.
+    using Submit = StdLogosResult (*)(Libp2pModuleImpl&, const OpTarget&, const json&);
+    struct Entry {
+        Submit submit;
+        int64_t (*defaultTimeoutMs)(const json& args);
+    };
+    static const auto byDefault = [](const json&) -> int64_t { return kDefaultOpTimeoutMs; };
+    static const std::unordered_map<std::string, Entry> ops = {
+        {"connectPeer", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.connectPeerVia(t, str(a, "peerId"), strings(a, "multiaddrs"),
+                                     a.value("timeoutMs", int64_t(0)));
+         }, [](const json& a) -> int64_t {
+             return awaitTimeoutFor(a.value("timeoutMs", int64_t(0)));
+         }}},
+        {"disconnectPeer", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.disconnectPeerVia(t, str(a, "peerId"));
+         }, byDefault}},
+        {"dial", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.dialVia(t, str(a, "peerId"), str(a, "proto"));
+         }, byDefault}},
+        {"circuitRelayReserve", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.circuitRelayReserveVia(t, str(a, "relayPeerId"), strings(a, "relayAddrs"));
+         }, byDefault}},
+        {"dialCircuitRelay", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.dialCircuitRelayVia(t, str(a, "dstPeerId"), str(a, "multiaddr"),
+                                          str(a, "proto"));
+         }, byDefault}},
+        {"streamReadExactly", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamReadExactlyVia(t, a.at("streamId").get<uint64_t>(),
+                                           a.at("len").get<uint64_t>());
+         }, byDefault}},
+        {"streamReadLp", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamReadLpVia(t, a.at("streamId").get<uint64_t>(),
+                                      a.at("maxSize").get<uint64_t>());
+         }, byDefault}},
+        {"streamWrite", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamWriteVia(t, a.at("streamId").get<uint64_t>(), str(a, "data"));
+         }, byDefault}},
+        {"streamWriteLp", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamWriteLpVia(t, a.at("streamId").get<uint64_t>(), str(a, "data"));
+         }, byDefault}},
+        {"streamClose", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamCloseVia(t, a.at("streamId").get<uint64_t>());
+         }, byDefault}},
+        {"streamCloseWithEOF", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamCloseWithEOFVia(t, a.at("streamId").get<uint64_t>());
+         }, byDefault}},
+        {"streamRelease", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.streamReleaseVia(t, a.at("streamId").get<uint64_t>());
+         }, byDefault}},
+        {"gossipsubPublish", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.gossipsubPublishVia(t, str(a, "topic"), str(a, "data"));
+         }, byDefault}},
+        {"kadFindNode", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadFindNodeVia(t, str(a, "peerId"));
+         }, byDefault}},
+        {"kadPutValue", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadPutValueVia(t, str(a, "key"), str(a, "value"));
+         }, byDefault}},
+        {"kadGetValue", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadGetValueVia(t, str(a, "key"), a.value("quorum", int64_t(1)));
+         }, byDefault}},
+        {"kadAddProvider", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadAddProviderVia(t, str(a, "cid"));
+         }, byDefault}},
+        {"kadStartProviding", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadStartProvidingVia(t, str(a, "cid"));
+         }, byDefault}},
+        {"kadStopProviding", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadStopProvidingVia(t, str(a, "cid"));
+         }, byDefault}},
+        {"kadGetProviders", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.kadGetProvidersVia(t, str(a, "cid"));
+         }, byDefault}},
+        {"kadGetRandomRecords", {[](Libp2pModuleImpl& m, const OpTarget& t, const json&) {
+             return m.kadGetRandomRecordsVia(t);
+         }, byDefault}},
+        {"discoLookup", {[](Libp2pModuleImpl& m, const OpTarget& t, const json& a) {
+             return m.discoLookupVia(t, str(a, "serviceId"), a.value("serviceData", std::string()));
+         }, byDefault}},
+        {"discoRandomLookup", {[](Libp2pModuleImpl& m, const OpTarget& t, const json&) {
+             return m.discoRandomLookupVia(t);
+         }, byDefault}},
+    };
+
+    auto list = json::parse(opsJson, nullptr, false);
+    if (!list.is_array()) return {false, {}, "batch: expected a JSON array of ops"};
+    if (list.size() > kMaxBatchOps) {
+        return {false, {}, "batch: more than " + std::to_string(kMaxBatchOps) + " ops"};
+    }
+
+    const size_t n = list.size();
+    auto state = std::make_shared<BatchState>(n);
+    std::vector<std::string> names(n);
+    std::vector<Clock::time_point> deadlines(n);
+
+    // Submit everything before waiting on anything.
+    for (size_t i = 0; i < n; ++i) {
+        const json& item = list[i];
+        if (!item.is_object() || !item.contains("op") || !item["op"].is_string()) {
+            state->complete(i, {false, {}, "batch: op " + std::to_string(i) +
+                                               " needs {op, args?, timeoutMs?}"});
+            continue;
+        }
+        names[i] = item["op"].get<std::string>();
+        auto entry = ops.find(names[i]);
+        if (entry == ops.end()) {
+            state->complete(i, {false, {}, "batch: unknown op: " + names[i]});
+            continue;
+        }
+
+        const json args = item.value("args", json::object());
+        StdLogosResult early;
+        // A reply past the op's deadline is declined, so a dial's stream goes
+        // to the reaper.
+        OpTarget target([state, i](StdLogosResult res) { return state->complete(i, std::move(res)); });
+        try {
+            int64_t timeoutMs = item.value("timeoutMs", int64_t(0));
+            if (timeoutMs <= 0) timeoutMs = entry->second.defaultTimeoutMs(args);
+            deadlines[i] = Clock::now() + std::chrono::milliseconds(timeoutMs);
+            early = entry->second.submit(*this, target, args);
+        } catch (const std::exception& e) {
+            early = {false, {}, "batch: " + names[i] + ": bad args: " + e.what()};
+        }
+        if (!target.submitted) state->complete(i, std::move(early));
+    }
+
+    // Then wait once, until every op replied or ran past its own deadline.
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (state->remaining > 0) {
+        size_t next = n;
+        for (size_t i = 0; i < n; ++i) {
+            if (!state->done[i] && (next == n || deadlines[i] < deadlines[next])) next = i;
+        }
+        if (Clock::now() >= deadlines[next]) {
+            state->done[next] = true;
+            state->results[next] = {false, {}, "batch: " + names[next] + ": timeout"};
+            --state->remaining;
+            continue;
+        }
+        state->cond.wait_until(lock, deadlines[next]);
+    }
+
+    json out = json::array();
+    for (auto& r : state->results) {
+        out.push_back({{"success", r.success}, {"value", std::move(r.value)}, {"error", r.error}});
+    }
+    return {true, out, ""};
+}
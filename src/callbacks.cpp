@@ -41,55 +41,55 @@ json providerToJson(const ProviderInfo& p) {
 }  // namespace
 
 void Libp2pModuleImpl::cbBool(int ec, const bool*, const char* em, void* ud) {
-    finishPromise(static_cast<SyncPromise*>(ud), replyBase(ec, em));
+    finishCompletion(static_cast<Completion*>(ud), replyBase(ec, em));
 }
 
 void Libp2pModuleImpl::cbBytes(int ec, const NimFfiBytes* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.buffer = nfBytes(*reply);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbStr(int ec, const NimFfiStr* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.message = nfStr(*reply);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbRead(int ec, const ReadResponse* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.buffer = nfBytes(reply->data);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbCreate(int ec, LibP2PCtx* newCtx, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok) r.newCtx = newCtx;
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbPeerInfo(int ec, const PeerInfoResponse* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.data = peerInfoToJson(*reply);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbPeers(int ec, const PeersResponse* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.data = seqStrToJson(reply->peerIds);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbDial(int ec, const DialResponse* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.data = reply->streamId;
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbPublish(int ec, const PublishResponse* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.data = reply->peerCount;
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbProviders(int ec, const ProvidersResponse* reply, const char* em, void* ud) {
@@ -101,7 +101,7 @@ void Libp2pModuleImpl::cbProviders(int ec, const ProvidersResponse* reply, const
         }
         r.data = std::move(arr);
     }
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbRecords(int ec, const ExtendedRecordsResponse* reply, const char* em, void* ud) {
@@ -113,19 +113,19 @@ void Libp2pModuleImpl::cbRecords(int ec, const ExtendedRecordsResponse* reply, c
         }
         r.data = std::move(arr);
     }
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbRecord(int ec, const ExtendedPeerRecordEntry* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.data = recordEntryToJson(*reply);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbReservation(int ec, const ReservationResponse* reply, const char* em, void* ud) {
     auto r = replyBase(ec, em);
     if (r.ok && reply) r.data = seqStrToJson(reply->addrs);
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 void Libp2pModuleImpl::cbPeerStoreEntry(
@@ -143,7 +143,7 @@ void Libp2pModuleImpl::cbPeerStoreEntry(
         j["protoVersion"] = nfStr(reply->protoVersion);
         r.data = std::move(j);
     }
-    finishPromise(static_cast<SyncPromise*>(ud), std::move(r));
+    finishCompletion(static_cast<Completion*>(ud), std::move(r));
 }
 
 // Event listeners run on the Nim dispatch thread through a C trampoline, so a
@@ -165,17 +165,6 @@ void Libp2pModuleImpl::onPubsubMessage(const PubsubMessageEvent* evt, void* ud)
     auto* self = static_cast<Libp2pModuleImpl*>(ud);
     if (!self || !evt) return;
     try {
-        std::string topic = nfStr(evt->topic);
-        auto bytes = nfBytes(evt->data);
-        std::string payload(bytes.begin(), bytes.end());
-
-        // Serialized before the queue takes ownership of `payload`.
-        json j;
-        j["topic"] = topic;
-        j["data"] = payload;
-        std::string event = j.dump();
-
-        self->m_topicQueues.push(topic, std::move(payload));
-        self->emitEventSafe("gossipsubMessage", event);
+        self->m_pubsubDelivery.deliver(nfStr(evt->topic), evt->data.data, evt->data.len);
     } catch (...) {}
 }
@@ -0,0 +1,264 @@
+#include "completion.h"
+
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<size_t> g_inUse{0};
+std::atomic<size_t> g_abandoned{0};
+
+#if defined(__linux__)
+
+// Sleeps while *word == expected, for at most `timeout`. Spurious and early
+// returns are fine: the caller re-reads the word and recomputes the deadline.
+void parkOn(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &ts,
+            nullptr, 0);
+}
+
+void wakeAll(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+            nullptr, 0);
+}
+
+#else
+
+// No portable timed futex elsewhere, so park on one of a few striped condvars
+// keyed by the word's address. Wakers take the stripe lock, so a wake-up cannot
+// slip in between the waiter's check and its sleep.
+struct Stripe {
+    std::mutex mutex;
+    std::condition_variable cond;
+};
+
+Stripe& stripeFor(const void* addr) {
+    static Stripe stripes[64];
+    return stripes[(reinterpret_cast<uintptr_t>(addr) >> 6) % 64];
+}
+
+void parkOn(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+    auto& s = stripeFor(&word);
+    std::unique_lock<std::mutex> lock(s.mutex);
+    s.cond.wait_for(lock, timeout, [&] { return word.load(std::memory_order_acquire) != expected; });
+}
+
+void wakeAll(std::atomic<uint32_t>& word) {
+    auto& s = stripeFor(&word);
+    { std::lock_guard<std::mutex> lock(s.mutex); }
+    s.cond.notify_all();
+}
+
+#endif
+
+}  // namespace
+
+// Slabs of slots that live for the process: a late reply can land at any time,
+// so a slot's memory must never go away under it. The free list is a Treiber
+// stack of slot indices, tagged against ABA; only growing takes a lock.
+class CompletionPool {
+public:
+    static CompletionPool& instance() {
+        static CompletionPool pool;
+        return pool;
+    }
+
+    Completion* pop() {
+        for (;;) {
+            uint64_t head = m_freeHead.load(std::memory_order_acquire);
+            while (static_cast<uint32_t>(head) != 0) {
+                Completion* c = at(static_cast<uint32_t>(head) - 1);
+                const uint64_t next =
+                    ((head >> 32) + 1) << 32 | c->m_nextFree.load(std::memory_order_relaxed);
+                if (m_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire,
+                                                     std::memory_order_acquire)) {
+                    return c;
+                }
+            }
+            std::lock_guard<std::mutex> lock(m_growMutex);
+            // Another thread may have grown while we waited for the lock.
+            if (static_cast<uint32_t>(m_freeHead.load(std::memory_order_acquire)) != 0) {
+                continue;
+            }
+            return grow();
+        }
+    }
+
+    void push(Completion* c) {
+        uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+        uint64_t next;
+        do {
+            c->m_nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            next = ((head >> 32) + 1) << 32 | (c->m_index + 1);
+        } while (!m_freeHead.compare_exchange_weak(head, next, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+    }
+
+private:
+    static constexpr uint32_t kSlabSize = 256;
+    static constexpr uint32_t kMaxSlabs = 256;
+
+    std::atomic<Completion*> m_slabs[kMaxSlabs] = {};
+    uint32_t m_slabCount = 0;
+    std::mutex m_growMutex;
+    // Low 32 bits: index + 1 of the top free slot (0 = empty). High: ABA tag.
+    std::atomic<uint64_t> m_freeHead{0};
+
+    Completion* at(uint32_t index) const {
+        return &m_slabs[index / kSlabSize].load(std::memory_order_acquire)[index % kSlabSize];
+    }
+
+    // Adds a slab and returns its first slot, or nullptr once at the ceiling.
+    // Runs under m_growMutex.
+    Completion* grow() {
+        if (m_slabCount == kMaxSlabs) {
+            return nullptr;
+        }
+        auto* slab = new Completion[kSlabSize];
+        const uint32_t base = m_slabCount * kSlabSize;
+        for (uint32_t i = 0; i < kSlabSize; ++i) {
+            slab[i].m_index = base + i;
+        }
+        m_slabs[m_slabCount].store(slab, std::memory_order_release);
+        ++m_slabCount;
+        for (uint32_t i = 1; i < kSlabSize; ++i) {
+            push(&slab[i]);
+        }
+        return &slab[0];
+    }
+};
+
+Completion* Completion::acquire() {
+    Completion* c = CompletionPool::instance().pop();
+    if (!c) {
+        c = new Completion();
+    }
+    c->m_state.store(kPending, std::memory_order_relaxed);
+    c->m_refs.store(2, std::memory_order_relaxed);
+    g_inUse.fetch_add(1, std::memory_order_relaxed);
+    return c;
+}
+
+size_t Completion::inUse() {
+    return g_inUse.load(std::memory_order_relaxed);
+}
+
+size_t Completion::abandonedPending() {
+    return g_abandoned.load(std::memory_order_relaxed);
+}
+
+void Completion::resolve(SyncResult r) {
+    if (onReply) {
+        auto fn = std::move(onReply);
+        auto reap = onLate;
+        void* arg = lateArg;
+        m_state.store(kReady, std::memory_order_release);
+        unref();
+        if (!fn(r) && reap) reap(std::move(r), arg);
+        return;
+    }
+
+    m_result = std::move(r);
+    uint32_t s = m_state.load(std::memory_order_acquire);
+    while (!(s & kAbandoned)) {
+        if (m_state.compare_exchange_weak(s, kReady, std::memory_order_acq_rel,
+                                          std::memory_order_acquire)) {
+            if (s & kWaiting) wakeAll(m_state);
+            unref();
+            return;
+        }
+    }
+    // The waiter gave up, so nobody reads this reply.
+    g_abandoned.fetch_sub(1, std::memory_order_relaxed);
+    SyncResult late = std::move(m_result);
+    auto reap = onLate;
+    void* arg = lateArg;
+    unref();
+    if (reap) reap(std::move(late), arg);
+}
+
+SyncResult Completion::await(int timeoutMs) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    uint32_t s = m_state.load(std::memory_order_acquire);
+    while (s != kReady) {
+        if (s == kPending) {
+            if (!m_state.compare_exchange_weak(s, kPending | kWaiting, std::memory_order_acquire,
+                                               std::memory_order_acquire)) {
+                continue;
+            }
+            s = kPending | kWaiting;
+        }
+        const auto left = deadline - std::chrono::steady_clock::now();
+        if (left <= std::chrono::nanoseconds::zero()) break;
+        parkOn(m_state, s, std::chrono::duration_cast<std::chrono::nanoseconds>(left));
+        s = m_state.load(std::memory_order_acquire);
+    }
+
+    // Timed out, unless the reply slips in before we can abandon. Counted
+    // first, so the late reply never takes the gauge below zero.
+    if (s != kReady) {
+        g_abandoned.fetch_add(1, std::memory_order_relaxed);
+        if (m_state.compare_exchange_strong(s, kAbandoned, std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+            unref();
+            SyncResult r;
+            r.message = "timeout";
+            return r;
+        }
+        g_abandoned.fetch_sub(1, std::memory_order_relaxed);
+    }
+    SyncResult r = std::move(m_result);
+    unref();
+    return r;
+}
+
+bool Completion::cancelSubmit() {
+    if (m_state.load(std::memory_order_acquire) == kReady) {
+        // The callback already ran and dropped its reference.
+        m_result = SyncResult{};
+        unref();
+        return true;
+    }
+    // It never will, so both references are ours.
+    onReply = nullptr;
+    m_refs.store(1, std::memory_order_relaxed);
+    unref();
+    return false;
+}
+
+void Completion::detach() {
+    unref();
+}
+
+void Completion::unref() {
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        recycle();
+    }
+}
+
+void Completion::recycle() {
+    m_result = SyncResult{};
+    onReply = nullptr;
+    onLate = nullptr;
+    lateArg = nullptr;
+    g_inUse.fetch_sub(1, std::memory_order_relaxed);
+    if (m_index == kHeapIndex) {
+        delete this;
+    } else {
+        CompletionPool::instance().push(this);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <libp2p.h>
+
+// Result type for internal sync-over-async operations.
+struct SyncResult {
+    bool ok = false;
+    std::string message;
+    std::vector<uint8_t> buffer;
+    nlohmann::json data;
+    LibP2PCtx* newCtx = nullptr;
+};
+
+// One-shot slot a libp2p reply callback resolves and a bridge op waits on. It
+// replaces a heap std::promise per op: slots come from a process-wide slab pool
+// and go back to it after use, and the hand-off is one atomic state word the
+// waiter parks on with a futex (a striped condvar where there is no futex).
+//
+// The submitter and the replier each hold a reference and each drop it exactly
+// once; the last one out recycles the slot. So a waiter that times out simply
+// abandons the slot, and the late reply recycles it whenever it lands.
+class Completion {
+public:
+    /// A fresh slot holding both references. Falls back to the heap once the
+    /// pool is at its ceiling, so it never fails.
+    static Completion* acquire();
+
+    // --- Replier side (the libp2p callback), exactly once per acquire. ---
+
+    /// Publishes the reply and drops the replier's reference. On an async slot
+    /// it runs `onReply` here instead. A reply nobody takes, on an abandoned
+    /// slot or one whose `onReply` declines it, goes to `onLate` when set.
+    void resolve(SyncResult r);
+
+    // --- Submitter side, exactly one of these per acquire. ---
+
+    /// Waits up to timeoutMs for the reply. A timeout abandons the slot and
+    /// yields a failed "timeout" result.
+    SyncResult await(int timeoutMs);
+
+    /// For a submit that returned non-zero: reclaims the slot whether or not
+    /// the callback ran, and reports whether it did.
+    bool cancelSubmit();
+
+    /// For an async submit: the submitter steps away and `onReply` finishes.
+    void detach();
+
+    /// Set before submitting to make the slot async: the reply runs it on the
+    /// replying thread and nobody awaits the slot. It returns false when the
+    /// reply came too late to be wanted (e.g. the op was cancelled).
+    std::function<bool(SyncResult&)> onReply;
+
+    /// Set before submitting to reclaim what a reply nobody waits for anymore
+    /// still owns (a late context, a late stream). Runs on the replying thread
+    /// with `lateArg`, so it must only hand the work off (see LateReaper).
+    void (*onLate)(SyncResult&& late, void* arg) = nullptr;
+    void* lateArg = nullptr;
+
+    /// Slots handed out and not yet recycled, across the pool and the heap.
+    static size_t inUse();
+
+    /// Slots whose waiter timed out and whose reply has not landed yet.
+    static size_t abandonedPending();
+
+private:
+    friend class CompletionPool;
+
+    enum : uint32_t {
+        kPending = 0,
+        kReady = 1,
+        kAbandoned = 2,
+        // Or'd into kPending while the waiter is parked, so a reply only pays
+        // for a wake-up when somebody sleeps.
+        kWaiting = 4,
+    };
+
+    std::atomic<uint32_t> m_state{kPending};
+    std::atomic<uint32_t> m_refs{0};
+    SyncResult m_result;
+
+    // Pool bookkeeping: slab index (kHeapIndex for an overflow slot) and the
+    // free-list link.
+    static constexpr uint32_t kHeapIndex = UINT32_MAX;
+    uint32_t m_index = kHeapIndex;
+    std::atomic<uint32_t> m_nextFree{0};
+
+    void unref();
+    void recycle();
+};
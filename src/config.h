@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <fstream>
 #include <limits>
+#include <map>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -12,6 +13,9 @@
 
 #include <nlohmann/json.hpp>
 
+#include "event_queue.h"
+#include "topic_delivery.h"
+#include "topic_queues.h"
 #include "utils.h"
 
 struct Libp2pModuleOptions {
@@ -49,6 +53,44 @@ struct Libp2pModuleOptions {
     // larger message never fits. See TopicQueues.
     size_t gossipsubQueueMaxMessages = 1024;
     size_t gossipsubQueueMaxBytes = 4 * 1024 * 1024;
+    // All topics together; 0 lifts it. At the budget a topic over its fair
+    // share gives up its oldest messages to one under it.
+    size_t gossipsubQueueTotalMaxBytes = 256 * 1024 * 1024;
+    // Ring preallocates gossipsubQueueMaxMessages cells per topic and moves
+    // messages in and out without the topic lock.
+    TopicQueues::Backend gossipsubQueueBackend = TopicQueues::Backend::Deque;
+    // How a full queue makes room, and how long a message may wait; topics
+    // listed in gossipsubQueueTopicPolicies override the default.
+    TopicQueues::Policy gossipsubQueuePolicy = {};
+    std::map<std::string, TopicQueues::Policy> gossipsubQueueTopicPolicies = {};
+    // Bounds per topic, or per `prefix*` for every topic starting with the
+    // prefix; a name beats a prefix and a longer prefix a shorter one.
+    // gossipsubSetQueueBounds() changes them at runtime.
+    std::map<std::string, TopicQueues::Bounds> gossipsubQueueTopicBounds = {};
+    // Where a stalled topic spills what its bounds would drop, and how much
+    // disk all topics may use there; an empty dir turns spilling off.
+    std::string gossipsubQueueSpillDir = "";
+    size_t gossipsubQueueSpillMaxBytes = 1024 * 1024 * 1024;
+
+    // Events wait here for a module-owned thread to deliver them, so a slow
+    // emitEvent consumer never blocks libp2p's own threads; either bound at 0
+    // (the default) delivers on those threads instead. See EventQueue.
+    size_t eventQueueMaxEvents = 0;
+    size_t eventQueueMaxBytes = 64 * 1024 * 1024;
+    EventQueue::Overflow eventQueueOverflow = EventQueue::Overflow::DropNewest;
+
+    // Whether a topic's messages go to the gossipsubMessage event, the poll
+    // queue, both or neither; a path left out costs nothing per message.
+    // gossipsubSetDelivery() changes them at runtime.
+    TopicDelivery::Mode gossipsubDelivery = TopicDelivery::kBoth;
+    std::map<std::string, TopicDelivery::Mode> gossipsubTopicDelivery = {};
+
+    // Coalesce gossipsubMessage events per topic into one gossipsubMessages
+    // event, sent once a batch holds either many or its first message has
+    // waited the linger; 0 messages or bytes (the default) sends each alone.
+    size_t gossipsubEventBatchMaxMessages = 0;
+    size_t gossipsubEventBatchMaxBytes = 1024 * 1024;
+    int64_t gossipsubEventBatchLingerMs = 2;
 
     // Ingress limits nim-libp2p applies; 0 leaves each one at the core default.
     // The rate limit needs both bytes and interval, and it only counts hits
@@ -106,6 +148,40 @@ inline TransportType parseTransport(const nlohmann::json& j, TransportType fallb
     return fallback;
 }
 
+/// Unlike transport, an unknown backend is an error: falling back would
+/// silently change the queue's memory footprint.
+inline TopicQueues::Backend parseQueueBackend(const nlohmann::json& j,
+                                              TopicQueues::Backend fallback) {
+    auto it = j.find("gossipsubQueueBackend");
+    if (it == j.end()) {
+        return fallback;
+    }
+    const std::string b = it->is_string() ? it->get<std::string>() : std::string();
+    if (b == "deque") return TopicQueues::Backend::Deque;
+    if (b == "ring") return TopicQueues::Backend::Ring;
+    throw std::invalid_argument("gossipsubQueueBackend must be \"deque\" or \"ring\"");
+}
+
+inline TopicDelivery::Mode parseDelivery(const nlohmann::json& j, const std::string& what) {
+    TopicDelivery::Mode mode;
+    if (!j.is_string() || !TopicDelivery::parse(j.get<std::string>(), mode)) {
+        throw std::invalid_argument(what + " must be \"both\", \"event\", \"queue\" or \"none\"");
+    }
+    return mode;
+}
+
+inline EventQueue::Overflow parseEventOverflow(const nlohmann::json& j,
+                                               EventQueue::Overflow fallback) {
+    auto it = j.find("eventQueueOverflow");
+    if (it == j.end()) {
+        return fallback;
+    }
+    const std::string o = it->is_string() ? it->get<std::string>() : std::string();
+    if (o == "dropNewest") return EventQueue::Overflow::DropNewest;
+    if (o == "dropOldest") return EventQueue::Overflow::DropOldest;
+    throw std::invalid_argument("eventQueueOverflow must be \"dropNewest\" or \"dropOldest\"");
+}
+
 /// is_number_unsigned() rejects negatives and floats in one check; a negative
 /// queue bound read straight into size_t would wrap into a huge positive one,
 /// and nim-libp2p refuses a negative ingress limit. The range check keeps a
@@ -156,6 +232,49 @@ inline int64_t parseDurationMs(const nlohmann::json& j, const char* key,
     return value;
 }
 
+/// Overlays a policy object's present fields onto `fallback`. `what` names
+/// the object in errors.
+inline TopicQueues::Policy parseQueuePolicy(const nlohmann::json& j, const std::string& what,
+                                            TopicQueues::Policy fallback) {
+    if (!j.is_object()) {
+        throw std::invalid_argument(what + " must be an object");
+    }
+    if (auto it = j.find("overflow"); it != j.end()) {
+        const std::string o = it->is_string() ? it->get<std::string>() : std::string();
+        if (o == "dropNewest") {
+            fallback.overflow = TopicQueues::Overflow::DropNewest;
+        } else if (o == "dropOldest") {
+            fallback.overflow = TopicQueues::Overflow::DropOldest;
+        } else if (o == "keepLatest") {
+            fallback.overflow = TopicQueues::Overflow::KeepLatest;
+        } else {
+            throw std::invalid_argument(
+                what + ".overflow must be \"dropNewest\", \"dropOldest\" or \"keepLatest\"");
+        }
+    }
+    fallback.ttlMs = parseDurationMs(j, "ttlMs", fallback.ttlMs);
+    if (fallback.ttlMs < 0) {
+        throw std::invalid_argument(what + ".ttlMs must not be negative");
+    }
+    if (auto it = j.find("keyDelimiter"); it != j.end()) {
+        if (!it->is_string() || it->get<std::string>().empty()) {
+            throw std::invalid_argument(what + ".keyDelimiter must be a non-empty string");
+        }
+        fallback.keyDelimiter = it->get<std::string>();
+    }
+    return fallback;
+}
+
+inline TopicQueues::Bounds parseQueueBounds(const nlohmann::json& j, const std::string& what,
+                                            TopicQueues::Bounds fallback) {
+    if (!j.is_object()) {
+        throw std::invalid_argument(what + " must be an object");
+    }
+    fallback.maxMessages = parseNonNegative(j, "maxMessages", fallback.maxMessages);
+    fallback.maxBytes = parseNonNegative(j, "maxBytes", fallback.maxBytes);
+    return fallback;
+}
+
 /// Overlays present keys onto `o`. Throws nlohmann type_error on a wrong-typed
 /// field, or std::invalid_argument on an out-of-range one; load() catches both
 /// and falls back to defaults.
@@ -215,6 +334,62 @@ inline void apply(const nlohmann::json& j, Libp2pModuleOptions& o) {
         parseNonNegative(j, "gossipsubQueueMaxMessages", o.gossipsubQueueMaxMessages);
     o.gossipsubQueueMaxBytes =
         parseNonNegative(j, "gossipsubQueueMaxBytes", o.gossipsubQueueMaxBytes);
+    o.gossipsubQueueTotalMaxBytes =
+        parseNonNegative(j, "gossipsubQueueTotalMaxBytes", o.gossipsubQueueTotalMaxBytes);
+    o.gossipsubQueueBackend = parseQueueBackend(j, o.gossipsubQueueBackend);
+    if (auto it = j.find("gossipsubQueuePolicy"); it != j.end()) {
+        o.gossipsubQueuePolicy = parseQueuePolicy(*it, "gossipsubQueuePolicy", o.gossipsubQueuePolicy);
+    }
+    if (auto it = j.find("gossipsubQueueTopicPolicies"); it != j.end()) {
+        if (!it->is_object()) {
+            throw std::invalid_argument("gossipsubQueueTopicPolicies must be an object");
+        }
+        // A topic's fields default to the default policy's.
+        o.gossipsubQueueTopicPolicies.clear();
+        for (const auto& [topic, policy] : it->items()) {
+            o.gossipsubQueueTopicPolicies[topic] = parseQueuePolicy(
+                policy, "gossipsubQueueTopicPolicies." + topic, o.gossipsubQueuePolicy);
+        }
+    }
+    if (auto it = j.find("gossipsubQueueTopicBounds"); it != j.end()) {
+        if (!it->is_object()) {
+            throw std::invalid_argument("gossipsubQueueTopicBounds must be an object");
+        }
+        // A missing bound is the default one.
+        o.gossipsubQueueTopicBounds.clear();
+        for (const auto& [topic, bounds] : it->items()) {
+            o.gossipsubQueueTopicBounds[topic] = parseQueueBounds(
+                bounds, "gossipsubQueueTopicBounds." + topic,
+                {o.gossipsubQueueMaxMessages, o.gossipsubQueueMaxBytes});
+        }
+    }
+    o.gossipsubQueueSpillDir = j.value("gossipsubQueueSpillDir", o.gossipsubQueueSpillDir);
+    o.gossipsubQueueSpillMaxBytes =
+        parseNonNegative(j, "gossipsubQueueSpillMaxBytes", o.gossipsubQueueSpillMaxBytes);
+    o.eventQueueMaxEvents = parseNonNegative(j, "eventQueueMaxEvents", o.eventQueueMaxEvents);
+    o.eventQueueMaxBytes = parseNonNegative(j, "eventQueueMaxBytes", o.eventQueueMaxBytes);
+    o.eventQueueOverflow = parseEventOverflow(j, o.eventQueueOverflow);
+    if (auto it = j.find("gossipsubDelivery"); it != j.end()) {
+        o.gossipsubDelivery = parseDelivery(*it, "gossipsubDelivery");
+    }
+    if (auto it = j.find("gossipsubTopicDelivery"); it != j.end()) {
+        if (!it->is_object()) {
+            throw std::invalid_argument("gossipsubTopicDelivery must be an object");
+        }
+        o.gossipsubTopicDelivery.clear();
+        for (const auto& [topic, mode] : it->items()) {
+            o.gossipsubTopicDelivery[topic] = parseDelivery(mode, "gossipsubTopicDelivery." + topic);
+        }
+    }
+    o.gossipsubEventBatchMaxMessages =
+        parseNonNegative(j, "gossipsubEventBatchMaxMessages", o.gossipsubEventBatchMaxMessages);
+    o.gossipsubEventBatchMaxBytes =
+        parseNonNegative(j, "gossipsubEventBatchMaxBytes", o.gossipsubEventBatchMaxBytes);
+    o.gossipsubEventBatchLingerMs =
+        parseDurationMs(j, "gossipsubEventBatchLingerMs", o.gossipsubEventBatchLingerMs);
+    if (o.gossipsubEventBatchLingerMs < 0) {
+        throw std::invalid_argument("gossipsubEventBatchLingerMs must not be negative");
+    }
     o.gossipsubMaxMessageSize =
         parseNonNegative(j, "gossipsubMaxMessageSize", o.gossipsubMaxMessageSize);
     o.gossipsubOverheadRateLimitBytes =
@@ -0,0 +1,86 @@
+#include "coro.h"
+
+#if defined(__cpp_impl_coroutine)
+
+WorkerExecutor::WorkerExecutor() : m_thread([this] { run(); }) {}
+
+WorkerExecutor::~WorkerExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+void WorkerExecutor::post(std::coroutine_handle<> h) {
+    // Notified under the lock: the resumed coroutine may be the last user of
+    // this executor, and its owner must not tear it down under our feet.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(h);
+    m_cond.notify_one();
+}
+
+void WorkerExecutor::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cond.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty()) return;
+        auto h = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        h.resume();
+        lock.lock();
+    }
+}
+
+CoroTimer::~CoroTimer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_timers.clear();
+    }
+    m_cond.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+CoroTimer::Handle CoroTimer::schedule(Clock::time_point at, std::function<void()> fire) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Handle handle{at, m_nextId++};
+    const bool first = m_timers.empty() || handle < m_timers.begin()->first;
+    m_timers.emplace(handle, std::move(fire));
+    if (!m_thread.joinable()) {
+        m_thread = std::thread([this] { run(); });
+    } else if (first) {
+        m_cond.notify_one();
+    }
+    return handle;
+}
+
+void CoroTimer::cancel(const Handle& handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_timers.erase(handle);
+}
+
+void CoroTimer::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        if (m_stopping) return;
+        if (m_timers.empty()) {
+            m_cond.wait(lock);
+            continue;
+        }
+        auto next = m_timers.begin();
+        if (Clock::now() < next->first.first) {
+            m_cond.wait_until(lock, next->first.first);
+            continue;
+        }
+        auto fire = std::move(next->second);
+        m_timers.erase(next);
+        lock.unlock();
+        fire();
+        lock.lock();
+    }
+}
+
+#endif  // __cpp_impl_coroutine
@@ -0,0 +1,202 @@
+#pragma once
+
+// C++20 coroutine plumbing for the libp2p bridge: a lazy task type and the
+// executors a suspended coroutine is resumed on. The libp2p ops themselves are
+// awaited through CoroNode (coro_node.h). Nothing here is part of the module's
+// generated API, and it compiles to nothing below C++20.
+
+#if defined(__cpp_impl_coroutine)
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+// Where an awaited libp2p op resumes its coroutine once the reply lands.
+class CoroExecutor {
+public:
+    virtual ~CoroExecutor() = default;
+    virtual void post(std::coroutine_handle<> h) = 0;
+};
+
+// Resumes right on the replying thread, which is one of the library's own. The
+// cheapest choice, but the coroutine must then never block: a blocking
+// (non-co_await) libp2p call from there can wait on the thread it runs on.
+class InlineExecutor final : public CoroExecutor {
+public:
+    void post(std::coroutine_handle<> h) override { h.resume(); }
+};
+
+// Resumes on one worker thread it owns, in arrival order, so the coroutines
+// it drives never run concurrently with each other. The destructor finishes
+// what is queued before joining.
+class WorkerExecutor final : public CoroExecutor {
+public:
+    WorkerExecutor();
+    ~WorkerExecutor() override;
+
+    WorkerExecutor(const WorkerExecutor&) = delete;
+    WorkerExecutor& operator=(const WorkerExecutor&) = delete;
+
+    void post(std::coroutine_handle<> h) override;
+
+    /// True on the worker thread itself.
+    bool onWorker() const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::coroutine_handle<>> m_queue;
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    void run();
+};
+
+// Runs callbacks at a point in time, on one thread it starts with the first
+// one scheduled, so an awaited op can be given up on without a thread waiting
+// for it. The destructor drops what has not fired yet.
+class CoroTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Handle = std::pair<Clock::time_point, uint64_t>;
+
+    CoroTimer() = default;
+    ~CoroTimer();
+
+    CoroTimer(const CoroTimer&) = delete;
+    CoroTimer& operator=(const CoroTimer&) = delete;
+
+    /// `fire` runs on the timer thread once `at` has passed, unless cancelled
+    /// first. Callbacks due together run in the order they were scheduled.
+    Handle schedule(Clock::time_point at, std::function<void()> fire);
+
+    /// Drops a callback that has not started yet; a no-op once it has.
+    void cancel(const Handle& handle);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::map<Handle, std::function<void()>> m_timers;
+    uint64_t m_nextId = 0;
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    void run();
+};
+
+// A lazily started coroutine yielding a T. Awaiting it runs it and resumes the
+// awaiter when it finishes; spawn() or blockOn() start one from plain code.
+template <class T>
+class CoroTask {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        CoroTask get_return_object() {
+            return CoroTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().continuation;
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template <class U>
+        void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    CoroTask(CoroTask&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    CoroTask& operator=(CoroTask&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    CoroTask(const CoroTask&) = delete;
+    CoroTask& operator=(const CoroTask&) = delete;
+    ~CoroTask() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        m_handle.promise().continuation = awaiter;
+        return m_handle;
+    }
+    T await_resume() {
+        auto& p = m_handle.promise();
+        if (p.error) std::rethrow_exception(p.error);
+        return std::move(*p.value);
+    }
+
+private:
+    explicit CoroTask(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace coro_detail {
+
+// Fire-and-forget frame that owns the task it drives and frees itself at the
+// end, so spawn() needs no handle kept alive by the caller.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <class T, class Done>
+Detached runDetached(CoroTask<T> task, Done done) {
+    done(co_await std::move(task));
+}
+
+}  // namespace coro_detail
+
+/// Starts `task` on the calling thread; it runs until its first suspension and
+/// then wherever its awaited ops resume it. `done` gets the result there. An
+/// exception escaping the task terminates, as with std::thread.
+template <class T, class Done>
+void spawn(CoroTask<T> task, Done&& done) {
+    coro_detail::runDetached(std::move(task), std::forward<Done>(done));
+}
+
+/// Runs `task` to completion, blocking the calling thread until it finishes.
+/// For tests and for sync callers at the edge of a coroutine pipeline; never
+/// call it on the executor thread the task resumes on.
+template <class T>
+T blockOn(CoroTask<T> task) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::optional<T> out;
+    spawn(std::move(task), [&](T v) {
+        std::lock_guard<std::mutex> lock(mutex);
+        out.emplace(std::move(v));
+        cond.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&] { return out.has_value(); });
+    return std::move(*out);
+}
+
+#endif  // __cpp_impl_coroutine
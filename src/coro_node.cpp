@@ -0,0 +1,230 @@
+#include "coro_node.h"
+
+#include <algorithm>
+
+#if defined(__cpp_impl_coroutine)
+
+using json = nlohmann::json;
+
+bool CoroNode::Op::await_suspend(std::coroutine_handle<> h) {
+    auto state = m_state = std::make_shared<State>();
+    auto finish = [state, &node = m_node, h](StdLogosResult res, bool fromTimer) {
+        if (state->claimed.exchange(true, std::memory_order_acq_rel)) return false;
+        if (!fromTimer) {
+            std::lock_guard<std::mutex> lock(state->timerMutex);
+            if (state->timer) node.m_timer.cancel(*state->timer);
+        }
+        state->result = std::move(res);
+        if (state->raced.exchange(true, std::memory_order_acq_rel)) node.m_executor.post(h);
+        return true;
+    };
+    Libp2pModuleImpl::OpTarget target([finish](StdLogosResult res) { return finish(std::move(res), false); });
+    target.deadline = m_deadline;
+    auto early = m_start(target);
+    if (!target.submitted) {
+        state->result = std::move(early);
+        return false;
+    }
+    if (m_deadline != std::chrono::steady_clock::time_point{}) {
+        auto handle = m_node.m_timer.schedule(m_deadline, [finish] {
+            finish(StdLogosResult{false, {}, "deadline exceeded"}, true);
+        });
+        // A reply that already claimed the result cancels nothing; do it here.
+        std::lock_guard<std::mutex> lock(state->timerMutex);
+        if (state->claimed.load(std::memory_order_acquire)) {
+            m_node.m_timer.cancel(handle);
+        } else {
+            state->timer = handle;
+        }
+    }
+    // A reply that beat us here already stored its result; carry on inline.
+    return !state->raced.exchange(true, std::memory_order_acq_rel);
+}
+
+CoroNode::Op CoroNode::connectPeer(std::string peerId, std::vector<std::string> multiaddrs,
+                                   int64_t timeoutMs) {
+    return Op(*this, [this, peerId = std::move(peerId), multiaddrs = std::move(multiaddrs),
+                           timeoutMs](const auto& t) {
+        return m_module.connectPeerVia(t, peerId, multiaddrs, timeoutMs);
+    });
+}
+
+CoroNode::Op CoroNode::disconnectPeer(std::string peerId) {
+    return Op(*this, [this, peerId = std::move(peerId)](const auto& t) {
+        return m_module.disconnectPeerVia(t, peerId);
+    });
+}
+
+CoroNode::Op CoroNode::dial(std::string peerId, std::string proto) {
+    return Op(*this, [this, peerId = std::move(peerId), proto = std::move(proto)](const auto& t) {
+        return m_module.dialVia(t, peerId, proto);
+    });
+}
+
+CoroNode::Op CoroNode::circuitRelayReserve(std::string relayPeerId,
+                                           std::vector<std::string> relayAddrs) {
+    return Op(*this, [this, relayPeerId = std::move(relayPeerId),
+                           relayAddrs = std::move(relayAddrs)](const auto& t) {
+        return m_module.circuitRelayReserveVia(t, relayPeerId, relayAddrs);
+    });
+}
+
+CoroNode::Op CoroNode::dialCircuitRelay(std::string dstPeerId, std::string multiaddr,
+                                        std::string proto) {
+    return Op(*this, [this, dstPeerId = std::move(dstPeerId), multiaddr = std::move(multiaddr),
+                           proto = std::move(proto)](const auto& t) {
+        return m_module.dialCircuitRelayVia(t, dstPeerId, multiaddr, proto);
+    });
+}
+
+CoroNode::Op CoroNode::streamReadExactly(uint64_t streamId, uint64_t len) {
+    return Op(*this, [this, streamId, len](const auto& t) {
+        return m_module.streamReadExactlyVia(t, streamId, len);
+    });
+}
+
+CoroNode::Op CoroNode::streamReadLp(uint64_t streamId, uint64_t maxSize) {
+    return Op(*this, [this, streamId, maxSize](const auto& t) {
+        return m_module.streamReadLpVia(t, streamId, maxSize);
+    });
+}
+
+CoroNode::Op CoroNode::streamWrite(uint64_t streamId, std::string data) {
+    return Op(*this, [this, streamId, data = std::move(data)](const auto& t) {
+        return m_module.streamWriteVia(t, streamId, data);
+    });
+}
+
+CoroNode::Op CoroNode::streamWriteLp(uint64_t streamId, std::string data) {
+    return Op(*this, [this, streamId, data = std::move(data)](const auto& t) {
+        return m_module.streamWriteLpVia(t, streamId, data);
+    });
+}
+
+CoroNode::Op CoroNode::streamClose(uint64_t streamId) {
+    return Op(*this, [this, streamId](const auto& t) {
+        return m_module.streamCloseVia(t, streamId);
+    });
+}
+
+CoroNode::Op CoroNode::streamCloseWithEOF(uint64_t streamId) {
+    return Op(*this, [this, streamId](const auto& t) {
+        return m_module.streamCloseWithEOFVia(t, streamId);
+    });
+}
+
+CoroNode::Op CoroNode::streamRelease(uint64_t streamId) {
+    return Op(*this, [this, streamId](const auto& t) {
+        return m_module.streamReleaseVia(t, streamId);
+    });
+}
+
+CoroNode::Op CoroNode::gossipsubPublish(std::string topic, std::string data) {
+    return Op(*this, [this, topic = std::move(topic), data = std::move(data)](const auto& t) {
+        return m_module.gossipsubPublishVia(t, topic, data);
+    });
+}
+
+CoroNode::Op CoroNode::kadFindNode(std::string peerId) {
+    return Op(*this, [this, peerId = std::move(peerId)](const auto& t) {
+        return m_module.kadFindNodeVia(t, peerId);
+    });
+}
+
+CoroNode::Op CoroNode::kadPutValue(std::string key, std::string value) {
+    return Op(*this, [this, key = std::move(key), value = std::move(value)](const auto& t) {
+        return m_module.kadPutValueVia(t, key, value);
+    });
+}
+
+CoroNode::Op CoroNode::kadGetValue(std::string key, int64_t quorum) {
+    return Op(*this, [this, key = std::move(key), quorum](const auto& t) {
+        return m_module.kadGetValueVia(t, key, quorum);
+    });
+}
+
+CoroNode::Op CoroNode::kadAddProvider(std::string cid) {
+    return Op(*this, [this, cid = std::move(cid)](const auto& t) {
+        return m_module.kadAddProviderVia(t, cid);
+    });
+}
+
+CoroNode::Op CoroNode::kadStartProviding(std::string cid) {
+    return Op(*this, [this, cid = std::move(cid)](const auto& t) {
+        return m_module.kadStartProvidingVia(t, cid);
+    });
+}
+
+CoroNode::Op CoroNode::kadStopProviding(std::string cid) {
+    return Op(*this, [this, cid = std::move(cid)](const auto& t) {
+        return m_module.kadStopProvidingVia(t, cid);
+    });
+}
+
+CoroNode::Op CoroNode::kadGetProviders(std::string cid) {
+    return Op(*this, [this, cid = std::move(cid)](const auto& t) {
+        return m_module.kadGetProvidersVia(t, cid);
+    });
+}
+
+CoroNode::Op CoroNode::kadGetRandomRecords() {
+    return Op(*this, [this](const auto& t) {
+        return m_module.kadGetRandomRecordsVia(t);
+    });
+}
+
+CoroNode::Op CoroNode::discoLookup(std::string serviceId, std::string serviceData) {
+    return Op(*this, [this, serviceId = std::move(serviceId),
+                           serviceData = std::move(serviceData)](const auto& t) {
+        return m_module.discoLookupVia(t, serviceId, serviceData);
+    });
+}
+
+CoroNode::Op CoroNode::discoRandomLookup() {
+    return Op(*this, [this](const auto& t) {
+        return m_module.discoRandomLookupVia(t);
+    });
+}
+
+CoroTask<StdLogosResult> CoroNode::request(std::string peerId, std::string proto,
+                                           std::vector<std::string> multiaddrs,
+                                           std::string request, int64_t timeoutMs,
+                                           uint64_t maxSize, bool expectResponse) {
+    const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : kDefaultOpTimeoutMs);
+
+    if (!multiaddrs.empty()) {
+        auto c = co_await connectPeer(peerId, multiaddrs,
+                                      std::max<int64_t>(remainingMs(deadline), 1)).until(deadline);
+        if (!c.success) co_return StdLogosResult{false, {}, "request: connect failed: " + c.error};
+    }
+
+    auto d = co_await dial(peerId, proto).until(deadline);
+    if (!d.success) co_return StdLogosResult{false, {}, "request: dial failed: " + d.error};
+    uint64_t streamId = 0;
+    try { streamId = d.value.get<uint64_t>(); } catch (...) {}
+    if (streamId == 0) co_return StdLogosResult{false, {}, "request: dial returned no stream"};
+
+    auto w = co_await streamWriteLp(streamId, std::move(request)).until(deadline);
+    if (!w.success) {
+        co_await streamRelease(streamId);
+        co_return StdLogosResult{false, {}, "request: write failed: " + w.error};
+    }
+
+    if (!expectResponse) {
+        co_await streamCloseWithEOF(streamId);
+        co_await streamRelease(streamId);
+        co_return StdLogosResult{true, json::object(), ""};
+    }
+
+    // Released either way, which also ends a read given up on at the deadline.
+    auto r = co_await streamReadLp(streamId, maxSize).until(deadline);
+    co_await streamRelease(streamId);
+    if (!r.success) co_return StdLogosResult{false, {}, "request: read failed: " + r.error};
+
+    json out;
+    out["responseB64"] = r.value;
+    co_return StdLogosResult{true, out, ""};
+}
+
+#endif  // __cpp_impl_coroutine
@@ -0,0 +1,126 @@
+#pragma once
+
+// Awaitable libp2p ops on a Libp2pModuleImpl:
+//
+//     CoroTask<StdLogosResult> ping(CoroNode& node, std::string peer) {
+//         auto dialed = co_await node.dial(peer, "/ipfs/ping/1.0.0");
+//         if (!dialed.success) co_return dialed;
+//         ...
+//     }
+//
+// Each op submits through the same *Via body as its blocking and *Async
+// variants, and the reply trampoline resumes the coroutine on the node's
+// executor; no thread blocks between steps. A co_await yields exactly what the
+// blocking variant would have returned.
+
+#include "coro.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "plugin.h"
+
+class CoroNode {
+public:
+    // The awaitable a CoroNode op returns. Await it once: it carries the op's
+    // arguments but submits nothing until awaited, and may be moved until then.
+    class Op {
+    public:
+        Op(Op&& other) noexcept
+            : m_node(other.m_node), m_start(std::move(other.m_start)),
+              m_deadline(other.m_deadline) {}
+
+        /// Gives up at `deadline`: the await then yields "deadline exceeded",
+        /// and the reply, whenever it lands, is declined like any late one (a
+        /// dial's stream is released). An op not yet submitted by then fails
+        /// the same way without reaching libp2p.
+        Op&& until(std::chrono::steady_clock::time_point deadline) && {
+            m_deadline = deadline;
+            return std::move(*this);
+        }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        StdLogosResult await_resume() { return std::move(m_state->result); }
+
+    private:
+        friend class CoroNode;
+        using Start = std::function<StdLogosResult(const Libp2pModuleImpl::OpTarget&)>;
+        Op(CoroNode& node, Start start) : m_node(node), m_start(std::move(start)) {}
+
+        // Shared with the reply and the deadline timer, either of which may
+        // land after the awaiting coroutine has moved on.
+        struct State {
+            StdLogosResult result;
+            // The reply or the timer, whichever claims it first, sets the result.
+            std::atomic<bool> claimed{false};
+            // Whichever of await_suspend and the claimer gets here second resumes.
+            std::atomic<bool> raced{false};
+            std::mutex timerMutex;
+            std::optional<CoroTimer::Handle> timer;
+        };
+
+        CoroNode& m_node;
+        Start m_start;
+        std::chrono::steady_clock::time_point m_deadline{};
+        std::shared_ptr<State> m_state;
+    };
+
+    /// Both must outlive every op awaited through this node.
+    CoroNode(Libp2pModuleImpl& module, CoroExecutor& executor)
+        : m_module(module), m_executor(executor) {}
+
+    Op connectPeer(std::string peerId, std::vector<std::string> multiaddrs, int64_t timeoutMs);
+    Op disconnectPeer(std::string peerId);
+    Op dial(std::string peerId, std::string proto);
+    Op circuitRelayReserve(std::string relayPeerId, std::vector<std::string> relayAddrs);
+    Op dialCircuitRelay(std::string dstPeerId, std::string multiaddr, std::string proto);
+
+    Op streamReadExactly(uint64_t streamId, uint64_t len);
+    Op streamReadLp(uint64_t streamId, uint64_t maxSize);
+    Op streamWrite(uint64_t streamId, std::string data);
+    Op streamWriteLp(uint64_t streamId, std::string data);
+    Op streamClose(uint64_t streamId);
+    Op streamCloseWithEOF(uint64_t streamId);
+    Op streamRelease(uint64_t streamId);
+
+    Op gossipsubPublish(std::string topic, std::string data);
+
+    Op kadFindNode(std::string peerId);
+    Op kadPutValue(std::string key, std::string value);
+    Op kadGetValue(std::string key, int64_t quorum);
+    Op kadAddProvider(std::string cid);
+    Op kadStartProviding(std::string cid);
+    Op kadStopProviding(std::string cid);
+    Op kadGetProviders(std::string cid);
+    Op kadGetRandomRecords();
+
+    Op discoLookup(std::string serviceId, std::string serviceData);
+    Op discoRandomLookup();
+
+    /// protocolRequest as a pipeline: connect (when multiaddrs are given), dial,
+    /// writeLp, then readLp unless expectResponse is false. Yields
+    /// `{responseB64}` like protocolRequest, and `{}` without a response.
+    /// `timeoutMs` is one deadline for every step, as for protocolRequest; a
+    /// step still running past it fails and the stream is released.
+    CoroTask<StdLogosResult> request(std::string peerId, std::string proto,
+                                     std::vector<std::string> multiaddrs, std::string request,
+                                     int64_t timeoutMs, uint64_t maxSize,
+                                     bool expectResponse = true);
+
+private:
+    Libp2pModuleImpl& m_module;
+    CoroExecutor& m_executor;
+    CoroTimer m_timer;
+};
+
+#endif  // __cpp_impl_coroutine
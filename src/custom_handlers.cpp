@@ -9,7 +9,7 @@ StdLogosResult Libp2pModuleImpl::mountProtocol(const std::string& proto) {
     if (!emitEvent) return {false, {}, "emitEvent must be set before mounting a protocol"};
     publishEmitEvent();
 
-    return callSync("Failed to mount protocol", [&](SyncPromise* p) {
+    return callSync("Failed to mount protocol", [&](Completion* p) {
         return libp2p_ctx_mount_protocol(ctx, nimffi_str(proto.c_str()),
                                         &Libp2pModuleImpl::cbBool, p);
     });
@@ -0,0 +1,134 @@
+#include "event_batcher.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+EventBatcher::EventBatcher(Flush flush) : m_flush(std::move(flush)) {}
+
+EventBatcher::~EventBatcher() {
+    stop();
+}
+
+void EventBatcher::configure(size_t maxMessages, size_t maxBytes, int64_t lingerMs) {
+    stop();
+    if (maxMessages == 0 || maxBytes == 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxMessages = maxMessages;
+    m_maxBytes = maxBytes;
+    m_linger = std::chrono::milliseconds(lingerMs < 0 ? 0 : lingerMs);
+    m_stopping = false;
+    m_running = true;
+    m_thread = std::thread([this] { run(); });
+    m_enabled.store(true, std::memory_order_release);
+}
+
+void EventBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_stopping = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // An adder may still be draining an outbox the timer thread queued on.
+    m_drained.wait(lock, [this] { return m_draining == 0; });
+    m_running = false;
+    m_enabled.store(false, std::memory_order_release);
+}
+
+bool EventBatcher::add(const std::string& topic, std::string& event) {
+    if (!m_enabled.load(std::memory_order_acquire)) return false;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_running || m_stopping) return false;
+
+    Batch& batch = m_batches[topic];
+    if (batch.count == 0) {
+        batch.json.reserve(event.size() + 2);
+        batch.json += '[';
+        batch.due = Clock::now() + m_linger;
+        // The timer thread may be asleep until a later deadline.
+        m_cond.notify_one();
+    } else {
+        batch.json += ',';
+    }
+    batch.json += event;
+    ++batch.count;
+    if (batch.count < m_maxMessages && batch.json.size() + 1 < m_maxBytes) return true;
+
+    std::string full = std::move(batch.json);
+    full += ']';
+    m_batches.erase(topic);
+    m_outboxes[topic].batches.push_back(std::move(full));
+    drain(lock, topic, SIZE_MAX);
+    return true;
+}
+
+bool EventBatcher::drain(std::unique_lock<std::mutex>& lock, const std::string& topic,
+                         size_t maxBatches) {
+    auto it = m_outboxes.find(topic);
+    if (it == m_outboxes.end() || it->second.draining) return false;
+    // Only the draining thread erases an outbox, so `box` outlives the unlocks.
+    Outbox& box = it->second;
+    box.draining = true;
+    ++m_draining;
+    for (size_t sent = 0; sent < maxBatches && !box.batches.empty(); ++sent) {
+        std::string next = std::move(box.batches.front());
+        box.batches.pop_front();
+        lock.unlock();
+        // The consumer must not take the process down from here.
+        try {
+            m_flush(std::move(next));
+        } catch (...) {}
+        lock.lock();
+    }
+    box.draining = false;
+    const bool left = !box.batches.empty();
+    if (!left) m_outboxes.erase(topic);
+    if (--m_draining == 0) m_drained.notify_all();
+    return left;
+}
+
+void EventBatcher::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // Topics with batches queued by this thread and not yet flushed.
+    std::vector<std::string> due;
+    for (;;) {
+        auto next = Clock::time_point::max();
+        const auto now = Clock::now();
+        for (auto it = m_batches.begin(); it != m_batches.end();) {
+            if (m_stopping || it->second.due <= now) {
+                // Queued before any unlock, so no later batch can pass it.
+                auto& batches = m_outboxes[it->first].batches;
+                batches.push_back(std::move(it->second.json));
+                batches.back() += ']';
+                if (std::find(due.begin(), due.end(), it->first) == due.end()) {
+                    due.push_back(it->first);
+                }
+                it = m_batches.erase(it);
+            } else {
+                if (it->second.due < next) next = it->second.due;
+                ++it;
+            }
+        }
+        if (!due.empty()) {
+            // One batch per topic per pass, so neither a slow consumer nor a
+            // topic refilling meanwhile keeps the others waiting for long.
+            size_t kept = 0;
+            for (size_t i = 0; i < due.size(); ++i) {
+                if (!drain(lock, due[i], 1)) continue;
+                if (kept != i) due[kept] = std::move(due[i]);
+                ++kept;
+            }
+            due.resize(kept);
+            continue;
+        }
+        if (m_stopping) return;
+        if (next == Clock::time_point::max()) {
+            m_cond.wait(lock);
+        } else {
+            m_cond.wait_until(lock, next);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Coalesces serialized gossipsubMessage events per topic into one JSON array,
+// so a busy topic costs one event, and one IPC hop, per batch instead of per
+// message. A batch goes out once it holds `maxMessages` events or `maxBytes`
+// bytes of JSON, from the thread that filled it, or once its first event has
+// waited `lingerMs`, from a module-owned timer thread. Either way a topic's
+// batches go out in order. A slow flush never blocks add() on another topic;
+// the timer thread takes one batch per topic in turn, so it delays the other
+// topics' lingering batches by that one flush, not by a whole backlog.
+//
+// Off by default: add() then refuses every event and the caller emits it alone.
+class EventBatcher {
+public:
+    /// Receives a batch as a JSON array of the events added, oldest first.
+    /// Called on the timer thread or on whichever add() thread closes or finds
+    /// a batch of the topic waiting, never twice at once for one topic. What
+    /// it throws is dropped.
+    using Flush = std::function<void(std::string batch)>;
+
+    explicit EventBatcher(Flush flush);
+    ~EventBatcher();
+
+    EventBatcher(const EventBatcher&) = delete;
+    EventBatcher& operator=(const EventBatcher&) = delete;
+
+    /// Stops batching, then starts again with these limits unless
+    /// `maxMessages` or `maxBytes` is 0. A linger of 0 flushes whatever the
+    /// timer thread finds, as soon as it finds it. Never call it from a flush:
+    /// it waits for the timer thread to finish.
+    void configure(size_t maxMessages, size_t maxBytes, int64_t lingerMs);
+
+    /// Flushes every open batch, then joins the timer thread; add() refuses
+    /// events from then on. Same caveat as configure().
+    void stop();
+
+    /// Appends `event`, a JSON object, to `topic`'s open batch. Returns false,
+    /// leaving `event` alone, when batching is off.
+    bool add(const std::string& topic, std::string& event);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Batch {
+        std::string json;
+        size_t count = 0;
+        Clock::time_point due;
+    };
+
+    // Batches closed but not yet flushed for one topic. Whichever thread finds
+    // the outbox idle flushes from it outside m_mutex, add() until it is empty
+    // and the timer thread one batch per pass; everyone else just queues
+    // behind it, so the topic's batches keep their order.
+    struct Outbox {
+        std::deque<std::string> batches;
+        bool draining = false;
+    };
+
+    void run();
+    // Flushes up to `maxBatches` of `topic`'s outbox, unless another thread
+    // already is. Returns true when batches are left for the caller to come
+    // back to. Called and returns with `lock` held on m_mutex.
+    bool drain(std::unique_lock<std::mutex>& lock, const std::string& topic, size_t maxBatches);
+
+    const Flush m_flush;
+    // Read without the lock on every add, so the unbatched path stays cheap.
+    std::atomic<bool> m_enabled{false};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    // Open batches by topic; an entry is erased when its batch goes out.
+    std::unordered_map<std::string, Batch> m_batches;
+    size_t m_maxMessages = 0;
+    size_t m_maxBytes = 0;
+    Clock::duration m_linger{};
+    bool m_running = false;
+    bool m_stopping = false;
+    std::thread m_thread;
+    // Outboxes by topic; an entry is erased once it drains empty.
+    std::unordered_map<std::string, Outbox> m_outboxes;
+    // Outboxes being drained; stop() waits for it to reach 0.
+    size_t m_draining = 0;
+    std::condition_variable m_drained;
+};
@@ -0,0 +1,110 @@
+#include "event_queue.h"
+
+#include <utility>
+
+EventQueue::EventQueue(Deliver deliver) : m_deliver(std::move(deliver)) {}
+
+EventQueue::~EventQueue() {
+    stop();
+}
+
+void EventQueue::configure(size_t maxEvents, size_t maxBytes, Overflow overflow) {
+    stop();
+    if (maxEvents == 0 || maxBytes == 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxEvents = maxEvents;
+    m_maxBytes = maxBytes;
+    m_overflow = overflow;
+    m_stopping = false;
+    m_running = true;
+    m_thread = std::thread([this] { run(); });
+    m_threaded.store(true, std::memory_order_release);
+}
+
+void EventQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_stopping = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+    m_threaded.store(false, std::memory_order_release);
+}
+
+bool EventQueue::post(const std::string& name, std::string data) {
+    if (m_threaded.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // Stopped since the check above: fall through to inline delivery.
+        if (m_running && !m_stopping) {
+            const size_t size = data.size();
+            // An event over the byte bound would evict everything and still
+            // not fit.
+            if (size > m_maxBytes) {
+                countDrop(kFull);
+                return false;
+            }
+            while (m_events.size() >= m_maxEvents || m_bytes + size > m_maxBytes) {
+                if (m_overflow == Overflow::DropNewest) {
+                    countDrop(kFull);
+                    return false;
+                }
+                m_bytes -= m_events.front().data.size();
+                m_events.pop_front();
+                countDrop(kEvicted);
+            }
+            m_bytes += size;
+            m_events.push_back(Event{name, std::move(data)});
+            lock.unlock();
+            m_cond.notify_one();
+            return true;
+        }
+    }
+    m_deliver(name, data);
+    return true;
+}
+
+size_t EventQueue::depth() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events.size();
+}
+
+std::vector<Metric> EventQueue::metrics() const {
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return {};
+        queued = m_events.size();
+    }
+    static const char* const kReasons[kDropReasons] = {"full", "evicted"};
+    std::vector<Metric> series;
+    series.push_back(Metric{"libp2p_module_event_queue_depth", "gauge",
+                            "events waiting for the dispatcher thread", {},
+                            static_cast<double>(queued)});
+    for (size_t r = 0; r < kDropReasons; ++r) {
+        series.push_back(Metric{"libp2p_module_event_queue_dropped_total", "counter",
+                                "events dropped from the dispatcher queue, by reason",
+                                {{"reason", kReasons[r]}},
+                                static_cast<double>(m_dropped[r].load(std::memory_order_relaxed))});
+    }
+    return series;
+}
+
+void EventQueue::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cond.wait(lock, [this] { return !m_events.empty() || m_stopping; });
+        if (m_events.empty()) return;
+        Event event = std::move(m_events.front());
+        m_events.pop_front();
+        m_bytes -= event.data.size();
+        lock.unlock();
+        // The consumer must not take the process down from here either.
+        try {
+            m_deliver(event.name, event.data);
+        } catch (...) {}
+        lock.lock();
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metric.h"
+
+// Hands events from the library's threads to one module-owned thread that
+// delivers them, so a slow emitEvent consumer stalls this queue instead of
+// libp2p's event loop (heartbeats, mesh upkeep, every other connection).
+//
+// Off by default: post() then delivers on the calling thread, as before. Once
+// started, the queue is bounded by events and by bytes, like a topic queue,
+// and a full queue drops the new event or evicts the oldest one, counting
+// either. Events are delivered one at a time in the order they were posted.
+class EventQueue {
+public:
+    enum class Overflow { DropNewest, DropOldest };
+
+    using Deliver = std::function<void(const std::string& name, const std::string& data)>;
+
+    explicit EventQueue(Deliver deliver);
+    ~EventQueue();
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    /// Stops the dispatcher, then starts a new one with these bounds unless
+    /// either is 0, which leaves delivery on the posting thread. Never call it
+    /// from a delivery: it waits for the dispatcher to finish.
+    void configure(size_t maxEvents, size_t maxBytes, Overflow overflow);
+
+    /// Delivers every event still queued, then joins the dispatcher; later
+    /// events are delivered on the posting thread. Same caveat as configure().
+    void stop();
+
+    /// Queues the event, or delivers it right away while no dispatcher runs.
+    /// Returns false when the bounds dropped it instead.
+    bool post(const std::string& name, std::string data);
+
+    /// Events queued and not yet handed to the consumer.
+    size_t depth() const;
+
+    /// Empty while no dispatcher runs; the drop counters survive a restart.
+    std::vector<Metric> metrics() const;
+
+private:
+    enum DropReason { kFull, kEvicted, kDropReasons };
+
+    struct Event {
+        std::string name;
+        std::string data;
+    };
+
+    void run();
+    void countDrop(DropReason reason) {
+        m_dropped[reason].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const Deliver m_deliver;
+    // Read without the lock on every post, so delivery stays inline and
+    // lock-free while the queue is off.
+    std::atomic<bool> m_threaded{false};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Event> m_events;
+    size_t m_bytes = 0;
+    size_t m_maxEvents = 0;
+    size_t m_maxBytes = 0;
+    Overflow m_overflow = Overflow::DropNewest;
+    bool m_running = false;
+    bool m_stopping = false;
+    std::thread m_thread;
+    std::array<std::atomic<uint64_t>, kDropReasons> m_dropped{};
+};
@@ -1,35 +1,99 @@
 #include "plugin.h"
 
+namespace {
+
+// A message taken from a topic's queue, in the encoding the topic was
+// subscribed with.
+nlohmann::json encodedMessage(std::string&& msg, TopicDelivery::Encoding encoding) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(msg.data());
+    switch (encoding) {
+    case TopicDelivery::kBase64:
+        return base64Encode(bytes, msg.size());
+    case TopicDelivery::kCbor:
+        return nlohmann::json::binary(cborByteString(bytes, msg.size()));
+    case TopicDelivery::kText:
+        break;
+    }
+    return std::move(msg);
+}
+
+}  // namespace
+
 StdLogosResult Libp2pModuleImpl::gossipsubPublish(
     const std::string& topic, const std::string& data)
+{
+    return gossipsubPublishVia(OpMode::Sync, topic, data);
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubPublishAsync(
+    const std::string& topic, const std::string& data)
+{
+    return gossipsubPublishVia(OpMode::Async, topic, data);
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubPublishCbor(
+    const std::string& topic, const std::vector<uint8_t>& data)
+{
+    return gossipsubPublishVia(OpMode::Sync, topic, nimffiBytes(data));
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubPublishVia(
+    const OpTarget& target, const std::string& topic, const std::string& data)
+{
+    return gossipsubPublishVia(target, topic, nimffiBytes(data));
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubPublishVia(
+    const OpTarget& target, const std::string& topic, NimFfiBytes data)
 {
     PublishRequest req{};
     req.topic = nimffi_str(topic.c_str());
-    req.data = nimffiBytes(data);
-    return callSync("Failed to publish", [&](SyncPromise* p) {
+    req.data = data;
+    return callWith(target, "Failed to publish", [&](Completion* p) {
         return libp2p_ctx_gossipsub_publish(ctx, &req, &Libp2pModuleImpl::cbPublish, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::gossipsubSubscribe(const std::string& topic) {
+    return gossipsubSubscribeAs(topic, TopicDelivery::kText);
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubSubscribeEncoded(const std::string& topic,
+                                                           const std::string& encoding) {
+    TopicDelivery::Encoding parsed;
+    if (!TopicDelivery::parseEncoding(encoding, parsed)) {
+        return {false, {}, "encoding must be text, base64 or cbor"};
+    }
+    return gossipsubSubscribeAs(topic, parsed);
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubSubscribeAs(const std::string& topic,
+                                                      TopicDelivery::Encoding encoding) {
     if (!ctx) return {false, {}, "No libp2p context"};
     // Delivered messages surface through the on_pubsub_message listener, which
     // needs the emit snapshot published to forward gossipsubMessage events.
     publishEmitEvent();
-    return callSync("Failed to subscribe", [&](SyncPromise* p) {
+    // Set first so the first message already arrives encoded; a failed
+    // subscribe puts the old encoding back.
+    const auto previous = m_topicDelivery.routeFor(topic).encoding;
+    m_topicDelivery.setEncoding(topic, encoding);
+    auto res = callSync("Failed to subscribe", [&](Completion* p) {
         return libp2p_ctx_gossipsub_subscribe(ctx, nimffi_str(topic.c_str()),
                                               &Libp2pModuleImpl::cbBool, p);
     });
+    if (!res.success) m_topicDelivery.setEncoding(topic, previous);
+    return res;
 }
 
 StdLogosResult Libp2pModuleImpl::gossipsubUnsubscribe(const std::string& topic) {
     if (!ctx) return {false, {}, "No libp2p context"};
-    auto res = callSync("Failed to unsubscribe", [&](SyncPromise* p) {
+    auto res = callSync("Failed to unsubscribe", [&](Completion* p) {
         return libp2p_ctx_gossipsub_unsubscribe(ctx, nimffi_str(topic.c_str()),
                                                 &Libp2pModuleImpl::cbBool, p);
     });
     if (res.success) {
         m_topicQueues.release(topic);
+        m_topicDelivery.setEncoding(topic, TopicDelivery::kText);
     }
     return res;
 }
@@ -39,5 +103,72 @@ StdLogosResult Libp2pModuleImpl::gossipsubNextMessage(const std::string& topic,
     if (!m_topicQueues.pop(topic, timeoutMs, msg)) {
         return {false, {}, "timeout waiting for message"};
     }
-    return {true, msg, ""};
+    return {true, encodedMessage(std::move(msg), m_topicDelivery.routeFor(topic).encoding), ""};
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubNextMessages(const std::string& topic, int64_t maxCount,
+                                                       int64_t maxBytes, int64_t timeoutMs) {
+    if (maxCount <= 0) return {false, {}, "maxCount must be positive"};
+    if (maxBytes < 0) return {false, {}, "maxBytes must not be negative"};
+    std::vector<std::string> msgs;
+    if (m_topicQueues.popMany(topic, timeoutMs, static_cast<size_t>(maxCount),
+                              static_cast<size_t>(maxBytes), msgs) == 0) {
+        return {false, {}, "timeout waiting for message"};
+    }
+    const auto encoding = m_topicDelivery.routeFor(topic).encoding;
+    if (encoding == TopicDelivery::kText) return {true, std::move(msgs), ""};
+    nlohmann::json value = nlohmann::json::array();
+    for (auto& msg : msgs) value.push_back(encodedMessage(std::move(msg), encoding));
+    return {true, std::move(value), ""};
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubNextMessageAny(const std::vector<std::string>& topics,
+                                                         int64_t timeoutMs) {
+    if (topics.empty()) return {false, {}, "topics must not be empty"};
+    std::string topic;
+    std::string msg;
+    if (!m_topicQueues.popAny(topics, timeoutMs, topic, msg)) {
+        return {false, {}, "timeout waiting for message"};
+    }
+    auto data = encodedMessage(std::move(msg), m_topicDelivery.routeFor(topic).encoding);
+    return {true, {{"topic", std::move(topic)}, {"data", std::move(data)}}, ""};
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubSetQueueBounds(const std::string& topic,
+                                                         int64_t maxMessages, int64_t maxBytes) {
+    if (maxMessages < 0) return {false, {}, "maxMessages must not be negative"};
+    if (maxBytes < 0) return {false, {}, "maxBytes must not be negative"};
+    // An empty topic retunes the defaults every other topic falls back to.
+    if (topic.empty()) {
+        m_topicQueues.setBounds(static_cast<size_t>(maxMessages), static_cast<size_t>(maxBytes));
+    } else {
+        m_topicQueues.setTopicBounds(
+            topic, {static_cast<size_t>(maxMessages), static_cast<size_t>(maxBytes)});
+    }
+    return {true, {}, ""};
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubClearQueueBounds(const std::string& topic) {
+    if (!m_topicQueues.clearTopicBounds(topic)) return {false, {}, "no bounds set for topic"};
+    return {true, {}, ""};
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubSetDelivery(const std::string& topic,
+                                                      const std::string& mode) {
+    TopicDelivery::Mode parsed;
+    if (!TopicDelivery::parse(mode, parsed)) {
+        return {false, {}, "mode must be both, event, queue or none"};
+    }
+    // Like the queue bounds, an empty topic sets the default.
+    if (topic.empty()) {
+        m_topicDelivery.setDefault(parsed);
+    } else {
+        m_topicDelivery.set(topic, parsed);
+    }
+    return {true, {}, ""};
+}
+
+StdLogosResult Libp2pModuleImpl::gossipsubClearDelivery(const std::string& topic) {
+    if (!m_topicDelivery.clear(topic)) return {false, {}, "no delivery mode set for topic"};
+    return {true, {}, ""};
 }
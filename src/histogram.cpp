@@ -0,0 +1,52 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+Histogram::Histogram(std::vector<double> bounds)
+    : m_bounds(std::move(bounds)),
+      m_buckets(new std::atomic<uint64_t>[m_bounds.size() + 1]) {
+    for (size_t i = 0; i <= m_bounds.size(); ++i) {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double v) {
+    // Bounds are inclusive upper bounds, like the `le` they are exported as.
+    const size_t i = std::lower_bound(m_bounds.begin(), m_bounds.end(), v) - m_bounds.begin();
+    m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+    double sum = m_sum.load(std::memory_order_relaxed);
+    while (!m_sum.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {
+    }
+}
+
+Metric Histogram::snapshot(std::string name, std::string help,
+                           std::map<std::string, std::string> labels) const {
+    Metric m;
+    m.name = std::move(name);
+    m.type = "histogram";
+    m.help = std::move(help);
+    m.labels = std::move(labels);
+    m.buckets.reserve(m_bounds.size() + 1);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i <= m_bounds.size(); ++i) {
+        cumulative += m_buckets[i].load(std::memory_order_relaxed);
+        m.buckets.push_back(MetricBucket{
+            i < m_bounds.size() ? m_bounds[i] : std::numeric_limits<double>::infinity(),
+            cumulative});
+    }
+    m.count = cumulative;
+    m.sum = m_sum.load(std::memory_order_relaxed);
+    m.value = static_cast<double>(m.count);
+    return m;
+}
+
+std::vector<double> Histogram::exponentialBounds(double start, double factor, size_t n) {
+    std::vector<double> bounds;
+    bounds.reserve(n);
+    for (double b = start; bounds.size() < n; b *= factor) {
+        bounds.push_back(b);
+    }
+    return bounds;
+}
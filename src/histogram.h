@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "metric.h"
+
+// Fixed-bucket histogram that hot paths record into without a lock: observe()
+// is a binary search over the bounds plus two relaxed atomic updates. A
+// snapshot reads the buckets one by one, so it may miss an observation racing
+// with it, but its buckets, sum and count always agree closely enough for a
+// scrape.
+class Histogram {
+public:
+    /// `bounds` are the finite bucket upper bounds, ascending; a +Inf bucket is
+    /// always added after them.
+    explicit Histogram(std::vector<double> bounds);
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void observe(double v);
+
+    /// The histogram as one "histogram" series.
+    Metric snapshot(std::string name, std::string help,
+                    std::map<std::string, std::string> labels = {}) const;
+
+    const std::vector<double>& bounds() const { return m_bounds; }
+
+    /// `n` bounds start, start*factor, start*factor^2, ...
+    static std::vector<double> exponentialBounds(double start, double factor, size_t n);
+
+private:
+    std::vector<double> m_bounds;
+    // Non-cumulative, one past the bounds for +Inf.
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+    std::atomic<double> m_sum{0.0};
+};
@@ -3,8 +3,16 @@
 using json = nlohmann::json;
 
 StdLogosResult Libp2pModuleImpl::kadFindNode(const std::string& peerId) {
-    return callSyncWith("Failed to find node",
-        [&](SyncPromise* p) {
+    return kadFindNodeVia(OpMode::Sync, peerId);
+}
+
+StdLogosResult Libp2pModuleImpl::kadFindNodeAsync(const std::string& peerId) {
+    return kadFindNodeVia(OpMode::Async, peerId);
+}
+
+StdLogosResult Libp2pModuleImpl::kadFindNodeVia(const OpTarget& target, const std::string& peerId) {
+    return callWith(target, "Failed to find node",
+        [&](Completion* p) {
             return libp2p_ctx_kad_find_node(ctx, nimffi_str(peerId.c_str()),
                                             &Libp2pModuleImpl::cbPeers, p);
         },
@@ -12,49 +20,118 @@ StdLogosResult Libp2pModuleImpl::kadFindNode(const std::string& peerId) {
 }
 
 StdLogosResult Libp2pModuleImpl::kadPutValue(const std::string& key, const std::string& value) {
+    return kadPutValueVia(OpMode::Sync, key, value);
+}
+
+StdLogosResult Libp2pModuleImpl::kadPutValueAsync(const std::string& key, const std::string& value) {
+    return kadPutValueVia(OpMode::Async, key, value);
+}
+
+StdLogosResult Libp2pModuleImpl::kadPutValueCbor(const std::vector<uint8_t>& key,
+                                                 const std::vector<uint8_t>& value) {
+    return kadPutValueVia(OpMode::Sync, nimffiBytes(key), nimffiBytes(value));
+}
+
+StdLogosResult Libp2pModuleImpl::kadPutValueVia(const OpTarget& target, const std::string& key,
+                                                const std::string& value) {
+    return kadPutValueVia(target, nimffiBytes(key), nimffiBytes(value));
+}
+
+StdLogosResult Libp2pModuleImpl::kadPutValueVia(const OpTarget& target, NimFfiBytes key,
+                                                NimFfiBytes value) {
     KadPutValueRequest req{};
-    req.key = nimffiBytes(key);
-    req.value = nimffiBytes(value);
-    return callSync("Failed to put value", [&](SyncPromise* p) {
+    req.key = key;
+    req.value = value;
+    return callWith(target, "Failed to put value", [&](Completion* p) {
         return libp2p_ctx_kad_put_value(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::kadGetValue(const std::string& key, int64_t quorum) {
+    return kadGetValueVia(OpMode::Sync, key, quorum);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetValueAsync(const std::string& key, int64_t quorum) {
+    return kadGetValueVia(OpMode::Async, key, quorum);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetValueCbor(const std::vector<uint8_t>& key, int64_t quorum) {
+    return kadGetValueVia(OpMode::Sync, nimffiBytes(key), quorum, BytesFormat::Cbor);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetValueVia(const OpTarget& target, const std::string& key,
+                                                int64_t quorum, BytesFormat format) {
+    return kadGetValueVia(target, nimffiBytes(key), quorum, format);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetValueVia(const OpTarget& target, NimFfiBytes key,
+                                                int64_t quorum, BytesFormat format) {
     KadGetValueRequest req{};
-    req.key = nimffiBytes(key);
+    req.key = key;
     req.quorum = quorum;
-    return callSyncWith("Failed to get value",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to get value",
+        [&](Completion* p) {
             return libp2p_ctx_kad_get_value(ctx, &req, &Libp2pModuleImpl::cbRead, p);
         },
-        bufferToResult);
+        bufferTransform(format));
 }
 
 StdLogosResult Libp2pModuleImpl::kadAddProvider(const std::string& cid) {
-    return callSync("Failed to add provider", [&](SyncPromise* p) {
+    return kadAddProviderVia(OpMode::Sync, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadAddProviderAsync(const std::string& cid) {
+    return kadAddProviderVia(OpMode::Async, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadAddProviderVia(const OpTarget& target, const std::string& cid) {
+    return callWith(target, "Failed to add provider", [&](Completion* p) {
         return libp2p_ctx_kad_add_provider(ctx, nimffi_str(cid.c_str()),
                                            &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::kadStartProviding(const std::string& cid) {
-    return callSync("Failed to start providing", [&](SyncPromise* p) {
+    return kadStartProvidingVia(OpMode::Sync, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadStartProvidingAsync(const std::string& cid) {
+    return kadStartProvidingVia(OpMode::Async, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadStartProvidingVia(const OpTarget& target, const std::string& cid) {
+    return callWith(target, "Failed to start providing", [&](Completion* p) {
         return libp2p_ctx_kad_start_providing(ctx, nimffi_str(cid.c_str()),
                                               &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::kadStopProviding(const std::string& cid) {
-    return callSync("Failed to stop providing", [&](SyncPromise* p) {
+    return kadStopProvidingVia(OpMode::Sync, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadStopProvidingAsync(const std::string& cid) {
+    return kadStopProvidingVia(OpMode::Async, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadStopProvidingVia(const OpTarget& target, const std::string& cid) {
+    return callWith(target, "Failed to stop providing", [&](Completion* p) {
         return libp2p_ctx_kad_stop_providing(ctx, nimffi_str(cid.c_str()),
                                              &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::kadGetProviders(const std::string& cid) {
-    return callSyncWith("Failed to get providers",
-        [&](SyncPromise* p) {
+    return kadGetProvidersVia(OpMode::Sync, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetProvidersAsync(const std::string& cid) {
+    return kadGetProvidersVia(OpMode::Async, cid);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetProvidersVia(const OpTarget& target, const std::string& cid) {
+    return callWith(target, "Failed to get providers",
+        [&](Completion* p) {
             return libp2p_ctx_kad_get_providers(ctx, nimffi_str(cid.c_str()),
                                                 &Libp2pModuleImpl::cbProviders, p);
         },
@@ -62,8 +139,16 @@ StdLogosResult Libp2pModuleImpl::kadGetProviders(const std::string& cid) {
 }
 
 StdLogosResult Libp2pModuleImpl::kadGetRandomRecords() {
-    return callSyncWith("Failed to get random records",
-        [&](SyncPromise* p) {
+    return kadGetRandomRecordsVia(OpMode::Sync);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetRandomRecordsAsync() {
+    return kadGetRandomRecordsVia(OpMode::Async);
+}
+
+StdLogosResult Libp2pModuleImpl::kadGetRandomRecordsVia(const OpTarget& target) {
+    return callWith(target, "Failed to get random records",
+        [&](Completion* p) {
             return libp2p_ctx_kad_random_records(ctx, &Libp2pModuleImpl::cbRecords, p);
         },
         [](const SyncResult& r) { return jsonResult(r, json::array()); });
@@ -0,0 +1,69 @@
+#include "late_reaper.h"
+
+#include <chrono>
+#include <thread>
+#include <utility>
+
+LateReaper& LateReaper::instance() {
+    static LateReaper* reaper = new LateReaper();
+    return *reaper;
+}
+
+void LateReaper::adopt(const void* owner) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_owners.insert(owner);
+}
+
+void LateReaper::forget(const void* owner) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_owners.erase(owner);
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        it = it->owner == owner ? m_jobs.erase(it) : std::next(it);
+    }
+    m_cond.wait(lock, [&] { return !(m_busy && m_running == owner); });
+}
+
+bool LateReaper::post(const void* owner, std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (owner && !m_owners.count(owner)) return false;
+    m_jobs.push_back(Job{owner, std::move(job)});
+    if (!m_threadLive) {
+        m_threadLive = true;
+        std::thread([this] { run(); }).detach();
+    } else {
+        m_cond.notify_all();
+    }
+    return true;
+}
+
+size_t LateReaper::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size() + (m_busy ? 1 : 0);
+}
+
+uint64_t LateReaper::reclaimedTotal() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reclaimed;
+}
+
+void LateReaper::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        if (!m_cond.wait_for(lock, std::chrono::milliseconds(kIdleMs),
+                             [this] { return !m_jobs.empty(); })) {
+            m_threadLive = false;
+            return;
+        }
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_running = job.owner;
+        m_busy = true;
+        lock.unlock();
+        job.run();
+        lock.lock();
+        m_busy = false;
+        m_running = nullptr;
+        ++m_reclaimed;
+        m_cond.notify_all();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+// The one background thread that reclaims what late replies still own: a
+// context whose create timed out, a stream a timed-out dial opened. The reply
+// callbacks run on the library's own threads and must not block there, so they
+// hand the clean-up here instead of spawning a thread each.
+//
+// A job belongs to an owner, the context it runs against. An owner must be
+// adopted before jobs for it are accepted, and forgetting it drops its queued
+// jobs, so nothing runs against a context after it is destroyed. Jobs with no
+// owner always run.
+class LateReaper {
+public:
+    /// Process-wide instance. Never destroyed: late replies can land at exit.
+    static LateReaper& instance();
+
+    void adopt(const void* owner);
+
+    /// Drops the owner's queued jobs and waits out one already running, so the
+    /// caller can destroy the owner right after. Never call it from a job.
+    void forget(const void* owner);
+
+    /// Queues `job` unless `owner` is set and not adopted, in which case the
+    /// job is dropped and this returns false.
+    bool post(const void* owner, std::function<void()> job);
+
+    /// Jobs queued or running.
+    size_t pending() const;
+
+    /// Jobs run to completion since start.
+    uint64_t reclaimedTotal() const;
+
+    /// How long the thread waits for more work before it exits. It starts
+    /// again with the next job.
+    static constexpr int kIdleMs = 1000;
+
+private:
+    struct Job {
+        const void* owner;
+        std::function<void()> run;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Job> m_jobs;
+    std::unordered_set<const void*> m_owners;
+    const void* m_running = nullptr;
+    bool m_busy = false;
+    bool m_threadLive = false;
+    uint64_t m_reclaimed = 0;
+
+    void run();
+};
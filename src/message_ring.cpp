@@ -0,0 +1,78 @@
+#include "message_ring.h"
+
+#include <utility>
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 2;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+}  // namespace
+
+MessageRing::MessageRing(size_t capacity)
+    : m_mask(roundUpPow2(capacity) - 1), m_cells(new Cell[m_mask + 1]) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool MessageRing::tryPush(Payload&& payload, TimePoint queuedAt) {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = m_cells[pos & m_mask];
+        const size_t seq = cell.seq.load(std::memory_order_acquire);
+        const auto lap = static_cast<std::ptrdiff_t>(seq - pos);
+        if (lap == 0) {
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.size.store(payload->size(), std::memory_order_relaxed);
+                cell.queuedAt.store(queuedAt.time_since_epoch().count(),
+                                    std::memory_order_relaxed);
+                cell.payload = std::move(payload);
+                cell.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lap < 0) {
+            return false;  // the cell still holds last lap's payload
+        } else {
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool MessageRing::tryPop(Payload& out, TimePoint& queuedAt, size_t maxSize) {
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = m_cells[pos & m_mask];
+        const size_t seq = cell.seq.load(std::memory_order_acquire);
+        const auto lap = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+        if (lap == 0) {
+            // Read before claiming: once the claim succeeds nobody else took
+            // this lap's payload, so the size read was its own.
+            if (cell.size.load(std::memory_order_relaxed) > maxSize) return false;
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                // Moving leaves the cell empty, so an idle cell pins no
+                // buffer the byte bound no longer counts.
+                out = std::move(cell.payload);
+                queuedAt = TimePoint(TimePoint::duration(
+                    cell.queuedAt.load(std::memory_order_relaxed)));
+                cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lap < 0) {
+            return false;
+        } else {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool MessageRing::oldest(TimePoint& queuedAt) const {
+    const size_t pos = m_head.load(std::memory_order_acquire);
+    const Cell& cell = m_cells[pos & m_mask];
+    if (cell.seq.load(std::memory_order_acquire) != pos + 1) return false;
+    queuedAt = TimePoint(TimePoint::duration(cell.queuedAt.load(std::memory_order_relaxed)));
+    return true;
+}
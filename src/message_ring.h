@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "payload.h"
+
+// Bounded multi-producer multi-consumer ring of payloads (Vyukov's sequenced
+// cells). tryPush and tryPop never take a lock: each claims a cell with one CAS
+// on its end's cursor, and the cell's sequence number hands it over. The cells
+// are allocated once, so unlike a deque the ring allocates nothing per message
+// beyond the payload itself, which it holds by reference.
+class MessageRing {
+public:
+    /// Rounds `capacity` up to a power of two, and to at least 2.
+    explicit MessageRing(size_t capacity);
+
+    MessageRing(const MessageRing&) = delete;
+    MessageRing& operator=(const MessageRing&) = delete;
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /// Moves `payload` in, stamped `queuedAt`, or leaves it alone and returns
+    /// false when full.
+    bool tryPush(Payload&& payload, TimePoint queuedAt);
+
+    /// Moves the oldest payload and its stamp out, or returns false when empty
+    /// or when that payload is larger than `maxSize`, which then stays put.
+    bool tryPop(Payload& out, TimePoint& queuedAt, size_t maxSize = SIZE_MAX);
+
+    /// The oldest payload's stamp, read without claiming it, so it may be
+    /// stale by the time it returns; false when the ring looks empty.
+    bool oldest(TimePoint& queuedAt) const;
+
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        // The payload's size, readable by a consumer that has not claimed the
+        // cell yet.
+        std::atomic<size_t> size{0};
+        // Like `size`, for oldest().
+        std::atomic<TimePoint::rep> queuedAt{0};
+        Payload payload;
+    };
+
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    // On their own cache lines, so producers and consumers do not share one.
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
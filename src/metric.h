@@ -1,8 +1,11 @@
 #pragma once
 
+#include <charconv>
 #include <cstdint>
+#include <limits>
 #include <map>
 #include <string>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -11,6 +14,20 @@
 // a map because openmetrics-module's renderer expects `labels` as a flat
 // `{key:value}` object (openmetrics_format.cpp:82). `timestamp` is Unix
 // milliseconds from the registry; 0 means "unset" and is dropped on output.
+//
+// A "histogram" carries cumulative `buckets` (the last one +Inf) and a
+// "summary" its `quantiles`; both carry `sum` and `count`, and `value` repeats
+// the count so a scalar-only reader still sees something meaningful.
+struct MetricBucket {
+    double upperBound;  // +Inf for the last bucket
+    uint64_t count;     // cumulative: observations <= upperBound
+};
+
+struct MetricQuantile {
+    double quantile;
+    double value;
+};
+
 struct Metric {
     std::string name;
     std::string type;
@@ -18,8 +35,31 @@ struct Metric {
     std::map<std::string, std::string> labels;
     double value = 0.0;
     int64_t timestamp = 0;
+    std::vector<MetricBucket> buckets{};
+    std::vector<MetricQuantile> quantiles{};
+    double sum = 0.0;
+    uint64_t count = 0;
 };
 
+// Bucket bounds travel as OpenMetrics `le` label text ("0.005", "+Inf"), since
+// JSON has no infinity. The shortest text that reads back as the same double,
+// so no two bounds collide however large they get.
+inline std::string metricBoundText(double bound) {
+    if (bound == std::numeric_limits<double>::infinity()) return "+Inf";
+    char buf[32];
+    const auto res = std::to_chars(buf, buf + sizeof buf, bound);
+    return std::string(buf, res.ptr);
+}
+
+inline double metricBoundFromJson(const nlohmann::json& le) {
+    if (le.is_number()) return le.get<double>();
+    const auto text = le.get<std::string>();
+    if (text == "+Inf" || text == "Inf" || text == "inf") {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::stod(text);
+}
+
 inline void from_json(const nlohmann::json& j, Metric& m) {
     j.at("name").get_to(m.name);
     j.at("type").get_to(m.type);
@@ -37,6 +77,22 @@ inline void from_json(const nlohmann::json& j, Metric& m) {
     } else {
         m.timestamp = 0;
     }
+    m.buckets.clear();
+    if (auto it = j.find("buckets"); it != j.end() && it->is_array()) {
+        for (const auto& b : *it) {
+            m.buckets.push_back(
+                MetricBucket{metricBoundFromJson(b.at("le")), b.at("count").get<uint64_t>()});
+        }
+    }
+    m.quantiles.clear();
+    if (auto it = j.find("quantiles"); it != j.end() && it->is_array()) {
+        for (const auto& q : *it) {
+            m.quantiles.push_back(
+                MetricQuantile{q.at("quantile").get<double>(), q.at("value").get<double>()});
+        }
+    }
+    m.sum = j.value("sum", 0.0);
+    m.count = j.value("count", uint64_t(0));
 }
 
 inline void to_json(nlohmann::json& j, const Metric& m) {
@@ -48,4 +104,19 @@ inline void to_json(nlohmann::json& j, const Metric& m) {
         {"value", m.value},
     };
     if (m.timestamp != 0) j["timestamp"] = m.timestamp;
+    if (m.type != "histogram" && m.type != "summary") return;
+
+    if (m.type == "histogram") {
+        auto& buckets = j["buckets"] = nlohmann::json::array();
+        for (const auto& b : m.buckets) {
+            buckets.push_back({{"le", metricBoundText(b.upperBound)}, {"count", b.count}});
+        }
+    } else {
+        auto& quantiles = j["quantiles"] = nlohmann::json::array();
+        for (const auto& q : m.quantiles) {
+            quantiles.push_back({{"quantile", q.quantile}, {"value", q.value}});
+        }
+    }
+    j["sum"] = m.sum;
+    j["count"] = m.count;
 }
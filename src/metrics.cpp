@@ -8,7 +8,7 @@ LogosMap Libp2pModuleImpl::collectMetrics() {
     // return an empty-but-well-formed metrics array.
     std::string text;
     auto res = callSyncWith("Failed to collect metrics",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_static_collect_metrics(&Libp2pModuleImpl::cbStr, p);
         },
         [](const SyncResult& r) -> StdLogosResult {
@@ -31,6 +31,18 @@ LogosMap Libp2pModuleImpl::collectMetrics() {
     // The backlog lives on the C++ side, so nim-libp2p's registry cannot see it.
     auto queueSeries = m_topicQueues.metrics();
     series.insert(series.end(), queueSeries.begin(), queueSeries.end());
+    auto eventSeries = m_eventQueue.metrics();
+    series.insert(series.end(), eventSeries.begin(), eventSeries.end());
+
+    // Process-wide, like the pool and the reaper they describe.
+    series.push_back(Metric{"libp2p_module_abandoned_ops", "gauge",
+                            "timed-out ops whose reply has not landed yet", {},
+                            static_cast<double>(Completion::abandonedPending())});
+    series.push_back(Metric{"libp2p_module_late_results_reclaimed_total", "counter",
+                            "late contexts and streams released by the reaper", {},
+                            static_cast<double>(LateReaper::instance().reclaimedTotal())});
+    auto opSeries = OpStats::instance().metrics();
+    series.insert(series.end(), opSeries.begin(), opSeries.end());
 
     json payload;
     payload["metrics"] = series;
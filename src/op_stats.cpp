@@ -0,0 +1,66 @@
+#include "op_stats.h"
+
+#include <cctype>
+#include <mutex>
+
+OpStats::Series::Clock::time_point OpStats::Series::begin() {
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    return Clock::now();
+}
+
+void OpStats::Series::end(Clock::time_point start, Outcome outcome) {
+    m_seconds.observe(std::chrono::duration<double>(Clock::now() - start).count());
+    m_outcomes[static_cast<size_t>(outcome)].fetch_add(1, std::memory_order_relaxed);
+    m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+}
+
+OpStats& OpStats::instance() {
+    static OpStats* stats = new OpStats();
+    return *stats;
+}
+
+OpStats::Series& OpStats::series(const char* errPrefix) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_byPrefix.find(errPrefix);
+        if (it != m_byPrefix.end()) return *it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto& slot = m_byName[opName(errPrefix)];
+    if (!slot) slot = std::make_unique<Series>();
+    m_byPrefix.emplace(errPrefix, slot.get());
+    return *slot;
+}
+
+std::string OpStats::opName(const std::string& errPrefix) {
+    static const std::string kFailedTo = "Failed to ";
+    std::string name = errPrefix.compare(0, kFailedTo.size(), kFailedTo) == 0
+        ? errPrefix.substr(kFailedTo.size()) : errPrefix;
+    for (auto& c : name) {
+        c = std::isalnum(static_cast<unsigned char>(c))
+            ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : '_';
+    }
+    return name;
+}
+
+std::vector<Metric> OpStats::metrics() const {
+    static const char* kOutcomes[] = {"success", "failure", "timeout"};
+
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<Metric> series;
+    series.reserve(m_byName.size() * 5);
+    for (const auto& [op, s] : m_byName) {
+        series.push_back(Metric{"libp2p_module_ops_in_flight", "gauge",
+                                "bridge ops submitted and not yet replied", {{"op", op}},
+                                static_cast<double>(s->m_inFlight.load(std::memory_order_relaxed))});
+        for (size_t i = 0; i < s->m_outcomes.size(); ++i) {
+            series.push_back(Metric{"libp2p_module_ops_total", "counter",
+                                    "bridge ops finished, by outcome",
+                                    {{"op", op}, {"outcome", kOutcomes[i]}},
+                                    static_cast<double>(s->m_outcomes[i].load(std::memory_order_relaxed))});
+        }
+        series.push_back(s->m_seconds.snapshot("libp2p_module_op_duration_seconds",
+                                               "bridge op latency", {{"op", op}}));
+    }
+    return series;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "histogram.h"
+#include "metric.h"
+
+// Latency, outcome and in-flight counts for every bridge op, keyed by the op's
+// errPrefix ("Failed to dial" becomes op="dial"). Process-wide like the bridge
+// itself: callStaticWith and submitWith are static and record here directly.
+// Recording is a few relaxed atomics on a series found once per op. Latency
+// buckets run from a local stream write to a DHT walk that runs into the 10 s
+// default timeout.
+class OpStats {
+public:
+    enum class Outcome { Success, Failure, Timeout };
+
+    class Series {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// Marks one op in flight and returns its start time for end().
+        Clock::time_point begin();
+        void end(Clock::time_point start, Outcome outcome);
+
+    private:
+        friend class OpStats;
+
+        std::atomic<int64_t> m_inFlight{0};
+        std::array<std::atomic<uint64_t>, 3> m_outcomes{};
+        Histogram m_seconds{{0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10}};
+    };
+
+    static OpStats& instance();
+
+    /// The series of the op `errPrefix` names. The pointer stays valid for the
+    /// life of the process.
+    Series& series(const char* errPrefix);
+
+    std::vector<Metric> metrics() const;
+
+    /// "Failed to read LP from stream" -> "read_lp_from_stream".
+    static std::string opName(const std::string& errPrefix);
+
+private:
+    mutable std::shared_mutex m_mutex;
+    // errPrefix literals by address, the fast path; the same text from two
+    // translation units may sit at two addresses, so both lead to one series.
+    std::unordered_map<const char*, Series*> m_byPrefix;
+    std::unordered_map<std::string, std::unique_ptr<Series>> m_byName;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+// A message body, copied once off the wire and from then on only shared: the
+// topic queue and the event reporting the message hold the same buffer, and
+// whoever holds the last reference may take the bytes without copying them.
+using Payload = std::shared_ptr<const std::string>;
+
+/// The only way to build a Payload. The string itself is not const, which is
+/// what lets takePayload() move out of it.
+inline Payload makePayload(const uint8_t* data, size_t len) {
+    if (!data || len == 0) return std::make_shared<std::string>();
+    return std::make_shared<std::string>(reinterpret_cast<const char*>(data), len);
+}
+
+inline Payload makePayload(std::string bytes) {
+    return std::make_shared<std::string>(std::move(bytes));
+}
+
+/// The bytes of `p`: moved out when `p` is the last reference, else copied.
+/// Nobody can take a new reference from the last one, so a count of 1 stays
+/// 1. Only a holder whose `p` no other thread can copy meanwhile may call it;
+/// the topic queues call it on the reference they just took out.
+inline std::string takePayload(Payload&& p) {
+    if (p.use_count() == 1) {
+        // use_count() is a relaxed load. The fence pairs it with the release
+        // in the decrement of whoever dropped the other references, so their
+        // reads of the bytes happen before the move below.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::string out = std::move(const_cast<std::string&>(*p));
+        p.reset();
+        return out;
+    }
+    std::string out = *p;
+    p.reset();
+    return out;
+}
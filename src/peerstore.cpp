@@ -4,7 +4,7 @@ using json = nlohmann::json;
 
 StdLogosResult Libp2pModuleImpl::peerstoreGetPeers() {
     return callSyncWith("Failed to get peers",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_peerstore_get_peers(ctx, &Libp2pModuleImpl::cbPeers, p);
         },
         [](const SyncResult& r) { return jsonResult(r, json::array()); });
@@ -12,7 +12,7 @@ StdLogosResult Libp2pModuleImpl::peerstoreGetPeers() {
 
 StdLogosResult Libp2pModuleImpl::peerstoreGetPeerInfo(const std::string& peerId) {
     return callSyncWith("Failed to get peer info",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_peerstore_get_peer_info(ctx, nimffi_str(peerId.c_str()),
                                                       &Libp2pModuleImpl::cbPeerStoreEntry, p);
         },
@@ -32,7 +32,7 @@ StdLogosResult Libp2pModuleImpl::peerstoreAddPeer(
     req.addrs = LibP2PSeq_Str{addrsFfi.data(), addrsFfi.size()};
     req.protocols = LibP2PSeq_Str{protosFfi.data(), protosFfi.size()};
 
-    return callSync("Failed to add peer", [&](SyncPromise* p) {
+    return callSync("Failed to add peer", [&](Completion* p) {
         return libp2p_ctx_peerstore_add_peer(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     });
 }
@@ -47,7 +47,7 @@ StdLogosResult Libp2pModuleImpl::peerstoreSetPeerAddresses(
     req.peerId = nimffi_str(peerId.c_str());
     req.addrs = LibP2PSeq_Str{addrsFfi.data(), addrsFfi.size()};
 
-    return callSync("Failed to set peer addresses", [&](SyncPromise* p) {
+    return callSync("Failed to set peer addresses", [&](Completion* p) {
         return libp2p_ctx_peerstore_set_peer_addresses(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     });
 }
@@ -62,13 +62,13 @@ StdLogosResult Libp2pModuleImpl::peerstoreSetPeerProtocols(
     req.peerId = nimffi_str(peerId.c_str());
     req.protocols = LibP2PSeq_Str{protosFfi.data(), protosFfi.size()};
 
-    return callSync("Failed to set peer protocols", [&](SyncPromise* p) {
+    return callSync("Failed to set peer protocols", [&](Completion* p) {
         return libp2p_ctx_peerstore_set_peer_protocols(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::peerstoreDeletePeer(const std::string& peerId) {
-    return callSync("Failed to delete peer", [&](SyncPromise* p) {
+    return callSync("Failed to delete peer", [&](Completion* p) {
         return libp2p_ctx_peerstore_delete_peer(ctx, nimffi_str(peerId.c_str()),
                                                 &Libp2pModuleImpl::cbBool, p);
     });
@@ -45,41 +45,64 @@ bool extractPort(const std::string& multiaddr, int& out) {
 }
 
 // A create that times out leaves the reply pending, and a late reply hands back
-// a context nobody owns. Keep the future alive on a detached thread so the
-// context still gets destroyed if it ever arrives.
-void reapLateContext(std::future<SyncResult> f) {
-    std::thread([f = std::move(f)]() mutable {
-        auto r = f.get();
-        if (r.newCtx) destroyContextChecked(r.newCtx);
-    }).detach();
+// a context nobody owns. The completion's onLate hook gets it on the replying
+// thread, which is the library's own, so the teardown goes to the reaper.
+void reapLateContext(SyncResult&& late, void*) {
+    if (!late.newCtx) return;
+    LateReaper::instance().post(nullptr, [ctx = late.newCtx] { destroyContextChecked(ctx); });
 }
 
+// Reply sink for a release nobody waits on.
+void ignoreReply(int, const bool*, const char*, void*) {}
+
 constexpr char kModuleVersion[] = "1.0.0";
 
 std::atomic<int64_t> g_requestedLogLevel{LOG_LEVEL_DEBUG};
 }
 
 void Libp2pModuleImpl::publishEmitEvent() {
-    std::unique_lock<std::shared_mutex> lock(m_emitEventLock);
-    m_emitEventSnapshot = emitEvent;
+    std::lock_guard<std::mutex> lock(m_emitEventPublishLock);
+    auto next = emitEvent ? std::make_unique<const EmitEventFn>(emitEvent) : nullptr;
+    // Sequentially consistent with dispatchEvent's increment and load: a
+    // dispatch that bumps the counter after the check below loads `next`, and
+    // one that loaded the old snapshot is still counted.
+    m_emitEventSnapshot.store(next.get(), std::memory_order_seq_cst);
+    if (m_emitEventCurrent) m_emitEventRetired.push_back(std::move(m_emitEventCurrent));
+    m_emitEventCurrent = std::move(next);
+    if (m_emitEventReaders.load(std::memory_order_seq_cst) == 0) m_emitEventRetired.clear();
 }
 
-void Libp2pModuleImpl::emitEventSafe(const std::string& name, const std::string& data) const {
-    EmitEventFn fn;
-    {
-        std::shared_lock<std::shared_mutex> lock(m_emitEventLock);
-        fn = m_emitEventSnapshot;
-    }
+void Libp2pModuleImpl::emitEventSafe(const std::string& name, std::string data) {
+    m_eventQueue.post(name, std::move(data));
+}
+
+void Libp2pModuleImpl::dispatchEvent(const std::string& name, const std::string& data) const {
+    struct Reading {
+        std::atomic<size_t>& readers;
+        explicit Reading(std::atomic<size_t>& r) : readers(r) {
+            readers.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~Reading() { readers.fetch_sub(1, std::memory_order_release); }
+    } reading(m_emitEventReaders);
+    const EmitEventFn* fn = m_emitEventSnapshot.load(std::memory_order_seq_cst);
     if (!fn) {
         return;
     }
-    fn(name, data);
+    (*fn)(name, data);
 }
 
 Libp2pModuleImpl::Libp2pModuleImpl(const Libp2pModuleOptions& options)
     : ctx(nullptr)
 {
     applyOptions(options);
+    m_asyncOps->setListener([this](uint64_t opId, const StdLogosResult& res) {
+        json j;
+        j["opId"] = opId;
+        j["success"] = res.success;
+        j["value"] = res.value;
+        j["error"] = res.error;
+        emitEventSafe("operationCompleted", j.dump());
+    });
 }
 
 void Libp2pModuleImpl::applyOptions(const Libp2pModuleOptions& options) {
@@ -95,6 +118,19 @@ void Libp2pModuleImpl::applyOptions(const Libp2pModuleOptions& options) {
 
     m_topicQueues.setBounds(options.gossipsubQueueMaxMessages,
                             options.gossipsubQueueMaxBytes);
+    m_topicQueues.setTotalMaxBytes(options.gossipsubQueueTotalMaxBytes);
+    m_topicQueues.setBackend(options.gossipsubQueueBackend);
+    m_topicQueues.setSpill(options.gossipsubQueueSpillDir, options.gossipsubQueueSpillMaxBytes);
+    m_topicQueues.setPolicy(options.gossipsubQueuePolicy);
+    m_topicQueues.setTopicPolicies(options.gossipsubQueueTopicPolicies);
+    m_topicQueues.setTopicBounds(options.gossipsubQueueTopicBounds);
+    m_topicDelivery.setDefault(options.gossipsubDelivery);
+    m_topicDelivery.setModes(options.gossipsubTopicDelivery);
+    m_eventQueue.configure(options.eventQueueMaxEvents, options.eventQueueMaxBytes,
+                           options.eventQueueOverflow);
+    m_eventBatcher.configure(options.gossipsubEventBatchMaxMessages,
+                             options.gossipsubEventBatchMaxBytes,
+                             options.gossipsubEventBatchLingerMs);
 
     m_libp2pConfig.gossipsub.mount = options.mountGossipsub;
     m_libp2pConfig.gossipsub.triggerSelf = options.gossipsubTriggerSelf;
@@ -170,24 +206,19 @@ void Libp2pModuleImpl::applyOptions(const Libp2pModuleOptions& options) {
 }
 
 SyncResult Libp2pModuleImpl::spawnContext(Libp2pConfig& cfg) {
-    auto* p = new SyncPromise();
-    auto f = p->get_future();
+    auto* c = Completion::acquire();
+    c->onLate = reapLateContext;
 
-    int ret = libp2p_ctx_create(&cfg, &Libp2pModuleImpl::cbCreate, p);
+    int ret = libp2p_ctx_create(&cfg, &Libp2pModuleImpl::cbCreate, c);
     if (ret != 0) {
-        if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-            delete p;
-        }
+        c->cancelSubmit();
         SyncResult r;
         r.message = "failed to submit (ret=" + std::to_string(ret) + ")";
         return r;
     }
 
-    auto r = awaitResult(f, kNewContextTimeoutMs);
-    if (!r.ok) {
-        if (f.valid()) reapLateContext(std::move(f));
-        return r;
-    }
+    auto r = awaitResult(c, kNewContextTimeoutMs);
+    if (!r.ok) return r;
     if (!r.newCtx) {
         r.ok = false;
         r.message = "no context returned";
@@ -212,6 +243,7 @@ StdLogosResult Libp2pModuleImpl::createContext() {
     }
 
     ctx = r.newCtx;
+    LateReaper::instance().adopt(ctx);
 
     // Register listeners before start so incoming protocol streams and pubsub
     // messages are delivered once the node is running. Destroying the context
@@ -254,16 +286,37 @@ void Libp2pModuleImpl::destroyContext() {
     if (!ctx) {
         return;
     }
+    // Late replies may still target this context; drop their clean-up first,
+    // since destroying it releases the streams they would.
+    LateReaper::instance().forget(ctx);
     // Synchronous: runs the Nim destructor (which drops the node and its
     // streams) and frees the C-side context wrapper and listener boxes.
     destroyContextChecked(ctx);
     ctx = nullptr;
 }
 
+void Libp2pModuleImpl::releaseLateStream(LibP2PCtx* owner, uint64_t streamId) {
+    if (streamId == 0) return;
+    LateReaper::instance().post(owner, [owner, streamId] {
+        libp2p_ctx_stream_release(owner, streamId, &ignoreReply, nullptr);
+    });
+}
+
+void Libp2pModuleImpl::reapLateStream(SyncResult&& late, void* owner) {
+    if (!late.ok || !late.data.is_number_unsigned()) return;
+    releaseLateStream(static_cast<LibP2PCtx*>(owner), late.data.get<uint64_t>());
+}
+
 Libp2pModuleImpl::~Libp2pModuleImpl() {
     try {
         destroyContext();
     } catch (...) {}
+    // A late async reply still lands in m_asyncOps, but must not reach `this`.
+    m_asyncOps->setListener(nullptr);
+    // Nothing posts anymore; deliver what is left while the members it reads
+    // are still alive, open batches first.
+    m_eventBatcher.stop();
+    m_eventQueue.stop();
 }
 
 StdLogosResult Libp2pModuleImpl::start() {
@@ -272,13 +325,13 @@ StdLogosResult Libp2pModuleImpl::start() {
         if (!created.success) return created;
     }
     publishEmitEvent();
-    return callSync("Failed to start libp2p", [&](SyncPromise* p) {
+    return callSync("Failed to start libp2p", [&](Completion* p) {
         return libp2p_ctx_start(ctx, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::stop() {
-    auto res = callSync("Failed to stop libp2p", [&](SyncPromise* p) {
+    auto res = callSync("Failed to stop libp2p", [&](Completion* p) {
         return libp2p_ctx_stop(ctx, &Libp2pModuleImpl::cbBool, p);
     });
     // A node that failed to stop is still delivering, so it keeps its backlog.
@@ -310,7 +363,7 @@ StdLogosResult Libp2pModuleImpl::newPrivateKey(const std::string& scheme) {
     NewPrivateKeyRequest req{};
     req.scheme = static_cast<int64_t>(parsed);
     return callSyncWith("Failed to generate private key",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_static_new_private_key(&req, &Libp2pModuleImpl::cbBytes, p);
         },
         [](const SyncResult& r) -> StdLogosResult {
@@ -320,7 +373,7 @@ StdLogosResult Libp2pModuleImpl::newPrivateKey(const std::string& scheme) {
 
 StdLogosResult Libp2pModuleImpl::publicKey() {
     return callSyncWith("Failed to get public key",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_public_key(ctx, &Libp2pModuleImpl::cbBytes, p);
         },
         bufferToResult);
@@ -334,7 +387,7 @@ StdLogosResult Libp2pModuleImpl::toCid(const std::string& key) {
     req.hash = nimffi_str("sha2-256");
     req.data = nimffiBytes(key);
     return callStaticWith("Failed to create CID",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_static_create_cid(&req, &Libp2pModuleImpl::cbStr, p);
         },
         [](const SyncResult& r) -> StdLogosResult {
@@ -346,6 +399,23 @@ StdLogosResult Libp2pModuleImpl::connectPeer(
     const std::string& peerId,
     const std::vector<std::string>& multiaddrs,
     int64_t timeoutMs)
+{
+    return connectPeerVia(OpMode::Sync, peerId, multiaddrs, timeoutMs);
+}
+
+StdLogosResult Libp2pModuleImpl::connectPeerAsync(
+    const std::string& peerId,
+    const std::vector<std::string>& multiaddrs,
+    int64_t timeoutMs)
+{
+    return connectPeerVia(OpMode::Async, peerId, multiaddrs, timeoutMs);
+}
+
+StdLogosResult Libp2pModuleImpl::connectPeerVia(
+    const OpTarget& target,
+    const std::string& peerId,
+    const std::vector<std::string>& multiaddrs,
+    int64_t timeoutMs)
 {
     auto addrsFfi = toNimFfiStrs(multiaddrs);
 
@@ -354,13 +424,21 @@ StdLogosResult Libp2pModuleImpl::connectPeer(
     req.multiaddrs = LibP2PSeq_Str{addrsFfi.data(), addrsFfi.size()};
     req.timeoutMs = timeoutMs;
 
-    return callSync("Failed to connect", [&](SyncPromise* p) {
+    return callWith(target, "Failed to connect", [&](Completion* p) {
         return libp2p_ctx_connect(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     }, awaitTimeoutFor(timeoutMs));
 }
 
 StdLogosResult Libp2pModuleImpl::disconnectPeer(const std::string& peerId) {
-    return callSync("Failed to disconnect", [&](SyncPromise* p) {
+    return disconnectPeerVia(OpMode::Sync, peerId);
+}
+
+StdLogosResult Libp2pModuleImpl::disconnectPeerAsync(const std::string& peerId) {
+    return disconnectPeerVia(OpMode::Async, peerId);
+}
+
+StdLogosResult Libp2pModuleImpl::disconnectPeerVia(const OpTarget& target, const std::string& peerId) {
+    return callWith(target, "Failed to disconnect", [&](Completion* p) {
         return libp2p_ctx_disconnect(ctx, nimffi_str(peerId.c_str()),
                                      &Libp2pModuleImpl::cbBool, p);
     });
@@ -368,7 +446,7 @@ StdLogosResult Libp2pModuleImpl::disconnectPeer(const std::string& peerId) {
 
 StdLogosResult Libp2pModuleImpl::peerInfo() {
     return callSyncWith("Failed to get peer info",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_peer_info(ctx, &Libp2pModuleImpl::cbPeerInfo, p);
         },
         [](const SyncResult& r) { return jsonResult(r, json::object()); });
@@ -412,7 +490,7 @@ StdLogosResult Libp2pModuleImpl::connectedPeers(int64_t direction) {
     }
     auto dir = static_cast<PeerDirection>(direction);
     return callSyncWith("Failed to get connected peers",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_connected_peers(ctx, dir,
                                               &Libp2pModuleImpl::cbPeers, p);
         },
@@ -420,11 +498,22 @@ StdLogosResult Libp2pModuleImpl::connectedPeers(int64_t direction) {
 }
 
 StdLogosResult Libp2pModuleImpl::dial(const std::string& peerId, const std::string& proto) {
+    return dialVia(OpMode::Sync, peerId, proto);
+}
+
+StdLogosResult Libp2pModuleImpl::dialAsync(const std::string& peerId, const std::string& proto) {
+    return dialVia(OpMode::Async, peerId, proto);
+}
+
+StdLogosResult Libp2pModuleImpl::dialVia(const OpTarget& target, const std::string& peerId,
+                                         const std::string& proto) {
     DialRequest req{};
     req.peerId = nimffi_str(peerId.c_str());
     req.proto = nimffi_str(proto.c_str());
-    return callSyncWith("Failed to dial",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to dial",
+        [&](Completion* p) {
+            p->onLate = &Libp2pModuleImpl::reapLateStream;
+            p->lateArg = ctx;
             return libp2p_ctx_dial(ctx, &req, &Libp2pModuleImpl::cbDial, p);
         },
         [](const SyncResult& r) -> StdLogosResult {
@@ -436,6 +525,21 @@ StdLogosResult Libp2pModuleImpl::dial(const std::string& peerId, const std::stri
 StdLogosResult Libp2pModuleImpl::circuitRelayReserve(
     const std::string& relayPeerId,
     const std::vector<std::string>& relayAddrs)
+{
+    return circuitRelayReserveVia(OpMode::Sync, relayPeerId, relayAddrs);
+}
+
+StdLogosResult Libp2pModuleImpl::circuitRelayReserveAsync(
+    const std::string& relayPeerId,
+    const std::vector<std::string>& relayAddrs)
+{
+    return circuitRelayReserveVia(OpMode::Async, relayPeerId, relayAddrs);
+}
+
+StdLogosResult Libp2pModuleImpl::circuitRelayReserveVia(
+    const OpTarget& target,
+    const std::string& relayPeerId,
+    const std::vector<std::string>& relayAddrs)
 {
     auto addrsFfi = toNimFfiStrs(relayAddrs);
 
@@ -443,8 +547,8 @@ StdLogosResult Libp2pModuleImpl::circuitRelayReserve(
     req.relayPeerId = nimffi_str(relayPeerId.c_str());
     req.relayAddrs = LibP2PSeq_Str{addrsFfi.data(), addrsFfi.size()};
 
-    return callSyncWith("Failed to reserve relay",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to reserve relay",
+        [&](Completion* p) {
             return libp2p_ctx_circuit_relay_reserve(ctx, &req,
                                                     &Libp2pModuleImpl::cbReservation, p);
         },
@@ -455,13 +559,32 @@ StdLogosResult Libp2pModuleImpl::dialCircuitRelay(
     const std::string& dstPeerId,
     const std::string& multiaddr,
     const std::string& proto)
+{
+    return dialCircuitRelayVia(OpMode::Sync, dstPeerId, multiaddr, proto);
+}
+
+StdLogosResult Libp2pModuleImpl::dialCircuitRelayAsync(
+    const std::string& dstPeerId,
+    const std::string& multiaddr,
+    const std::string& proto)
+{
+    return dialCircuitRelayVia(OpMode::Async, dstPeerId, multiaddr, proto);
+}
+
+StdLogosResult Libp2pModuleImpl::dialCircuitRelayVia(
+    const OpTarget& target,
+    const std::string& dstPeerId,
+    const std::string& multiaddr,
+    const std::string& proto)
 {
     DialCircuitRelayRequest req{};
     req.peerId = nimffi_str(dstPeerId.c_str());
     req.multiaddr = nimffi_str(multiaddr.c_str());
     req.proto = nimffi_str(proto.c_str());
-    return callSyncWith("Failed to dial circuit relay",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to dial circuit relay",
+        [&](Completion* p) {
+            p->onLate = &Libp2pModuleImpl::reapLateStream;
+            p->lateArg = ctx;
             return libp2p_ctx_dial_circuit_relay(ctx, &req,
                                                  &Libp2pModuleImpl::cbDial, p);
         },
@@ -470,3 +593,28 @@ StdLogosResult Libp2pModuleImpl::dialCircuitRelay(
             return {true, 0, ""};
         });
 }
+
+StdLogosResult Libp2pModuleImpl::operationResult(uint64_t opId, int64_t timeoutMs) {
+    StdLogosResult res;
+    switch (m_asyncOps->take(opId, timeoutMs, res)) {
+    case AsyncOps::Take::Pending:
+        return {true, json{{"done", false}}, ""};
+    case AsyncOps::Take::Unknown:
+        return {false, {}, "unknown operation: " + std::to_string(opId)};
+    case AsyncOps::Take::Done:
+        break;
+    }
+    json j;
+    j["done"] = true;
+    j["success"] = res.success;
+    j["value"] = std::move(res.value);
+    j["error"] = std::move(res.error);
+    return {true, std::move(j), ""};
+}
+
+StdLogosResult Libp2pModuleImpl::cancelOperation(uint64_t opId) {
+    if (!m_asyncOps->complete(opId, {false, {}, "cancelled"})) {
+        return {false, {}, "operation not running: " + std::to_string(opId)};
+    }
+    return {true, {}, ""};
+}
@@ -8,14 +8,13 @@
 #include <cstdlib>
 #include <deque>
 #include <functional>
-#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <shared_mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -31,28 +30,29 @@
 // take C linkage and no longer match the C++ static callbacks we pass in.
 #include <libp2p.h>
 
+#include "async_ops.h"
+#include "completion.h"
 #include "config.h"
+#include "event_batcher.h"
+#include "event_queue.h"
+#include "late_reaper.h"
 #include "metric.h"
+#include "op_stats.h"
+#include "pubsub_delivery.h"
+#include "topic_delivery.h"
 #include "topic_queues.h"
 #include "utils.h"
 
 // Timeouts (milliseconds) for the sync-over-async libp2p bridge. nim-ffi never
 // cancels a handler, so these bound the C++ wait only: a call that outlives its
-// timeout keeps running and still resolves (and reclaims) its promise later.
+// timeout keeps running and still resolves (and recycles) its completion later.
 inline constexpr int kDefaultOpTimeoutMs = 10000;
 inline constexpr int kNewContextTimeoutMs = 5000;
 // Added on top of a caller-supplied op timeout so the C++ await outlives the
 // libp2p operation it wraps instead of racing it.
 inline constexpr int kAwaitSlackMs = 5000;
-
-// Result type for internal sync-over-async operations.
-struct SyncResult {
-    bool ok = false;
-    std::string message;
-    std::vector<uint8_t> buffer;
-    nlohmann::json data;
-    LibP2PCtx* newCtx = nullptr;
-};
+// Ops accepted by one batch() call.
+inline constexpr size_t kMaxBatchOps = 1024;
 
 // libp2p logs treat levels as inclusive minimum thresholds:
 // `Trace` emits trace and above, `Debug` emits debug and above, etc.
@@ -103,13 +103,11 @@ inline bool parseKeyScheme(const std::string& name, KeyScheme& out) {
     return false;
 }
 
-using SyncPromise = std::promise<SyncResult>;
-
-// Resolves and reclaims a heap SyncPromise. Every libp2p callback owns its
-// promise and ends by handing the result back through here.
-inline void finishPromise(SyncPromise* p, SyncResult r) {
-    p->set_value(std::move(r));
-    delete p;
+// Resolves a bridge op's Completion. Every libp2p callback ends by handing
+// its result back through here; the slot recycles itself once both sides are
+// done with it.
+inline void finishCompletion(Completion* c, SyncResult r) {
+    c->resolve(std::move(r));
 }
 
 // Seeds a SyncResult from the (err_code, err_msg) pair every nim-ffi reply
@@ -122,14 +120,10 @@ inline SyncResult replyBase(int errCode, const char* errMsg) {
     return r;
 }
 
-// Awaits a future with timeout. Returns a failed result on timeout.
-inline SyncResult awaitResult(std::future<SyncResult>& f, int timeoutMs = kDefaultOpTimeoutMs) {
-    if (f.wait_for(std::chrono::milliseconds(timeoutMs)) == std::future_status::ready) {
-        return f.get();
-    }
-    SyncResult r;
-    r.message = "timeout";
-    return r;
+// Awaits a submitted Completion with timeout. Returns a failed result on
+// timeout, leaving the slot for the late reply to recycle.
+inline SyncResult awaitResult(Completion* c, int timeoutMs = kDefaultOpTimeoutMs) {
+    return c->await(timeoutMs);
 }
 
 // Wraps a resolved buffer as a successful result. Buffers are raw bytes
@@ -139,6 +133,21 @@ inline StdLogosResult bufferToResult(const SyncResult& r) {
     return {true, base64Encode(r.buffer), ""};
 }
 
+// The *Cbor variants' counterpart: the buffer as one CBOR byte string in a
+// binary `value`, so the bytes cross the module boundary as they are.
+inline StdLogosResult bufferToCborResult(const SyncResult& r) {
+    return {true, nlohmann::json::binary(cborByteString(r.buffer.data(), r.buffer.size())), ""};
+}
+
+// How a byte-returning *Via body hands back its buffer.
+enum class BytesFormat { Base64, Cbor };
+
+using BufferTransform = StdLogosResult (*)(const SyncResult&);
+
+inline BufferTransform bufferTransform(BytesFormat format) {
+    return format == BytesFormat::Cbor ? bufferToCborResult : bufferToResult;
+}
+
 // Non-throwing JSON parse — malformed cbinding output yields a failed result
 // instead of propagating an exception.
 inline StdLogosResult parseJsonResponse(const std::string& s, const char* errPrefix) {
@@ -157,6 +166,13 @@ inline int awaitTimeoutFor(int64_t opTimeoutMs) {
     return v > INT_MAX ? INT_MAX : static_cast<int>(v);
 }
 
+// Milliseconds left until `deadline`, rounded up so a deadline still in the
+// future never reads as 0; negative once it passed.
+inline int64_t remainingMs(std::chrono::steady_clock::time_point deadline) {
+    const auto left = deadline - std::chrono::steady_clock::now();
+    return std::chrono::ceil<std::chrono::milliseconds>(left).count();
+}
+
 // Maps a resolved SyncResult's structured payload into a result, substituting an
 // empty default when the callback produced no data (e.g. ok with zero items).
 inline StdLogosResult jsonResult(const SyncResult& r, nlohmann::json emptyDefault) {
@@ -212,8 +228,22 @@ public:
 
     StdLogosResult gossipsubPublish(const std::string& topic, const std::string& data);
     StdLogosResult gossipsubSubscribe(const std::string& topic);
+    /// gossipsubSubscribe that carries the topic's payloads as bytes: with
+    /// `encoding` "base64" its events and poll calls hold base64 text, with
+    /// "cbor" its events are gossipsubMessageCbor and its poll calls yield
+    /// CBOR byte strings. "text" is gossipsubSubscribe.
+    StdLogosResult gossipsubSubscribeEncoded(const std::string& topic, const std::string& encoding);
     StdLogosResult gossipsubUnsubscribe(const std::string& topic);
     StdLogosResult gossipsubNextMessage(const std::string& topic, int64_t timeoutMs);
+    StdLogosResult gossipsubNextMessages(const std::string& topic, int64_t maxCount,
+                                         int64_t maxBytes, int64_t timeoutMs);
+    StdLogosResult gossipsubNextMessageAny(const std::vector<std::string>& topics,
+                                           int64_t timeoutMs);
+    StdLogosResult gossipsubSetQueueBounds(const std::string& topic, int64_t maxMessages,
+                                           int64_t maxBytes);
+    StdLogosResult gossipsubClearQueueBounds(const std::string& topic);
+    StdLogosResult gossipsubSetDelivery(const std::string& topic, const std::string& mode);
+    StdLogosResult gossipsubClearDelivery(const std::string& topic);
 
     StdLogosResult toCid(const std::string& key);
     StdLogosResult kadFindNode(const std::string& peerId);
@@ -247,6 +277,72 @@ public:
 
     LogosMap collectMetrics();
 
+    // Non-blocking variants of the network-bound ops. Each returns
+    // `{"opId": N}` at once; the op's own result arrives as an
+    // `operationCompleted` event `{opId, success, value, error}` and can also be
+    // taken with operationResult(opId, timeoutMs).
+    StdLogosResult connectPeerAsync(const std::string& peerId, const std::vector<std::string>& multiaddrs, int64_t timeoutMs);
+    StdLogosResult disconnectPeerAsync(const std::string& peerId);
+    StdLogosResult dialAsync(const std::string& peerId, const std::string& proto);
+    StdLogosResult circuitRelayReserveAsync(const std::string& relayPeerId, const std::vector<std::string>& relayAddrs);
+    StdLogosResult dialCircuitRelayAsync(const std::string& dstPeerId, const std::string& multiaddr, const std::string& proto);
+
+    StdLogosResult streamReadExactlyAsync(uint64_t streamId, uint64_t len);
+    StdLogosResult streamReadLpAsync(uint64_t streamId, uint64_t maxSize);
+    StdLogosResult streamWriteAsync(uint64_t streamId, const std::string& data);
+    StdLogosResult streamWriteLpAsync(uint64_t streamId, const std::string& data);
+    StdLogosResult streamCloseAsync(uint64_t streamId);
+    StdLogosResult streamCloseWithEOFAsync(uint64_t streamId);
+    StdLogosResult streamReleaseAsync(uint64_t streamId);
+
+    StdLogosResult gossipsubPublishAsync(const std::string& topic, const std::string& data);
+
+    StdLogosResult kadFindNodeAsync(const std::string& peerId);
+    StdLogosResult kadPutValueAsync(const std::string& key, const std::string& value);
+    StdLogosResult kadGetValueAsync(const std::string& key, int64_t quorum);
+    StdLogosResult kadAddProviderAsync(const std::string& cid);
+    StdLogosResult kadStartProvidingAsync(const std::string& cid);
+    StdLogosResult kadStopProvidingAsync(const std::string& cid);
+    StdLogosResult kadGetProvidersAsync(const std::string& cid);
+    StdLogosResult kadGetRandomRecordsAsync();
+
+    StdLogosResult discoLookupAsync(const std::string& serviceId, const std::string& serviceData);
+    StdLogosResult discoRandomLookupAsync();
+
+    /// Waits up to timeoutMs (0 polls) for an async op. Yields `{done: false}`
+    /// while it runs, then `{done: true, success, value, error}` once, after
+    /// which the id is forgotten. An unknown or already-taken id fails.
+    StdLogosResult operationResult(uint64_t opId, int64_t timeoutMs);
+
+    /// Completes a running async op at once with the error "cancelled". Its
+    /// eventual reply is discarded, and a stream it opened is released.
+    /// nim-libp2p has no cancel, so the op itself still runs to its end.
+    StdLogosResult cancelOperation(uint64_t opId);
+
+    /// Submits every op in `opsJson` before waiting on any, then waits once.
+    /// Takes `[{op, args, timeoutMs?}, …]`, where `op` names one of the ops
+    /// with an *Async variant and `args` holds its parameters by name. Yields
+    /// `[{success, value, error}, …]` in the same order, once every op replied
+    /// or passed its own deadline (`timeoutMs`, else the blocking call's).
+    StdLogosResult batch(const std::string& opsJson);
+
+    // Binary variants of the byte-bearing ops, for callers that would only
+    // base64-decode what the plain ones return. Payload arguments are raw
+    // bytes. A read yields `value` as a binary JSON value holding one CBOR
+    // byte string; protocolRequestCbor takes and yields a CBOR map instead.
+    StdLogosResult streamReadExactlyCbor(uint64_t streamId, uint64_t len);
+    StdLogosResult streamReadLpCbor(uint64_t streamId, uint64_t maxSize);
+    StdLogosResult streamWriteCbor(uint64_t streamId, const std::vector<uint8_t>& data);
+    StdLogosResult streamWriteLpCbor(uint64_t streamId, const std::vector<uint8_t>& data);
+    StdLogosResult kadPutValueCbor(const std::vector<uint8_t>& key, const std::vector<uint8_t>& value);
+    StdLogosResult kadGetValueCbor(const std::vector<uint8_t>& key, int64_t quorum);
+    StdLogosResult gossipsubPublishCbor(const std::string& topic, const std::vector<uint8_t>& data);
+
+    /// protocolRequest with `argsCbor` a CBOR map of the same keys, except
+    /// that the request is the byte string `request`. Yields a CBOR map
+    /// `{response}` (a byte string), or an empty map without a response.
+    StdLogosResult protocolRequestCbor(const std::vector<uint8_t>& argsCbor);
+
 private:
     LibP2PCtx* ctx = nullptr;
     Libp2pConfig m_libp2pConfig = {};
@@ -255,6 +351,10 @@ private:
     // constructor cannot signal failure to the codegen default-constructor.
     std::string m_initError;
 
+    // Shared with the reply callbacks of in-flight async ops, which may land
+    // after this module is gone.
+    std::shared_ptr<AsyncOps> m_asyncOps = std::make_shared<AsyncOps>();
+
     // Backing storage the Libp2pConfig's NimFfiStr/seq views borrow from; it
     // must outlive every libp2p_ctx_create call. Built once in applyOptions and
     // never mutated afterwards, so the views stay valid.
@@ -272,15 +372,93 @@ private:
     // Creates a context from `cfg` without adopting it as the member `ctx`.
     SyncResult spawnContext(Libp2pConfig& cfg);
 
+    // A dial whose caller stopped waiting still opens a stream; the reaper
+    // releases it, unless `owner` is destroyed first.
+    static void releaseLateStream(LibP2PCtx* owner, uint64_t streamId);
+    static void reapLateStream(SyncResult&& late, void* owner);
+
+    // protocolRequest and protocolRequestCbor once their arguments are parsed.
+    // `value` is the response as `readTransform` maps it, or null when none was
+    // expected. Errors start with `what`.
+    StdLogosResult protocolExchange(const char* what, const std::string& peerId,
+                                    const std::string& proto,
+                                    const std::vector<std::string>& multiaddrs,
+                                    NimFfiBytes request, int64_t timeoutMs, uint64_t maxSize,
+                                    bool expectResponse, BufferTransform readTransform);
+
     // The Nim side owns stream lifetimes and hands out opaque uint64 stream
     // ids; the wrapper forwards them verbatim, so no local stream table.
 
     TopicQueues m_topicQueues;
+    TopicDelivery m_topicDelivery;
 
     std::mutex m_inboundStreamMutex;
     std::condition_variable m_inboundStreamCond;
     std::unordered_map<std::string, std::deque<uint64_t>> m_inboundStreamQueues;
 
+    // How a bridge op is driven: Sync blocks the caller until the reply, Async
+    // hands back an op id and delivers the reply through m_asyncOps, and
+    // Callback hands the reply to a caller-supplied function (the coroutine
+    // layer in coro_node.h). Ops with an *Async variant keep their body in a
+    // *Via member shared by all three.
+    enum class OpMode { Sync, Async, Callback };
+
+    struct OpTarget {
+        OpTarget(OpMode m) : mode(m) {}
+        OpTarget(OpMode m, std::chrono::steady_clock::time_point d) : mode(m), deadline(d) {}
+        OpTarget(std::function<bool(StdLogosResult)> d) : mode(OpMode::Callback), done(std::move(d)) {}
+
+        OpMode mode;
+        // Shared by the steps of a pipeline (protocolRequest): a Sync wait
+        // ends here, whatever `awaitMs` its step passes, and past it no op is
+        // submitted at all.
+        // Default-constructed means none.
+        std::chrono::steady_clock::time_point deadline{};
+        // Callback only: receives the final result exactly once, on the
+        // replying thread, and returns false if it no longer wants it.
+        std::function<bool(StdLogosResult)> done;
+        // Callback only: set once the op reached libp2p. A *Via that fails
+        // before that (bad args, no context) returns the failure instead and
+        // never calls `done`.
+        mutable bool submitted = false;
+    };
+
+    friend class CoroNode;
+
+    StdLogosResult connectPeerVia(const OpTarget& target, const std::string& peerId, const std::vector<std::string>& multiaddrs, int64_t timeoutMs);
+    StdLogosResult disconnectPeerVia(const OpTarget& target, const std::string& peerId);
+    StdLogosResult dialVia(const OpTarget& target, const std::string& peerId, const std::string& proto);
+    StdLogosResult circuitRelayReserveVia(const OpTarget& target, const std::string& relayPeerId, const std::vector<std::string>& relayAddrs);
+    StdLogosResult dialCircuitRelayVia(const OpTarget& target, const std::string& dstPeerId, const std::string& multiaddr, const std::string& proto);
+    StdLogosResult streamReadExactlyVia(const OpTarget& target, uint64_t streamId, uint64_t len,
+                                        BytesFormat format = BytesFormat::Base64);
+    StdLogosResult streamReadLpVia(const OpTarget& target, uint64_t streamId, uint64_t maxSize,
+                                   BytesFormat format = BytesFormat::Base64);
+    StdLogosResult streamWriteVia(const OpTarget& target, uint64_t streamId, const std::string& data);
+    StdLogosResult streamWriteVia(const OpTarget& target, uint64_t streamId, NimFfiBytes data);
+    StdLogosResult streamWriteLpVia(const OpTarget& target, uint64_t streamId, const std::string& data);
+    StdLogosResult streamWriteLpVia(const OpTarget& target, uint64_t streamId, NimFfiBytes data);
+    StdLogosResult streamCloseVia(const OpTarget& target, uint64_t streamId);
+    StdLogosResult streamCloseWithEOFVia(const OpTarget& target, uint64_t streamId);
+    StdLogosResult streamReleaseVia(const OpTarget& target, uint64_t streamId);
+    StdLogosResult gossipsubPublishVia(const OpTarget& target, const std::string& topic, const std::string& data);
+    StdLogosResult gossipsubPublishVia(const OpTarget& target, const std::string& topic, NimFfiBytes data);
+    StdLogosResult gossipsubSubscribeAs(const std::string& topic, TopicDelivery::Encoding encoding);
+    StdLogosResult kadFindNodeVia(const OpTarget& target, const std::string& peerId);
+    StdLogosResult kadPutValueVia(const OpTarget& target, const std::string& key, const std::string& value);
+    StdLogosResult kadPutValueVia(const OpTarget& target, NimFfiBytes key, NimFfiBytes value);
+    StdLogosResult kadGetValueVia(const OpTarget& target, const std::string& key, int64_t quorum,
+                                  BytesFormat format = BytesFormat::Base64);
+    StdLogosResult kadGetValueVia(const OpTarget& target, NimFfiBytes key, int64_t quorum,
+                                  BytesFormat format);
+    StdLogosResult kadAddProviderVia(const OpTarget& target, const std::string& cid);
+    StdLogosResult kadStartProvidingVia(const OpTarget& target, const std::string& cid);
+    StdLogosResult kadStopProvidingVia(const OpTarget& target, const std::string& cid);
+    StdLogosResult kadGetProvidersVia(const OpTarget& target, const std::string& cid);
+    StdLogosResult kadGetRandomRecordsVia(const OpTarget& target);
+    StdLogosResult discoLookupVia(const OpTarget& target, const std::string& serviceId, const std::string& serviceData);
+    StdLogosResult discoRandomLookupVia(const OpTarget& target);
+
     void applyOptions(const Libp2pModuleOptions& options);
     StdLogosResult createContext();
     void destroyContext();
@@ -288,7 +466,7 @@ private:
 
     // Reply trampolines: one per generated response type. Each turns the typed
     // (err_code, reply, err_msg) callback into a SyncResult and resolves the
-    // promise handed in as user_data.
+    // Completion handed in as user_data.
     static void cbBool(int ec, const bool* reply, const char* em, void* ud);
     static void cbBytes(int ec, const NimFfiBytes* reply, const char* em, void* ud);
     static void cbStr(int ec, const NimFfiStr* reply, const char* em, void* ud);
@@ -310,14 +488,33 @@ private:
 
     using EmitEventFn = std::function<void(const std::string& eventName, const std::string& data)>;
 
-    // Lock-guarded snapshot of `emitEvent`, taken on the caller thread before any worker can emit, so worker threads never read the public field unsynchronized.
-    mutable std::shared_mutex m_emitEventLock;
-    EmitEventFn m_emitEventSnapshot;
+    // Immutable snapshot of `emitEvent`, published on the caller thread before any worker can emit, so worker threads never read the public field unsynchronized.
+    // Dispatch is a counter bump and one load, with no lock or copy. A worker may still be calling a replaced snapshot, so it waits in `m_emitEventRetired` until a publish finds no dispatch in flight.
+    std::atomic<const EmitEventFn*> m_emitEventSnapshot{nullptr};
+    mutable std::atomic<size_t> m_emitEventReaders{0};
+    std::mutex m_emitEventPublishLock;
+    std::unique_ptr<const EmitEventFn> m_emitEventCurrent;
+    std::vector<std::unique_ptr<const EmitEventFn>> m_emitEventRetired;
     void publishEmitEvent();
-    void emitEventSafe(const std::string& name, const std::string& data) const;
-
-    // Wraps the new-promise / invoke / await / clean-up dance shared by every
-    // sync-over-async libp2p op. `invoke(SyncPromise*)` calls the cbinding and
+    /// Hands the event to the dispatcher thread when the event queue is on,
+    /// else delivers it on the calling thread.
+    void emitEventSafe(const std::string& name, std::string data);
+    /// Calls the published snapshot, if any.
+    void dispatchEvent(const std::string& name, const std::string& data) const;
+    EventQueue m_eventQueue{[this](const std::string& name, const std::string& data) {
+        dispatchEvent(name, data);
+    }};
+    // Turns gossipsubMessage events into gossipsubMessages batches when on.
+    EventBatcher m_eventBatcher{[this](std::string batch) {
+        emitEventSafe("gossipsubMessages", std::move(batch));
+    }};
+    // What onPubsubMessage does with a message.
+    const PubsubDelivery m_pubsubDelivery{
+        m_topicDelivery, m_topicQueues, m_eventBatcher,
+        [this](const char* name, std::string event) { emitEventSafe(name, std::move(event)); }};
+
+    // Wraps the acquire / invoke / await dance shared by every sync-over-async
+    // libp2p op. `invoke(Completion*)` calls the cbinding and
     // returns its sync ret. The Transform overload maps the resolved SyncResult
     // into the final StdLogosResult. `awaitMs` bounds the wait; ops carrying a
     // caller timeout pass awaitTimeoutFor(theirTimeout) so the await outlasts it.
@@ -335,28 +532,120 @@ private:
                               std::forward<Transform>(transform), awaitMs);
     }
 
+    template <class Invoke>
+    StdLogosResult callWith(const OpTarget& target, const char* errPrefix, Invoke&& invoke,
+                            int awaitMs = kDefaultOpTimeoutMs) {
+        return callWith(target, errPrefix, std::forward<Invoke>(invoke),
+            [](const SyncResult&) -> StdLogosResult { return {true, {}, ""}; }, awaitMs);
+    }
+
+    // The *Via bodies call through here. `awaitMs` only bounds a Sync wait
+    // without a target deadline; an Async or Callback op completes whenever
+    // its reply lands.
+    template <class Invoke, class Transform>
+    StdLogosResult callWith(const OpTarget& target, const char* errPrefix, Invoke&& invoke,
+                            Transform&& transform, int awaitMs = kDefaultOpTimeoutMs) {
+        if (target.deadline != std::chrono::steady_clock::time_point{}) {
+            const int64_t left = remainingMs(target.deadline);
+            if (left <= 0) return {false, {}, std::string(errPrefix) + ": deadline exceeded"};
+            // The pipeline's deadline replaces the step's own await, so a long
+            // caller timeout is not cut short at kDefaultOpTimeoutMs.
+            awaitMs = left > INT_MAX ? INT_MAX : static_cast<int>(left);
+        }
+        if (target.mode == OpMode::Sync) {
+            return callSyncWith(errPrefix, std::forward<Invoke>(invoke),
+                                std::forward<Transform>(transform), awaitMs);
+        }
+        if (!ctx) return {false, {}, "No libp2p context"};
+        if (target.mode == OpMode::Callback) {
+            target.submitted = true;
+            submitWith(errPrefix, std::forward<Invoke>(invoke), std::forward<Transform>(transform),
+                       target.done);
+            return {true, {}, ""};
+        }
+        const uint64_t opId = m_asyncOps->begin();
+        submitWith(errPrefix, std::forward<Invoke>(invoke), std::forward<Transform>(transform),
+            [ops = m_asyncOps, opId](StdLogosResult res) {
+                return ops->complete(opId, std::move(res));
+            });
+        return {true, nlohmann::json{{"opId", opId}}, ""};
+    }
+
+    // Submits without waiting: `done` receives the final StdLogosResult exactly
+    // once, on the replying thread, or on this one when the submit itself
+    // fails. `transform` then runs on the replying thread too, so it is copied
+    // into the completion and must not throw past it. `done` returns false when
+    // nobody wants the result anymore, which hands the reply to the op's late
+    // hook (a dial's stream is released).
+    template <class Invoke, class Transform, class Done>
+    static void submitWith(const char* errPrefix, Invoke&& invoke, Transform&& transform, Done&& done) {
+        auto& stats = OpStats::instance().series(errPrefix);
+        auto* c = Completion::acquire();
+        c->onReply = [errPrefix, &stats, start = stats.begin(),
+                      transform = std::decay_t<Transform>(transform),
+                      done = std::decay_t<Done>(done)](SyncResult& r) mutable -> bool {
+            StdLogosResult res;
+            if (!r.ok) {
+                res = {false, {}, std::string(errPrefix) + ": " + r.message};
+            } else {
+                try {
+                    res = transform(r);
+                } catch (const std::exception& e) {
+                    res = {false, {}, std::string(errPrefix) + ": " + e.what()};
+                }
+            }
+            stats.end(start, res.success ? OpStats::Outcome::Success : OpStats::Outcome::Failure);
+            return done(std::move(res));
+        };
+        int ret = invoke(c);
+        if (ret == 0) {
+            c->detach();
+            return;
+        }
+        // A submit-time failure normally fires the reply synchronously, which
+        // already ran `done`; otherwise it is ours to run.
+        auto fail = c->onReply;
+        if (!c->cancelSubmit()) {
+            SyncResult r;
+            r.message = "failed to submit (ret=" + std::to_string(ret) + ")";
+            fail(r);
+        }
+    }
+
     // Same dance without the context check, for the `{.ffiStatic.}` bindings:
-    // they take no ctx and run on the library's own static context.
+    // they take no ctx and run on the library's own static context. Every
+    // blocking op lands here, so this is also where its OpStats are recorded.
     template <class Invoke, class Transform>
     static StdLogosResult callStaticWith(const char* errPrefix, Invoke&& invoke, Transform&& transform,
                                          int awaitMs = kDefaultOpTimeoutMs) {
-        auto* p = new SyncPromise();
-        auto f = p->get_future();
-        int ret = invoke(p);
+        using Outcome = OpStats::Outcome;
+        auto& stats = OpStats::instance().series(errPrefix);
+        const auto start = stats.begin();
+        auto* c = Completion::acquire();
+        int ret = invoke(c);
         if (ret != 0) {
             // A submit-time failure (encode/OOM/missing-callback) fires the
-            // reply callback synchronously — which owns and deletes p — before
-            // returning non-zero. Reclaim p only in the (unexpected) case the
-            // callback didn't run, so we never double-free.
-            if (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-                delete p;
-            }
+            // reply callback synchronously before returning non-zero;
+            // cancelSubmit reclaims the slot either way.
+            c->cancelSubmit();
+            stats.end(start, Outcome::Failure);
             return {false, {}, std::string(errPrefix) +
                 " (ret=" + std::to_string(ret) + ")"};
         }
-        auto r = awaitResult(f, awaitMs);
-        if (!r.ok) return {false, {}, std::string(errPrefix) + ": " + r.message};
-        return transform(r);
+        auto r = awaitResult(c, awaitMs);
+        if (!r.ok) {
+            stats.end(start, r.message == "timeout" ? Outcome::Timeout : Outcome::Failure);
+            return {false, {}, std::string(errPrefix) + ": " + r.message};
+        }
+        StdLogosResult res;
+        try {
+            res = transform(r);
+        } catch (...) {
+            stats.end(start, Outcome::Failure);
+            throw;
+        }
+        stats.end(start, res.success ? Outcome::Success : Outcome::Failure);
+        return res;
     }
 };
 
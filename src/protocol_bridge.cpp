@@ -1,6 +1,8 @@
 #include "plugin.h"
 
+#include <algorithm>
 #include <charconv>
+#include <chrono>
 
 using json = nlohmann::json;
 
@@ -69,43 +71,97 @@ StdLogosResult Libp2pModuleImpl::protocolRequest(const std::string& argsJson) {
         return {false, {}, std::string("protocolRequest: bad requestB64: ") + e.what()};
     }
 
+    auto r = protocolExchange("protocolRequest", peerId, proto, multiaddrs,
+                              nimffiBytes(requestBytes), timeoutMs, maxSize, expectResponse,
+                              bufferToResult);
+    if (!r.success) return r;
+    if (r.value.is_null()) return {true, json::object(), ""};
+    return {true, json{{"responseB64", std::move(r.value)}}, ""};
+}
+
+StdLogosResult Libp2pModuleImpl::protocolRequestCbor(const std::vector<uint8_t>& argsCbor) {
+    const json a = json::from_cbor(argsCbor, true, false);
+    if (!a.is_object()) return {false, {}, "protocolRequestCbor: invalid CBOR map arg"};
+
+    std::string peerId, proto;
+    std::vector<std::string> multiaddrs;
+    int64_t timeoutMs = 0;
+    uint64_t maxSize = kDefaultReadMax;
+    bool expectResponse = true;
+    const json::binary_t* request = nullptr;
+    try {
+        peerId = a.at("peerId").get<std::string>();
+        proto = a.at("proto").get<std::string>();
+        request = &a.at("request").get_binary();
+        if (a.contains("multiaddrs"))
+            for (const auto& m : a["multiaddrs"]) multiaddrs.push_back(m.get<std::string>());
+        timeoutMs = a.value("timeoutMs", static_cast<int64_t>(0));
+        maxSize = asReadMax(a);
+        expectResponse = a.value("expectResponse", true);
+    } catch (...) {
+        return {false, {},
+                "protocolRequestCbor: bad args (need {peerId,proto,multiaddrs?,request: bytes,timeoutMs?,maxSize?,expectResponse?})"};
+    }
+
+    // The response stays raw bytes until the one CBOR encode below.
+    auto r = protocolExchange("protocolRequestCbor", peerId, proto, multiaddrs,
+                              nimffiBytes(*request), timeoutMs, maxSize, expectResponse,
+                              [](const SyncResult& res) -> StdLogosResult {
+                                  return {true, json::binary(res.buffer), ""};
+                              });
+    if (!r.success) return r;
+    json out = json::object();
+    if (!r.value.is_null()) out["response"] = std::move(r.value);
+    return {true, json::binary(json::to_cbor(out)), ""};
+}
+
+StdLogosResult Libp2pModuleImpl::protocolExchange(const char* what, const std::string& peerId,
+                                                  const std::string& proto,
+                                                  const std::vector<std::string>& multiaddrs,
+                                                  NimFfiBytes request, int64_t timeoutMs,
+                                                  uint64_t maxSize, bool expectResponse,
+                                                  BufferTransform readTransform) {
+    const std::string prefix = std::string(what) + ": ";
+
+    // One deadline for the whole exchange: each step waits only for what is
+    // left of it, and the stream is released as soon as a step fails.
+    const OpTarget step(OpMode::Sync, std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : kDefaultOpTimeoutMs));
+
     if (!multiaddrs.empty()) {
-        auto c = connectPeer(peerId, multiaddrs, timeoutMs > 0 ? timeoutMs : kDefaultOpTimeoutMs);
-        if (!c.success) return {false, {}, "protocolRequest: connect failed: " + c.error};
+        auto c = connectPeerVia(step, peerId, multiaddrs, std::max<int64_t>(remainingMs(step.deadline), 1));
+        if (!c.success) return {false, {}, prefix + "connect failed: " + c.error};
     }
 
-    auto d = dial(peerId, proto);
-    if (!d.success) return {false, {}, "protocolRequest: dial failed: " + d.error};
+    auto d = dialVia(step, peerId, proto);
+    if (!d.success) return {false, {}, prefix + "dial failed: " + d.error};
     uint64_t streamId = 0;
     try { streamId = d.value.get<uint64_t>(); } catch (...) {}
-    if (streamId == 0) return {false, {}, "protocolRequest: dial returned no stream"};
+    if (streamId == 0) return {false, {}, prefix + "dial returned no stream"};
 
-    auto w = streamWriteLp(streamId, requestBytes);
+    auto w = streamWriteLpVia(step, streamId, request);
     if (!w.success) {
         streamRelease(streamId);
-        return {false, {}, "protocolRequest: write failed: " + w.error};
+        return {false, {}, prefix + "write failed: " + w.error};
     }
 
     if (!expectResponse) {
         streamCloseWithEOF(streamId);
         streamRelease(streamId);
-        return {true, json::object(), ""};
+        return {true, {}, ""};
     }
 
     StreamReadLpRequest readReq{};
     readReq.streamId = streamId;
     readReq.maxSize = static_cast<int64_t>(maxSize);
-    auto r = callSyncWith("Failed to read LP from stream",
-        [&](SyncPromise* p) {
+    auto r = callWith(step, "Failed to read LP from stream",
+        [&](Completion* p) {
             return libp2p_ctx_stream_read_lp(ctx, &readReq, &Libp2pModuleImpl::cbRead, p);
         },
-        bufferToResult, awaitTimeoutFor(timeoutMs));
+        readTransform);
     streamRelease(streamId);
-    if (!r.success) return {false, {}, "protocolRequest: read failed: " + r.error};
-
-    json out;
-    out["responseB64"] = r.value;
-    return {true, out, ""};
+    if (!r.success) return {false, {}, prefix + "read failed: " + r.error};
+    return r;
 }
 
 StdLogosResult Libp2pModuleImpl::streamReadLpJson(const std::string& argsJson) {
@@ -128,7 +184,7 @@ StdLogosResult Libp2pModuleImpl::streamReadLpJson(const std::string& argsJson) {
     readReq.streamId = streamId;
     readReq.maxSize = static_cast<int64_t>(maxSize);
     auto r = callSyncWith("Failed to read LP from stream",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_stream_read_lp(ctx, &readReq, &Libp2pModuleImpl::cbRead, p);
         },
         bufferToResult, awaitTimeoutFor(timeoutMs));
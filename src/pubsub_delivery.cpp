@@ -0,0 +1,29 @@
+#include "pubsub_delivery.h"
+
+#include "payload.h"
+#include "utils.h"
+
+void PubsubDelivery::deliver(const std::string& topic, const uint8_t* data, size_t len) const {
+    const auto route = routes.routeFor(topic);
+    if (route.mode == TopicDelivery::kNone) return;
+    // An encoded topic's queue still holds the raw bytes; the poll calls
+    // encode what they take.
+    Payload payload = makePayload(data, len);
+    if (!(route.mode & TopicDelivery::kEvent)) {
+        queues.push(topic, std::move(payload));
+        return;
+    }
+    if (route.encoding == TopicDelivery::kCbor) {
+        // Not JSON, so never batched.
+        std::string event = pubsubMessageCbor(topic, *payload);
+        if (route.mode & TopicDelivery::kQueue) queues.push(topic, std::move(payload));
+        emit("gossipsubMessageCbor", std::move(event));
+        return;
+    }
+    std::string event = route.encoding == TopicDelivery::kBase64
+        ? pubsubMessageBase64Json(topic, *payload)
+        : pubsubMessageJson(topic, *payload);
+
+    if (route.mode & TopicDelivery::kQueue) queues.push(topic, std::move(payload));
+    if (!batcher.add(topic, event)) emit("gossipsubMessage", std::move(event));
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "event_batcher.h"
+#include "topic_delivery.h"
+#include "topic_queues.h"
+
+// Where a received gossipsub message goes, and the copies it costs getting
+// there: onPubsubMessage's body, kept free of the module so a test can drive
+// the real path. The bytes are copied once off the wire; the event is
+// serialized from that copy, and the queue keeps the copy itself.
+struct PubsubDelivery {
+    /// Receives an event's name and body.
+    using Emit = std::function<void(const char* name, std::string event)>;
+
+    const TopicDelivery& routes;
+    TopicQueues& queues;
+    EventBatcher& batcher;
+    Emit emit;
+
+    /// Throws what the serializers throw (non-UTF-8 text on a text topic).
+    void deliver(const std::string& topic, const uint8_t* data, size_t len) const;
+};
@@ -3,13 +3,13 @@
 using json = nlohmann::json;
 
 StdLogosResult Libp2pModuleImpl::discoStart() {
-    return callSync("Failed to start discovery", [&](SyncPromise* p) {
+    return callSync("Failed to start discovery", [&](Completion* p) {
         return libp2p_ctx_service_disco_start(ctx, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::discoStop() {
-    return callSync("Failed to stop discovery", [&](SyncPromise* p) {
+    return callSync("Failed to stop discovery", [&](Completion* p) {
         return libp2p_ctx_service_disco_stop(ctx, &Libp2pModuleImpl::cbBool, p);
     });
 }
@@ -37,28 +37,28 @@ StdLogosResult Libp2pModuleImpl::discoStartAdvertising(
     req.serviceId = nimffi_str(serviceId.c_str());
     req.serviceData = nimffiBytes(serviceData);
     req.advertisement = nimffiBytes(advertBytes);
-    return callSync("Failed to start advertising", [&](SyncPromise* p) {
+    return callSync("Failed to start advertising", [&](Completion* p) {
         return libp2p_ctx_service_disco_start_advertising(ctx, &req,
                                                           &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::discoStopAdvertising(const std::string& serviceId) {
-    return callSync("Failed to stop advertising", [&](SyncPromise* p) {
+    return callSync("Failed to stop advertising", [&](Completion* p) {
         return libp2p_ctx_service_disco_stop_advertising(ctx, nimffi_str(serviceId.c_str()),
                                                          &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::discoRegisterInterest(const std::string& serviceId) {
-    return callSync("Failed to register interest", [&](SyncPromise* p) {
+    return callSync("Failed to register interest", [&](Completion* p) {
         return libp2p_ctx_service_disco_register_interest(ctx, nimffi_str(serviceId.c_str()),
                                                           &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::discoUnregisterInterest(const std::string& serviceId) {
-    return callSync("Failed to unregister interest", [&](SyncPromise* p) {
+    return callSync("Failed to unregister interest", [&](Completion* p) {
         return libp2p_ctx_service_disco_unregister_interest(ctx, nimffi_str(serviceId.c_str()),
                                                             &Libp2pModuleImpl::cbBool, p);
     });
@@ -67,20 +67,43 @@ StdLogosResult Libp2pModuleImpl::discoUnregisterInterest(const std::string& serv
 StdLogosResult Libp2pModuleImpl::discoLookup(
     const std::string& serviceId,
     const std::string& serviceData)
+{
+    return discoLookupVia(OpMode::Sync, serviceId, serviceData);
+}
+
+StdLogosResult Libp2pModuleImpl::discoLookupAsync(
+    const std::string& serviceId,
+    const std::string& serviceData)
+{
+    return discoLookupVia(OpMode::Async, serviceId, serviceData);
+}
+
+StdLogosResult Libp2pModuleImpl::discoLookupVia(
+    const OpTarget& target,
+    const std::string& serviceId,
+    const std::string& serviceData)
 {
     LookupRequest req{};
     req.serviceId = nimffi_str(serviceId.c_str());
     req.serviceData = nimffiBytes(serviceData);
-    return callSyncWith("Failed to lookup",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to lookup",
+        [&](Completion* p) {
             return libp2p_ctx_service_disco_lookup(ctx, &req, &Libp2pModuleImpl::cbRecords, p);
         },
         [](const SyncResult& r) { return jsonResult(r, json::array()); });
 }
 
 StdLogosResult Libp2pModuleImpl::discoRandomLookup() {
-    return callSyncWith("Failed to random lookup",
-        [&](SyncPromise* p) {
+    return discoRandomLookupVia(OpMode::Sync);
+}
+
+StdLogosResult Libp2pModuleImpl::discoRandomLookupAsync() {
+    return discoRandomLookupVia(OpMode::Async);
+}
+
+StdLogosResult Libp2pModuleImpl::discoRandomLookupVia(const OpTarget& target) {
+    return callWith(target, "Failed to random lookup",
+        [&](Completion* p) {
             return libp2p_ctx_service_disco_random_lookup(ctx, &Libp2pModuleImpl::cbRecords, p);
         },
         [](const SyncResult& r) { return jsonResult(r, json::array()); });
@@ -113,7 +136,7 @@ StdLogosResult Libp2pModuleImpl::createXpr(
     req.seqNo = seqNo;
 
     return callSyncWith("Failed to create XPR",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_ctx_create_xpr(ctx, &req, &Libp2pModuleImpl::cbBytes, p);
         },
         bufferToResult);
@@ -141,7 +164,7 @@ StdLogosResult Libp2pModuleImpl::decodeXpr(const std::string& xpr) {
     req.encoded = nimffiBytes(bytes);
 
     return callStaticWith("Failed to decode XPR",
-        [&](SyncPromise* p) {
+        [&](Completion* p) {
             return libp2p_static_decode_xpr(&req, &Libp2pModuleImpl::cbRecord, p);
         },
         [](const SyncResult& r) -> StdLogosResult {
@@ -0,0 +1,113 @@
+#include "spill_log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SpillLog::SpillLog(std::string pathPrefix, std::atomic<size_t>& diskBytes, size_t segmentBytes)
+    : m_pathPrefix(std::move(pathPrefix)), m_diskBytes(diskBytes), m_segmentBytes(segmentBytes) {}
+
+SpillLog::~SpillLog() {
+    clear();
+}
+
+bool SpillLog::append(const std::string& payload, TimePoint queuedAt, size_t maxDiskBytes) {
+    if (payload.size() > UINT32_MAX) return false;
+    const size_t rec = recordBytes(payload.size());
+    if ((m_segments.empty() || m_segments.back().size - m_segments.back().writeAt < rec) &&
+        !addSegment(rec, maxDiskBytes)) {
+        return false;
+    }
+    Segment& tail = m_segments.back();
+    const auto len = static_cast<uint32_t>(payload.size());
+    const TimePoint::rep stamp = queuedAt.time_since_epoch().count();
+    char* at = tail.base + tail.writeAt;
+    std::memcpy(at, &len, sizeof(len));
+    std::memcpy(at + sizeof(len), &stamp, sizeof(stamp));
+    std::memcpy(at + kHeaderBytes, payload.data(), payload.size());
+    tail.writeAt += rec;
+    ++m_count;
+    return true;
+}
+
+bool SpillLog::pop(std::string& out, TimePoint& queuedAt, size_t maxSize) {
+    if (m_count == 0) return false;
+    Segment& head = m_segments.front();
+    const char* at = head.base + head.readAt;
+    uint32_t len;
+    std::memcpy(&len, at, sizeof(len));
+    if (len > maxSize) return false;
+    TimePoint::rep stamp;
+    std::memcpy(&stamp, at + sizeof(len), sizeof(stamp));
+    queuedAt = TimePoint(TimePoint::duration(stamp));
+    out.assign(at + kHeaderBytes, len);
+
+    const size_t rec = recordBytes(len);
+    head.readAt += rec;
+    --m_count;
+    // Read through, even as the tail: a drained topic gives its disk back to
+    // the others rather than keeping a segment for its next stall.
+    if (head.readAt == head.writeAt) {
+        unmap(head);
+        m_segments.pop_front();
+    }
+    return true;
+}
+
+bool SpillLog::oldest(TimePoint& queuedAt) const {
+    if (m_count == 0) return false;
+    const Segment& head = m_segments.front();
+    TimePoint::rep stamp;
+    std::memcpy(&stamp, head.base + head.readAt + sizeof(uint32_t), sizeof(stamp));
+    queuedAt = TimePoint(TimePoint::duration(stamp));
+    return true;
+}
+
+void SpillLog::clear() {
+    for (const Segment& s : m_segments) unmap(s);
+    m_segments.clear();
+    m_count = 0;
+}
+
+bool SpillLog::addSegment(size_t minBytes, size_t maxDiskBytes) {
+    // Reserve the whole segment, since its blocks are allocated up front, but
+    // no more than the budget has left.
+    size_t used = m_diskBytes.load(std::memory_order_relaxed);
+    size_t size;
+    do {
+        if (used > maxDiskBytes || minBytes > maxDiskBytes - used) return false;
+        size = std::min(std::max(m_segmentBytes, minBytes), maxDiskBytes - used);
+    } while (!m_diskBytes.compare_exchange_weak(used, used + size, std::memory_order_relaxed));
+
+    const std::string path = m_pathPrefix + "." + std::to_string(m_nextSegment++);
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        m_diskBytes.fetch_sub(size, std::memory_order_relaxed);
+        return false;
+    }
+    // Allocate the blocks up front where we can: a store into a hole the disk
+    // has no room for is a SIGBUS, not an error we could return.
+#if defined(__linux__)
+    const bool sized = posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0;
+#else
+    const bool sized = ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+    void* base = sized ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                       : MAP_FAILED;
+    close(fd);
+    unlink(path.c_str());
+    if (base == MAP_FAILED) {
+        m_diskBytes.fetch_sub(size, std::memory_order_relaxed);
+        return false;
+    }
+    m_segments.push_back(Segment{static_cast<char*>(base), size, 0, 0});
+    return true;
+}
+
+void SpillLog::unmap(const Segment& segment) {
+    munmap(segment.base, segment.size);
+    m_diskBytes.fetch_sub(segment.size, std::memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// FIFO of payloads in memory-mapped segment files, for a topic queue to spill
+// into while its consumer stalls. append() writes at the tail segment and maps
+// a new one once it fills; pop() reads from the head and unmaps each segment it
+// has read through, the last one included. A segment's file is unlinked as soon as it is mapped, so
+// the disk space goes away with the mapping, even if the process dies.
+//
+// Not thread-safe: the owning topic's lock guards it. The byte count is shared,
+// so every log under one budget charges the same counter, and it counts the
+// segments mapped, not the records in them: a half-read head segment keeps all
+// of its blocks until it is unmapped.
+class SpillLog {
+public:
+    static constexpr size_t kSegmentBytes = 4 * 1024 * 1024;
+
+    /// Segment files are created as `<pathPrefix>.<n>`. `diskBytes` is charged
+    /// for every segment mapped and must outlive the log.
+    SpillLog(std::string pathPrefix, std::atomic<size_t>& diskBytes,
+             size_t segmentBytes = kSegmentBytes);
+    ~SpillLog();
+
+    SpillLog(const SpillLog&) = delete;
+    SpillLog& operator=(const SpillLog&) = delete;
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /// Appends `payload`, stamped `queuedAt`, unless it needs a new segment
+    /// and `diskBytes` has less than its record left under `maxDiskBytes`, or
+    /// the segment cannot be created; either way returns false. A new segment
+    /// is cut short to what is left of the budget.
+    bool append(const std::string& payload, TimePoint queuedAt, size_t maxDiskBytes);
+
+    /// Copies out the oldest payload and its stamp, or returns false when empty
+    /// or when that payload is larger than `maxSize`, which then stays put.
+    bool pop(std::string& out, TimePoint& queuedAt, size_t maxSize = SIZE_MAX);
+
+    /// The oldest payload's stamp; false when empty.
+    bool oldest(TimePoint& queuedAt) const;
+
+    /// Drops every record.
+    void clear();
+
+    bool empty() const { return m_count == 0; }
+    size_t count() const { return m_count; }
+
+    /// The room a payload of `size` takes in a segment.
+    static size_t recordBytes(size_t size) { return kHeaderBytes + size; }
+
+private:
+    // A record is its length, its stamp, then the payload.
+    static constexpr size_t kHeaderBytes = sizeof(uint32_t) + sizeof(TimePoint::rep);
+
+    struct Segment {
+        char* base;
+        size_t size;
+        size_t writeAt;
+        size_t readAt;
+    };
+
+    bool addSegment(size_t minBytes, size_t maxDiskBytes);
+    void unmap(const Segment& segment);
+
+    const std::string m_pathPrefix;
+    std::atomic<size_t>& m_diskBytes;
+    const size_t m_segmentBytes;
+    std::deque<Segment> m_segments;
+    uint64_t m_nextSegment = 0;
+    size_t m_count = 0;
+};
@@ -15,63 +15,150 @@ std::string tooLarge(const char* what) {
 }  // namespace
 
 StdLogosResult Libp2pModuleImpl::streamReadExactly(uint64_t streamId, uint64_t len) {
+    return streamReadExactlyVia(OpMode::Sync, streamId, len);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReadExactlyAsync(uint64_t streamId, uint64_t len) {
+    return streamReadExactlyVia(OpMode::Async, streamId, len);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReadExactlyCbor(uint64_t streamId, uint64_t len) {
+    return streamReadExactlyVia(OpMode::Sync, streamId, len, BytesFormat::Cbor);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReadExactlyVia(const OpTarget& target, uint64_t streamId,
+                                                      uint64_t len, BytesFormat format) {
     if (!withinReadCap(len)) return {false, {}, tooLarge("Failed to read from stream: length")};
     StreamReadExactlyRequest req{};
     req.streamId = streamId;
     req.numBytes = static_cast<int64_t>(len);
-    return callSyncWith("Failed to read from stream",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to read from stream",
+        [&](Completion* p) {
             return libp2p_ctx_stream_read_exactly(ctx, &req, &Libp2pModuleImpl::cbRead, p);
         },
-        bufferToResult);
+        bufferTransform(format));
 }
 
 StdLogosResult Libp2pModuleImpl::streamReadLp(uint64_t streamId, uint64_t maxSize) {
+    return streamReadLpVia(OpMode::Sync, streamId, maxSize);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReadLpAsync(uint64_t streamId, uint64_t maxSize) {
+    return streamReadLpVia(OpMode::Async, streamId, maxSize);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReadLpCbor(uint64_t streamId, uint64_t maxSize) {
+    return streamReadLpVia(OpMode::Sync, streamId, maxSize, BytesFormat::Cbor);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReadLpVia(const OpTarget& target, uint64_t streamId,
+                                                 uint64_t maxSize, BytesFormat format) {
     if (!withinReadCap(maxSize)) {
         return {false, {}, tooLarge("Failed to read LP from stream: maxSize")};
     }
     StreamReadLpRequest req{};
     req.streamId = streamId;
     req.maxSize = static_cast<int64_t>(maxSize);
-    return callSyncWith("Failed to read LP from stream",
-        [&](SyncPromise* p) {
+    return callWith(target, "Failed to read LP from stream",
+        [&](Completion* p) {
             return libp2p_ctx_stream_read_lp(ctx, &req, &Libp2pModuleImpl::cbRead, p);
         },
-        bufferToResult);
+        bufferTransform(format));
 }
 
 StdLogosResult Libp2pModuleImpl::streamWrite(uint64_t streamId, const std::string& data) {
+    return streamWriteVia(OpMode::Sync, streamId, data);
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteAsync(uint64_t streamId, const std::string& data) {
+    return streamWriteVia(OpMode::Async, streamId, data);
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteCbor(uint64_t streamId, const std::vector<uint8_t>& data) {
+    return streamWriteVia(OpMode::Sync, streamId, nimffiBytes(data));
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteVia(const OpTarget& target, uint64_t streamId,
+                                                const std::string& data) {
+    return streamWriteVia(target, streamId, nimffiBytes(data));
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteVia(const OpTarget& target, uint64_t streamId,
+                                                NimFfiBytes data) {
     StreamWriteRequest req{};
     req.streamId = streamId;
-    req.data = nimffiBytes(data);
-    return callSync("Failed to write to stream", [&](SyncPromise* p) {
+    req.data = data;
+    return callWith(target, "Failed to write to stream", [&](Completion* p) {
         return libp2p_ctx_stream_write(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::streamWriteLp(uint64_t streamId, const std::string& data) {
+    return streamWriteLpVia(OpMode::Sync, streamId, data);
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteLpAsync(uint64_t streamId, const std::string& data) {
+    return streamWriteLpVia(OpMode::Async, streamId, data);
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteLpCbor(uint64_t streamId,
+                                                   const std::vector<uint8_t>& data) {
+    return streamWriteLpVia(OpMode::Sync, streamId, nimffiBytes(data));
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteLpVia(const OpTarget& target, uint64_t streamId,
+                                                  const std::string& data) {
+    return streamWriteLpVia(target, streamId, nimffiBytes(data));
+}
+
+StdLogosResult Libp2pModuleImpl::streamWriteLpVia(const OpTarget& target, uint64_t streamId,
+                                                  NimFfiBytes data) {
     StreamWriteRequest req{};
     req.streamId = streamId;
-    req.data = nimffiBytes(data);
-    return callSync("Failed to write LP to stream", [&](SyncPromise* p) {
+    req.data = data;
+    return callWith(target, "Failed to write LP to stream", [&](Completion* p) {
         return libp2p_ctx_stream_write_lp(ctx, &req, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::streamClose(uint64_t streamId) {
-    return callSync("Failed to close stream", [&](SyncPromise* p) {
+    return streamCloseVia(OpMode::Sync, streamId);
+}
+
+StdLogosResult Libp2pModuleImpl::streamCloseAsync(uint64_t streamId) {
+    return streamCloseVia(OpMode::Async, streamId);
+}
+
+StdLogosResult Libp2pModuleImpl::streamCloseVia(const OpTarget& target, uint64_t streamId) {
+    return callWith(target, "Failed to close stream", [&](Completion* p) {
         return libp2p_ctx_stream_close(ctx, streamId, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::streamCloseWithEOF(uint64_t streamId) {
-    return callSync("Failed to close stream with EOF", [&](SyncPromise* p) {
+    return streamCloseWithEOFVia(OpMode::Sync, streamId);
+}
+
+StdLogosResult Libp2pModuleImpl::streamCloseWithEOFAsync(uint64_t streamId) {
+    return streamCloseWithEOFVia(OpMode::Async, streamId);
+}
+
+StdLogosResult Libp2pModuleImpl::streamCloseWithEOFVia(const OpTarget& target, uint64_t streamId) {
+    return callWith(target, "Failed to close stream with EOF", [&](Completion* p) {
         return libp2p_ctx_stream_close_with_eof(ctx, streamId, &Libp2pModuleImpl::cbBool, p);
     });
 }
 
 StdLogosResult Libp2pModuleImpl::streamRelease(uint64_t streamId) {
-    return callSync("Failed to release stream", [&](SyncPromise* p) {
+    return streamReleaseVia(OpMode::Sync, streamId);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReleaseAsync(uint64_t streamId) {
+    return streamReleaseVia(OpMode::Async, streamId);
+}
+
+StdLogosResult Libp2pModuleImpl::streamReleaseVia(const OpTarget& target, uint64_t streamId) {
+    return callWith(target, "Failed to release stream", [&](Completion* p) {
         return libp2p_ctx_stream_release(ctx, streamId, &Libp2pModuleImpl::cbBool, p);
     });
 }
@@ -0,0 +1,91 @@
+#include "topic_delivery.h"
+
+#include <mutex>
+
+bool TopicDelivery::parse(const std::string& text, Mode& out) {
+    static const std::unordered_map<std::string, Mode> kModes = {
+        {"both", kBoth}, {"event", kEvent}, {"queue", kQueue}, {"none", kNone}};
+    auto it = kModes.find(text);
+    if (it == kModes.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool TopicDelivery::parseEncoding(const std::string& text, Encoding& out) {
+    static const std::unordered_map<std::string, Encoding> kEncodings = {
+        {"text", kText}, {"base64", kBase64}, {"cbor", kCbor}};
+    auto it = kEncodings.find(text);
+    if (it == kEncodings.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void TopicDelivery::setDefault(Mode mode) {
+    m_default.store(mode, std::memory_order_relaxed);
+}
+
+void TopicDelivery::set(const std::string& topic, Mode mode) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    Entry& entry = m_topics[topic];
+    entry.mode = mode;
+    entry.hasMode = true;
+    m_hasTopics.store(true, std::memory_order_release);
+}
+
+bool TopicDelivery::clear(const std::string& topic) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_topics.find(topic);
+    if (it == m_topics.end() || !it->second.hasMode) return false;
+    it->second.hasMode = false;
+    prune(it);
+    return true;
+}
+
+void TopicDelivery::setModes(const std::map<std::string, Mode>& modes) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (auto it = m_topics.begin(); it != m_topics.end();) {
+        if (it->second.encoding == kText) {
+            it = m_topics.erase(it);
+        } else {
+            it->second.hasMode = false;
+            ++it;
+        }
+    }
+    for (const auto& [topic, mode] : modes) {
+        Entry& entry = m_topics[topic];
+        entry.mode = mode;
+        entry.hasMode = true;
+    }
+    m_hasTopics.store(!m_topics.empty(), std::memory_order_release);
+}
+
+void TopicDelivery::setEncoding(const std::string& topic, Encoding encoding) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (encoding == kText) {
+        auto it = m_topics.find(topic);
+        if (it == m_topics.end()) return;
+        it->second.encoding = kText;
+        prune(it);
+        return;
+    }
+    m_topics[topic].encoding = encoding;
+    m_hasTopics.store(true, std::memory_order_release);
+}
+
+void TopicDelivery::prune(std::unordered_map<std::string, Entry>::iterator it) {
+    if (it->second.hasMode || it->second.encoding != kText) return;
+    m_topics.erase(it);
+    m_hasTopics.store(!m_topics.empty(), std::memory_order_release);
+}
+
+TopicDelivery::Route TopicDelivery::routeFor(const std::string& topic) const {
+    if (m_hasTopics.load(std::memory_order_acquire)) {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (auto it = m_topics.find(topic); it != m_topics.end()) {
+            const Entry& entry = it->second;
+            return {entry.hasMode ? entry.mode : m_default.load(std::memory_order_relaxed),
+                    entry.encoding};
+        }
+    }
+    return {m_default.load(std::memory_order_relaxed), kText};
+}
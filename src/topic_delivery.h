@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// Which paths a topic's messages take: the gossipsubMessage event, the poll
+// queue, both (the default) or neither. onPubsubMessage skips whatever no path
+// needs, so a polling-only topic never serializes its messages and an
+// event-only one never queues them.
+//
+// A topic subscribed with an encoding other than text also carries its
+// payloads as bytes on both paths: base64 text in the usual places, or CBOR
+// byte strings, so non-UTF-8 payloads survive the JSON boundary.
+//
+// Looking a topic up costs one atomic load until some topic has a mode of its
+// own; only then does it take a read lock.
+class TopicDelivery {
+public:
+    enum Mode : uint8_t { kNone = 0, kEvent = 1, kQueue = 2, kBoth = kEvent | kQueue };
+    enum Encoding : uint8_t { kText, kBase64, kCbor };
+
+    struct Route {
+        Mode mode;
+        Encoding encoding;
+    };
+
+    /// "both", "event", "queue" or "none".
+    static bool parse(const std::string& text, Mode& out);
+    /// "text", "base64" or "cbor".
+    static bool parseEncoding(const std::string& text, Encoding& out);
+
+    /// The mode of every topic without one of its own.
+    void setDefault(Mode mode);
+    void set(const std::string& topic, Mode mode);
+    /// Drops the topic's own mode; returns false when it had none.
+    bool clear(const std::string& topic);
+    /// Replaces every topic's own mode with `modes` at once, as reapplying a
+    /// config does. Encodings stay with their subscriptions.
+    void setModes(const std::map<std::string, Mode>& modes);
+
+    /// Every topic is text until given an encoding; kText drops it again.
+    void setEncoding(const std::string& topic, Encoding encoding);
+
+    Route routeFor(const std::string& topic) const;
+    Mode forTopic(const std::string& topic) const { return routeFor(topic).mode; }
+
+private:
+    struct Entry {
+        Mode mode = kBoth;
+        bool hasMode = false;
+        Encoding encoding = kText;
+    };
+
+    // Erases an entry left with neither a mode nor an encoding. Caller holds
+    // m_mutex exclusively.
+    void prune(std::unordered_map<std::string, Entry>::iterator it);
+
+    std::atomic<Mode> m_default{kBoth};
+    std::atomic<bool> m_hasTopics{false};
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_topics;
+};
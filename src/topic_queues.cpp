@@ -1,103 +1,746 @@
 #include "topic_queues.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iterator>
 #include <utility>
 
+#include <unistd.h>
+
 void TopicQueues::setBounds(size_t maxMessages, size_t maxBytes) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_maxMessages = maxMessages;
-    m_maxBytes = maxBytes;
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_bounds = {maxMessages, maxBytes};
+    rebound();
+}
+
+void TopicQueues::setTopicBounds(const std::string& pattern, Bounds bounds) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_topicBounds[pattern] = bounds;
+    rebound();
+}
+
+bool TopicQueues::clearTopicBounds(const std::string& pattern) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    if (m_topicBounds.erase(pattern) == 0) return false;
+    rebound();
+    return true;
+}
+
+void TopicQueues::setTopicBounds(std::map<std::string, Bounds> all) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_topicBounds = std::move(all);
+    rebound();
+}
+
+void TopicQueues::setTotalMaxBytes(size_t maxBytes) {
+    m_totalMaxBytes.store(maxBytes, std::memory_order_relaxed);
+}
+
+void TopicQueues::setBackend(Backend backend) {
+    m_backend.store(backend, std::memory_order_relaxed);
+}
+
+void TopicQueues::setSpill(std::string dir, size_t maxBytes) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_spillMaxBytes.store(dir.empty() ? 0 : maxBytes, std::memory_order_relaxed);
+    m_spillDir = std::move(dir);
+}
+
+void TopicQueues::setPolicy(Policy policy) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_policy = std::move(policy);
+}
+
+void TopicQueues::setTopicPolicy(const std::string& topic, Policy policy) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_topicPolicies[topic] = std::move(policy);
+}
+
+void TopicQueues::setTopicPolicies(std::map<std::string, Policy> all) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    m_topicPolicies = std::move(all);
 }
 
-bool TopicQueues::push(const std::string& topic, std::string payload) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (m_maxMessages == 0 || m_maxBytes == 0) {
+bool TopicQueues::push(const std::string& topic, Payload payload) {
+    m_messageBytes.observe(static_cast<double>(payload->size()));
+
+    // The map lock is held shared throughout, so release() cannot unlink the
+    // entry between the lookup and the enqueue. The first message on a topic
+    // takes it exclusively once to add the entry, unless the topic's backlog
+    // is disabled anyway.
+    std::shared_lock<std::shared_mutex> map(m_mapMutex);
+    auto it = m_topics.find(topic);
+    while (it == m_topics.end()) {
+        const Bounds b = boundsFor(topic);
+        if (b.maxMessages == 0 || b.maxBytes == 0) return false;
+        map.unlock();
+        findOrAdd(topic);
+        map.lock();
+        it = m_topics.find(topic);
+    }
+    Topic& t = *it->second;
+    const size_t maxMessages = t.maxMessages.load(std::memory_order_relaxed);
+    const size_t maxBytes = t.maxBytes.load(std::memory_order_relaxed);
+    if (maxMessages == 0 || maxBytes == 0) {
         return false;
     }
-    auto& t = m_topics[topic];
-    // Subtract instead of adding, so a huge payload cannot wrap the sum.
-    const bool exceedsByteBound =
-        payload.size() > m_maxBytes || t.bytes > m_maxBytes - payload.size();
-    if (t.messages.size() >= m_maxMessages || exceedsByteBound) {
-        ++t.dropped;
+    t.pushed.store(true, std::memory_order_relaxed);
+    const size_t size = payload->size();
+    bool admitted = admit(t, size);
+    // A topic that spills takes what the budget refuses to disk instead.
+    if (!admitted && !t.spill) {
+        t.countDrop(kBudget);
+        return false;
+    }
+
+    bool queued;
+    if (t.ring) {
+        const size_t cap = std::min(maxMessages, t.ring->capacity());
+        queued = true;
+        while (queued && !t.reserve(size, cap, maxBytes)) {
+            // DropOldest evicts at the consumers' end of the ring. A payload
+            // over the byte bound would empty it and still not fit.
+            if (t.policy.overflow == Overflow::DropNewest || size > maxBytes ||
+                !t.evictOldest(kEvicted)) {
+                t.countDrop(kFull);
+                queued = false;
+            }
+        }
+        if (queued && !t.ring->tryPush(std::move(payload), Clock::now())) {
+            // Unreachable while depth bounds the ring; undo rather than trust that.
+            t.depth.fetch_sub(1, std::memory_order_relaxed);
+            t.bytes.fetch_sub(size, std::memory_order_relaxed);
+            t.countDrop(kFull);
+            queued = false;
+        }
+        if (queued) {
+            // Pairs with the fences in the wait paths: either the waiter sees
+            // the message, or this sees the waiter and wakes it through the lock.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (t.waiters.load(std::memory_order_relaxed) == 0) return true;
+            std::lock_guard<std::mutex> lock(t.mutex);
+            for (Selector* s : t.selectors) s->signal();
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        queued = t.spill ? offerOrSpill(t, std::move(payload), admitted, maxMessages, maxBytes)
+                         : t.offer(std::move(payload), maxMessages, maxBytes);
+        if (queued) {
+            for (Selector* s : t.selectors) s->signal();
+        }
+    }
+    if (!queued) {
+        if (admitted) m_totalBytes.fetch_sub(size, std::memory_order_relaxed);
         return false;
     }
-    t.bytes += payload.size();
-    t.messages.push(std::move(payload));
-    m_cond.notify_all();
+    // One message, one consumer.
+    t.cond.notify_one();
     return true;
 }
 
+template <class Take>
+bool TopicQueues::waitToTake(const std::string& topic, int64_t timeoutMs, Take&& take) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        TopicPtr t;
+        if (timeoutMs > 0) {
+            t = findOrAdd(topic);
+        } else {
+            // A poll never waits, so it needs no entry of its own.
+            std::shared_lock<std::shared_mutex> map(m_mapMutex);
+            auto it = m_topics.find(topic);
+            if (it == m_topics.end()) return false;
+            t = it->second;
+        }
+
+        // A ring hands over a queued message without the lock.
+        if (t->ring && take(*t)) return true;
+
+        std::unique_lock<std::mutex> lock(t->mutex);
+        bool got = false;
+        t->waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        t->cond.wait_until(lock, deadline, [&] { return (got = take(*t)) || t->unlinked; });
+        t->waiters.fetch_sub(1, std::memory_order_relaxed);
+        if (got) return true;
+        if (t->unlinked) {
+            if (std::chrono::steady_clock::now() < deadline) continue;
+            return false;
+        }
+        const bool idle = !t->pushed.load(std::memory_order_relaxed) &&
+                          t->waiters.load(std::memory_order_relaxed) == 0;
+        lock.unlock();
+        if (idle) forgetIfIdle(topic, t);
+        return false;
+    }
+}
+
 bool TopicQueues::pop(const std::string& topic, int64_t timeoutMs, std::string& out) {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    auto ready = [&] {
-        auto it = m_topics.find(topic);
-        return it != m_topics.end() && !it->second.messages.empty();
+    return waitToTake(topic, timeoutMs, [&](Topic& t) { return t.take(out); });
+}
+
+size_t TopicQueues::popMany(const std::string& topic, int64_t timeoutMs, size_t maxCount,
+                            size_t maxBytes, std::vector<std::string>& out) {
+    if (maxCount == 0) return 0;
+    const size_t before = out.size();
+    waitToTake(topic, timeoutMs, [&](Topic& t) {
+        std::string msg;
+        if (!t.take(msg)) return false;
+        size_t taken = msg.size();
+        out.push_back(std::move(msg));
+        // The rest only while they fit, in one pass under the lock the first
+        // took; the first is returned whatever its size.
+        while (out.size() - before < maxCount) {
+            const size_t room = maxBytes == 0 ? SIZE_MAX : maxBytes - std::min(taken, maxBytes);
+            if (!t.take(msg, room)) break;
+            taken += msg.size();
+            out.push_back(std::move(msg));
+        }
+        return true;
+    });
+    return out.size() - before;
+}
+
+bool TopicQueues::popAny(const std::vector<std::string>& topics, int64_t timeoutMs,
+                         std::string& topicOut, std::string& out) {
+    const size_t n = topics.size();
+    if (n == 0) return false;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    // Each call starts its scan one topic further on, so a topic that always
+    // has a message cannot starve the ones after it.
+    const size_t first = m_rotation.fetch_add(1, std::memory_order_relaxed) % n;
+
+    std::vector<TopicPtr> watched(n);
+    auto scan = [&] {
+        for (size_t k = 0; k < n; ++k) {
+            const size_t i = (first + k) % n;
+            Topic* t = watched[i].get();
+            if (!t) continue;
+            bool got;
+            if (t->ring) {
+                got = t->take(out);
+            } else {
+                std::lock_guard<std::mutex> lock(t->mutex);
+                got = t->take(out);
+            }
+            if (got) {
+                topicOut = topics[i];
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (timeoutMs <= 0) {
+        // A poll never waits, so it needs no entries of its own.
+        {
+            std::shared_lock<std::shared_mutex> map(m_mapMutex);
+            for (size_t i = 0; i < n; ++i) {
+                auto it = m_topics.find(topics[i]);
+                if (it != m_topics.end()) watched[i] = it->second;
+            }
+        }
+        return scan();
+    }
+
+    Selector sel;
+    auto detach = [&](Topic& t) {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.selectors.erase(std::find(t.selectors.begin(), t.selectors.end(), &sel));
+        t.waiters.fetch_sub(1, std::memory_order_relaxed);
     };
-    if (!m_cond.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+    bool got = false;
+    for (;;) {
+        // Watch each topic's current entry; release() may have replaced one.
+        for (size_t i = 0; i < n; ++i) {
+            if (watched[i]) {
+                std::lock_guard<std::mutex> lock(watched[i]->mutex);
+                if (!watched[i]->unlinked) continue;
+            }
+            if (watched[i]) detach(*watched[i]);
+            watched[i] = findOrAdd(topics[i]);
+            std::lock_guard<std::mutex> lock(watched[i]->mutex);
+            watched[i]->selectors.push_back(&sel);
+            watched[i]->waiters.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sel.mutex);
+            sel.signalled = false;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((got = scan())) break;
+
+        std::unique_lock<std::mutex> lock(sel.mutex);
+        if (!sel.cond.wait_until(lock, deadline, [&] { return sel.signalled; })) break;
+    }
+
+    for (size_t i = 0; i < n; ++i) detach(*watched[i]);
+    if (!got) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!watched[i]->pushed.load(std::memory_order_relaxed)) {
+                forgetIfIdle(topics[i], watched[i]);
+            }
+        }
+    }
+    return got;
+}
+
+bool TopicQueues::admit(Topic& t, size_t size) {
+    const size_t budget = m_totalMaxBytes.load(std::memory_order_relaxed);
+    if (budget == 0) {
+        m_totalBytes.fetch_add(size, std::memory_order_relaxed);
+        return true;
+    }
+    for (;;) {
+        size_t total = m_totalBytes.load(std::memory_order_relaxed);
+        while (total <= budget && size <= budget - total) {
+            if (m_totalBytes.compare_exchange_weak(total, total + size,
+                                                   std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        if (!evictForBudget(t, size, budget)) return false;
+    }
+}
+
+bool TopicQueues::offerOrSpill(Topic& t, Payload&& payload, bool& admitted,
+                               size_t maxMessages, size_t maxBytes) {
+    const size_t size = payload->size();
+    // Like the deque, the log never holds what the byte bound could not.
+    if (size > maxBytes) {
+        t.countDrop(kFull);
         return false;
     }
-    auto& t = m_topics.find(topic)->second;
-    out = std::move(t.messages.front());
-    t.messages.pop();
-    t.bytes -= out.size();
+    // Anything already on disk is older, so the deque has to wait for it.
+    if (admitted && t.spill->empty() && t.reserve(size, maxMessages, maxBytes)) {
+        t.messages.push_back(Entry{std::move(payload), Clock::now(), t.nextSeq++});
+        return true;
+    }
+    const DropReason reason = admitted ? kFull : kBudget;
+    if (admitted) {
+        m_totalBytes.fetch_sub(size, std::memory_order_relaxed);
+        admitted = false;
+    }
+    if (!t.spill->append(*payload, Clock::now(), m_spillMaxBytes.load(std::memory_order_relaxed))) {
+        t.countDrop(reason);
+        return false;
+    }
+    t.spilled.fetch_add(1, std::memory_order_relaxed);
     return true;
 }
 
+// Only runs with the node at its budget, so a scan over the topics is fine.
+bool TopicQueues::evictForBudget(Topic& t, size_t size, size_t budget) {
+    size_t holding = 0;
+    Topic* victim = nullptr;
+    size_t victimBytes = 0;
+    for (const auto& [name, other] : m_topics) {
+        const size_t b = other->bytes.load(std::memory_order_relaxed);
+        if (b == 0 && other.get() != &t) continue;
+        ++holding;
+        if (other.get() != &t && b > victimBytes) {
+            victim = other.get();
+            victimBytes = b;
+        }
+    }
+    const size_t share = budget / std::max<size_t>(holding, 1);
+    if (t.bytes.load(std::memory_order_relaxed) + size > share) {
+        // Over its own share: only a topic that gives up old messages anyway
+        // makes room from itself.
+        return t.policy.overflow != Overflow::DropNewest && t.evictOldest(kBudget);
+    }
+    return victim && victimBytes > share && victim->evictOldest(kBudget);
+}
+
 void TopicQueues::release(const std::string& topic) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
     auto it = m_topics.find(topic);
-    if (it != m_topics.end() && !it->second.retire()) {
-        m_topics.erase(it);
+    if (it == m_topics.end()) return;
+    std::unique_lock<std::mutex> lock(it->second->mutex);
+    if (!it->second->retire()) {
+        lock.unlock();
+        unlink(it);
     }
 }
 
 void TopicQueues::releaseAll() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
     for (auto it = m_topics.begin(); it != m_topics.end();) {
-        it = it->second.retire() ? std::next(it) : m_topics.erase(it);
+        std::unique_lock<std::mutex> lock(it->second->mutex);
+        if (it->second->retire()) {
+            ++it;
+            continue;
+        }
+        lock.unlock();
+        auto next = std::next(it);
+        unlink(it);
+        it = next;
     }
 }
 
 // A scrape must not hold the enqueue path while it builds its series, so it
-// takes one cheap sample per topic under the lock and formats outside it.
+// reads each topic's counters under the shared map lock and formats outside.
 std::vector<Metric> TopicQueues::metrics() const {
     struct Sample {
         std::string topic;
         size_t depth;
-        uint64_t dropped;
+        bool spills;
+        size_t spilled;
+        std::array<uint64_t, kDropReasons> dropped;
+        TopicPtr entry;
     };
     std::vector<Sample> samples;
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::shared_lock<std::shared_mutex> map(m_mapMutex);
         samples.reserve(m_topics.size());
         for (const auto& [topic, t] : m_topics) {
-            samples.push_back(Sample{topic, t.messages.size(), t.dropped});
+            if (!t->pushed.load(std::memory_order_relaxed)) continue;
+            Sample sample{topic, t->depth.load(std::memory_order_relaxed), t->spill != nullptr,
+                          t->spilled.load(std::memory_order_relaxed), {}, t};
+            for (size_t r = 0; r < kDropReasons; ++r) {
+                sample.dropped[r] = t->dropped[r].load(std::memory_order_relaxed);
+            }
+            samples.push_back(std::move(sample));
         }
     }
 
     std::vector<Metric> series;
-    series.reserve(samples.size() * 2);
+    series.reserve(samples.size() * 5 + 3);
+    const auto now = Clock::now();
+    static const char* const kReasons[kDropReasons] = {"full", "evicted", "expired",
+                                                       "superseded", "budget"};
+    series.push_back(m_messageBytes.snapshot("libp2p_module_gossipsub_message_bytes",
+                                             "size of gossipsub messages offered to the poll queues"));
+    series.push_back(Metric{"libp2p_module_gossipsub_queued_bytes", "gauge",
+                            "bytes waiting in all per-topic poll queues together",
+                            {}, static_cast<double>(m_totalBytes.load(std::memory_order_relaxed))});
+    if (m_spillMaxBytes.load(std::memory_order_relaxed) > 0) {
+        series.push_back(Metric{"libp2p_module_gossipsub_spilled_bytes", "gauge",
+                                "bytes of spill segments the per-topic poll queues hold on disk",
+                                {}, static_cast<double>(m_spillBytes.load(std::memory_order_relaxed))});
+    }
     for (auto& s : samples) {
         series.push_back(Metric{"libp2p_module_gossipsub_queue_depth", "gauge",
                                 "messages waiting in the per-topic poll queue",
                                 {{"topic", s.topic}}, static_cast<double>(s.depth)});
-        series.push_back(Metric{"libp2p_module_gossipsub_queue_dropped_total", "counter",
-                                "messages dropped because the per-topic poll queue was full",
-                                {{"topic", std::move(s.topic)}},
-                                static_cast<double>(s.dropped)});
+        if (s.spills) {
+            series.push_back(Metric{"libp2p_module_gossipsub_queue_spilled", "gauge",
+                                    "messages the per-topic poll queue holds on disk",
+                                    {{"topic", s.topic}}, static_cast<double>(s.spilled)});
+        }
+        Clock::time_point queuedAt;
+        const double age = s.entry->oldest(queuedAt)
+                               ? std::max(0.0, std::chrono::duration<double>(now - queuedAt).count())
+                               : 0.0;
+        series.push_back(Metric{"libp2p_module_gossipsub_queue_oldest_age_seconds", "gauge",
+                                "how long the oldest message in the per-topic poll queue has waited",
+                                {{"topic", s.topic}}, age});
+        series.push_back(s.entry->residency.snapshot(
+            "libp2p_module_gossipsub_queue_residency_seconds",
+            "time messages spent in the per-topic poll queue before being taken",
+            {{"topic", s.topic}}));
+        // "full" always, as before there were reasons; the others once they
+        // happen, since most policies never produce them.
+        for (size_t r = 0; r < kDropReasons; ++r) {
+            if (r != kFull && s.dropped[r] == 0) continue;
+            series.push_back(Metric{"libp2p_module_gossipsub_queue_dropped_total", "counter",
+                                    "messages dropped from the per-topic poll queue, by reason",
+                                    {{"topic", s.topic}, {"reason", kReasons[r]}},
+                                    static_cast<double>(s.dropped[r])});
+        }
     }
     return series;
 }
 
 size_t TopicQueues::topicCount() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_lock<std::shared_mutex> map(m_mapMutex);
     return m_topics.size();
 }
 
+TopicQueues::TopicPtr TopicQueues::findOrAdd(const std::string& topic) {
+    {
+        std::shared_lock<std::shared_mutex> map(m_mapMutex);
+        auto it = m_topics.find(topic);
+        if (it != m_topics.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    auto& slot = m_topics[topic];
+    if (!slot) {
+        auto p = m_topicPolicies.find(topic);
+        const Policy& policy = p != m_topicPolicies.end() ? p->second : m_policy;
+        // Expiry and keyed compaction work on the deque's entries.
+        const bool spills = m_spillMaxBytes.load(std::memory_order_relaxed) > 0 &&
+                            policy.overflow == Overflow::DropNewest && policy.ttlMs == 0;
+        const bool ring = m_backend.load(std::memory_order_relaxed) == Backend::Ring &&
+                          policy.ttlMs == 0 && policy.overflow != Overflow::KeepLatest && !spills;
+        const Bounds bounds = boundsFor(topic);
+        slot = std::make_shared<Topic>(ring ? bounds.maxMessages : 0, policy, m_totalBytes);
+        slot->maxMessages.store(bounds.maxMessages, std::memory_order_relaxed);
+        slot->maxBytes.store(bounds.maxBytes, std::memory_order_relaxed);
+        if (spills) {
+            // Topic names can hold any byte, so the files are numbered instead.
+            slot->spill = std::make_unique<SpillLog>(
+                m_spillDir + "/gossipsub-spill-" + std::to_string(getpid()) + "-" +
+                    std::to_string(m_spillLogs++),
+                m_spillBytes);
+        }
+    }
+    return slot;
+}
+
+TopicQueues::Bounds TopicQueues::boundsFor(const std::string& topic) const {
+    if (m_topicBounds.empty()) return m_bounds;
+    if (auto it = m_topicBounds.find(topic); it != m_topicBounds.end()) return it->second;
+    const Bounds* best = &m_bounds;
+    size_t bestLen = 0;
+    for (const auto& [pattern, bounds] : m_topicBounds) {
+        if (pattern.empty() || pattern.back() != '*') continue;
+        const size_t len = pattern.size() - 1;
+        if (len < bestLen) continue;
+        if (topic.compare(0, len, pattern, 0, len) == 0) {
+            best = &bounds;
+            bestLen = len;
+        }
+    }
+    return *best;
+}
+
+void TopicQueues::rebound() {
+    for (auto& [topic, t] : m_topics) {
+        const Bounds b = boundsFor(topic);
+        t->maxMessages.store(b.maxMessages, std::memory_order_relaxed);
+        t->maxBytes.store(b.maxBytes, std::memory_order_relaxed);
+    }
+}
+
+void TopicQueues::unlink(std::unordered_map<std::string, TopicPtr>::iterator it) {
+    TopicPtr t = std::move(it->second);
+    m_topics.erase(it);
+    {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        t->unlinked = true;
+        for (Selector* s : t->selectors) s->signal();
+    }
+    t->cond.notify_all();
+}
+
+void TopicQueues::forgetIfIdle(const std::string& topic, const TopicPtr& t) {
+    std::unique_lock<std::shared_mutex> map(m_mapMutex);
+    auto it = m_topics.find(topic);
+    if (it == m_topics.end() || it->second != t) return;
+    {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        if (t->pushed.load(std::memory_order_relaxed) ||
+            t->waiters.load(std::memory_order_relaxed) != 0) {
+            return;
+        }
+    }
+    unlink(it);
+}
+
+void TopicQueues::Selector::signal() {
+    std::lock_guard<std::mutex> lock(mutex);
+    signalled = true;
+    cond.notify_one();
+}
+
+TopicQueues::Topic::Topic(size_t ringCapacity, Policy policy, std::atomic<size_t>& nodeBytes)
+    : policy(std::move(policy)),
+      nodeBytes(nodeBytes),
+      ring(ringCapacity > 0 ? std::make_unique<MessageRing>(ringCapacity) : nullptr) {}
+
+bool TopicQueues::Topic::reserve(size_t size, size_t maxMessages, size_t maxBytes) {
+    // Acquire pairs with the release in take(): a slot counted free here has
+    // also been handed back to the ring.
+    size_t d = depth.load(std::memory_order_acquire);
+    do {
+        if (d >= maxMessages) return false;
+    } while (!depth.compare_exchange_weak(d, d + 1, std::memory_order_acquire));
+    // Subtract instead of adding, so a huge payload cannot wrap the sum.
+    size_t b = bytes.load(std::memory_order_relaxed);
+    do {
+        if (size > maxBytes || b > maxBytes - size) {
+            depth.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!bytes.compare_exchange_weak(b, b + size, std::memory_order_relaxed));
+    return true;
+}
+
+bool TopicQueues::Topic::offer(Payload&& payload, size_t maxMessages, size_t maxBytes) {
+    const auto now = Clock::now();
+    // Expired messages would never be taken, so they make room first.
+    for (skipDead(); !messages.empty() && expired(messages.front(), now); skipDead()) {
+        dropFront(kExpired);
+    }
+    if (payload->size() > maxBytes) {
+        countDrop(kFull);
+        return false;
+    }
+
+    std::string key;
+    const bool keyed = policy.overflow == Overflow::KeepLatest && keyOf(*payload, key);
+    if (keyed) {
+        auto k = latestByKey.find(key);
+        if (k != latestByKey.end()) {
+            // Entries stay in seq order, dead ones included.
+            auto e = std::lower_bound(messages.begin(), messages.end(), k->second,
+                                      [](const Entry& x, uint64_t seq) { return x.seq < seq; });
+            unaccount(e->payload->size());
+            depth.fetch_sub(1, std::memory_order_relaxed);
+            e->payload.reset();
+            e->dead = true;
+            ++deadEntries;
+            countDrop(kSuperseded);
+        }
+    }
+    while (!reserve(payload->size(), maxMessages, maxBytes)) {
+        skipDead();
+        if (policy.overflow == Overflow::DropNewest || messages.empty()) {
+            countDrop(kFull);
+            return false;
+        }
+        dropFront(kEvicted);
+    }
+
+    const uint64_t seq = nextSeq++;
+    if (keyed) latestByKey[std::move(key)] = seq;
+    messages.push_back(Entry{std::move(payload), now, seq});
+    // Sweep once tombstones outnumber live messages, so one hot key cannot
+    // grow the deque past the message bound.
+    if (deadEntries > 16 && deadEntries > depth.load(std::memory_order_relaxed)) {
+        messages.erase(std::remove_if(messages.begin(), messages.end(),
+                                      [](const Entry& e) { return e.dead; }),
+                       messages.end());
+        deadEntries = 0;
+    }
+    return true;
+}
+
+bool TopicQueues::Topic::take(std::string& out, size_t maxSize) {
+    Clock::time_point queuedAt;
+    if (!dequeue(out, queuedAt, maxSize)) return false;
+    residency.observe(std::chrono::duration<double>(Clock::now() - queuedAt).count());
+    return true;
+}
+
+bool TopicQueues::Topic::oldest(Clock::time_point& queuedAt) {
+    if (ring) return ring->oldest(queuedAt);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Entry& e : messages) {
+        if (e.dead) continue;
+        queuedAt = e.queuedAt;
+        return true;
+    }
+    return spill && spill->oldest(queuedAt);
+}
+
+bool TopicQueues::Topic::dequeue(std::string& out, Clock::time_point& queuedAt, size_t maxSize) {
+    if (ring) {
+        Payload p;
+        if (!ring->tryPop(p, queuedAt, maxSize)) return false;
+        out = takePayload(std::move(p));
+    } else {
+        const auto now = policy.ttlMs > 0 ? Clock::now() : Clock::time_point();
+        for (;;) {
+            skipDead();
+            if (messages.empty()) {
+                // Spilled messages are all newer than the queued ones, and
+                // were never charged to the bounds or the budget.
+                if (!spill || !spill->pop(out, queuedAt, maxSize)) return false;
+                spilled.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            Entry& e = messages.front();
+            if (expired(e, now)) {
+                dropFront(kExpired);
+                continue;
+            }
+            if (e.payload->size() > maxSize) return false;
+            forgetKey(e);
+            queuedAt = e.queuedAt;
+            out = takePayload(std::move(e.payload));
+            messages.pop_front();
+            break;
+        }
+    }
+    unaccount(out.size());
+    depth.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+bool TopicQueues::Topic::evictOldest(DropReason reason) {
+    if (ring) {
+        std::string discard;
+        Clock::time_point queuedAt;
+        if (!dequeue(discard, queuedAt)) return false;
+        countDrop(reason);
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    skipDead();
+    if (messages.empty()) return false;
+    dropFront(reason);
+    return true;
+}
+
+uint64_t TopicQueues::Topic::droppedTotal() const {
+    uint64_t total = 0;
+    for (const auto& d : dropped) total += d.load(std::memory_order_relaxed);
+    return total;
+}
+
 bool TopicQueues::Topic::retire() {
-    messages = {};
-    bytes = 0;
-    return dropped != 0;
+    if (ring) {
+        std::string discard;
+        Clock::time_point queuedAt;
+        while (dequeue(discard, queuedAt)) {
+        }
+    } else {
+        messages.clear();
+        latestByKey.clear();
+        deadEntries = 0;
+        if (spill) {
+            spill->clear();
+            spilled.store(0, std::memory_order_relaxed);
+        }
+        unaccount(bytes.load(std::memory_order_relaxed));
+        depth.store(0, std::memory_order_relaxed);
+    }
+    return droppedTotal() != 0;
+}
+
+bool TopicQueues::Topic::expired(const Entry& e, Clock::time_point now) const {
+    return policy.ttlMs > 0 && now - e.queuedAt > std::chrono::milliseconds(policy.ttlMs);
+}
+
+void TopicQueues::Topic::skipDead() {
+    while (!messages.empty() && messages.front().dead) {
+        messages.pop_front();
+        --deadEntries;
+    }
+}
+
+void TopicQueues::Topic::dropFront(DropReason reason) {
+    Entry& e = messages.front();
+    forgetKey(e);
+    unaccount(e.payload->size());
+    depth.fetch_sub(1, std::memory_order_relaxed);
+    countDrop(reason);
+    messages.pop_front();
+}
+
+void TopicQueues::Topic::forgetKey(const Entry& e) {
+    if (policy.overflow != Overflow::KeepLatest) return;
+    std::string key;
+    if (!keyOf(*e.payload, key)) return;
+    auto k = latestByKey.find(key);
+    if (k != latestByKey.end() && k->second == e.seq) latestByKey.erase(k);
+}
+
+bool TopicQueues::Topic::keyOf(const std::string& payload, std::string& key) const {
+    const size_t end = payload.find(policy.keyDelimiter);
+    if (end == std::string::npos) return false;
+    key.assign(payload, 0, end);
+    return true;
 }
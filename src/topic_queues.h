@@ -1,30 +1,142 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "histogram.h"
+#include "message_ring.h"
 #include "metric.h"
+#include "payload.h"
+#include "spill_log.h"
 
 // Per-topic backlog that gossipsubNextMessage() drains. Both bounds are needed:
 // 1024 messages at the 1 MiB gossipsub message limit is still 1 GiB per topic.
-// Overflow drops the newest, leaving a coherent prefix of the stream.
+// Overflow drops the newest by default, leaving a coherent prefix of the
+// stream; a topic whose consumers want the freshest data instead can evict the
+// oldest, expire messages by age, or keep only the latest message per key.
+//
+// A node-wide byte budget caps all topics together. While the node is within
+// it, each topic has only its own bounds; at the budget, a topic holding more
+// than its fair share (the budget over the topics holding messages) loses its
+// oldest messages to make room for one below its share.
+//
+// Each topic has its own lock and condvar, so a message wakes one waiter on its
+// own topic only. The map itself sits behind a read-mostly lock that only
+// adding or dropping a topic takes exclusively. Lock order: the map, then a
+// topic.
+//
+// With a spill directory set, a topic that would drop its newest message as
+// full or over budget appends it to a SpillLog instead, up to a disk budget
+// shared by all topics. Once a topic has spilled, later messages queue behind
+// on disk too, and take() reads the log once the in-memory messages are gone,
+// so the topic stays in order through a consumer stall.
+//
+// Every message is stamped when it is queued. take() records how long it
+// waited in a per-topic histogram, and a scrape reports the age of the oldest
+// message still waiting, which keeps growing while a consumer is stuck.
+// Messages dropped without being taken are left out of both.
+//
+// The Ring backend swaps the topic's deque for a MessageRing sized from the
+// message bound: push() then enqueues without the topic lock, and pop() takes a
+// queued message without it too, locking only to sleep on an empty ring.
 class TopicQueues {
 public:
+    enum class Backend { Deque, Ring };
+
+    enum class Overflow { DropNewest, DropOldest, KeepLatest };
+
+    // How a topic makes room. KeepLatest holds one message per key, the key
+    // being the payload up to its first `keyDelimiter` (a payload without one
+    // has no key), and evicts the oldest when that is not enough.
+    struct Policy {
+        Overflow overflow = Overflow::DropNewest;
+        // A message queued longer than this is dropped instead of taken; 0
+        // keeps it until taken.
+        int64_t ttlMs = 0;
+        std::string keyDelimiter = ":";
+    };
+
+    struct Bounds {
+        size_t maxMessages = 1024;
+        size_t maxBytes = 4 * 1024 * 1024;
+    };
+
+    /// The bounds of every topic without bounds of its own.
     void setBounds(size_t maxMessages, size_t maxBytes);
 
+    /// Overrides the bounds of `pattern`: a topic name, or a prefix ending in
+    /// `*` that covers every topic starting with it. A topic's own name wins
+    /// over a prefix, and the longest prefix over a shorter one.
+    ///
+    /// Bounds apply to existing topics at once, so a node can retune them
+    /// without a restart. Shrinking never drops what is already queued; the
+    /// topic only refuses or evicts on its next push. A ring keeps the capacity
+    /// it was created with, so raising the message bound past it takes effect
+    /// when release() drops the topic.
+    void setTopicBounds(const std::string& pattern, Bounds bounds);
+    /// Drops the override; returns false when there was none.
+    bool clearTopicBounds(const std::string& pattern);
+    /// Replaces every override with `all` at once, as reapplying a config does.
+    void setTopicBounds(std::map<std::string, Bounds> all);
+
+    /// Bytes queued across all topics; 0 lifts the budget.
+    void setTotalMaxBytes(size_t maxBytes);
+
+    /// Applies to topics created from now on; an existing topic keeps its
+    /// backend until release() drops it.
+    void setBackend(Backend backend);
+
+    /// Spills overflow into segment files under `dir`, up to `maxBytes` across
+    /// all topics; an empty `dir` or 0 turns spilling off. Only DropNewest
+    /// topics without a TTL spill, since the others mean to discard, and they
+    /// get the deque whatever the backend. Applies to topics created from now on.
+    void setSpill(std::string dir, size_t maxBytes);
+
+    /// The policy of every topic without one of its own. Like the backend, a
+    /// policy applies to topics created from now on. TTL and KeepLatest need
+    /// the deque, so such a topic gets one whatever the backend.
+    void setPolicy(Policy policy);
+    void setTopicPolicy(const std::string& topic, Policy policy);
+    /// Replaces every topic's own policy with `all` at once, as reapplying a
+    /// config does.
+    void setTopicPolicies(std::map<std::string, Policy> all);
+
     /// Either bound at 0 disables the backlog. A payload larger than the byte
     /// bound never fits, so keep the bound above `gossipsubMaxMessageSize`.
-    bool push(const std::string& topic, std::string payload);
+    bool push(const std::string& topic, Payload payload);
+    bool push(const std::string& topic, std::string payload) {
+        return push(topic, makePayload(std::move(payload)));
+    }
 
     bool pop(const std::string& topic, int64_t timeoutMs, std::string& out);
 
-    /// Frees payloads. The drop counter survives, since resetting a Prometheus
+    /// Waits like pop() for the first message, then appends it and whatever
+    /// else is queued, oldest first, up to `maxCount` messages and `maxBytes`
+    /// bytes (0 for no byte limit) without waiting again. The first message
+    /// counts against both limits but is taken whatever its size. Returns the
+    /// number appended; 0 on timeout.
+    size_t popMany(const std::string& topic, int64_t timeoutMs, size_t maxCount, size_t maxBytes,
+                   std::vector<std::string>& out);
+
+    /// Waits up to timeoutMs until any of `topics` has a message, and takes it.
+    /// Successive calls start looking one topic further down the list, so each
+    /// topic gets its turn however busy the others are.
+    bool popAny(const std::vector<std::string>& topics, int64_t timeoutMs, std::string& topicOut,
+                std::string& out);
+
+    /// Frees payloads. The drop counters survive, since resetting a Prometheus
     /// counter reads as a target restart.
     void release(const std::string& topic);
 
@@ -37,21 +149,173 @@ public:
     size_t topicCount() const;
 
 private:
+    // What a popAny() caller sleeps on while it watches several topics. A push
+    // signals every selector on its topic, under the topic lock, so a selector
+    // outlives its signals as long as it detaches under that lock too.
+    struct Selector {
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool signalled = false;
+
+        void signal();
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Why a message left the queue without being taken; one counter each.
+    enum DropReason { kFull, kEvicted, kExpired, kSuperseded, kBudget, kDropReasons };
+
+    // A message on a deque.
+    struct Entry {
+        Payload payload;
+        Clock::time_point queuedAt;
+        uint64_t seq;
+        // Superseded by a later message with its key; skipped by take().
+        bool dead = false;
+    };
+
     struct Topic {
-        std::queue<std::string> messages;
-        size_t bytes = 0;
-        uint64_t dropped = 0;
+        /// A ring of `ringCapacity` cells, or the deque when that is 0.
+        /// `nodeBytes` is the node-wide total this topic's bytes count toward.
+        Topic(size_t ringCapacity, Policy policy, std::atomic<size_t>& nodeBytes);
+
+        const Policy policy;
+        std::atomic<size_t>& nodeBytes;
+        // Resolved from the defaults and overrides; rewritten under the map's
+        // exclusive lock when either changes.
+        std::atomic<size_t> maxMessages{0};
+        std::atomic<size_t> maxBytes{0};
+        std::mutex mutex;
+        std::condition_variable cond;
+        // The messages live in exactly one of these: the deque, under `mutex`,
+        // or the ring, which needs no lock.
+        std::deque<Entry> messages;
+        std::unique_ptr<MessageRing> ring;
+        // Messages behind the deque's, under `mutex`; null unless the topic
+        // spills. `spilled` counts them for a scrape.
+        std::unique_ptr<SpillLog> spill;
+        std::atomic<size_t> spilled{0};
+        // KeepLatest: each key's queued message, by seq. Dead entries stay in
+        // the deque, payload freed, until they reach the front or a sweep.
+        std::unordered_map<std::string, uint64_t> latestByKey;
+        uint64_t nextSeq = 0;
+        size_t deadEntries = 0;
+        // Both bounds are checked against these before a message goes in, and
+        // they drop only once it is out, so the ring can never be full.
+        std::atomic<size_t> depth{0};
+        std::atomic<size_t> bytes{0};
+        std::array<std::atomic<uint64_t>, kDropReasons> dropped{};
+        // Seconds from push to take: 100 us to about 26 s.
+        Histogram residency{Histogram::exponentialBounds(0.0001, 4, 10)};
+        // False while only waiters know the topic; such an entry goes away
+        // with its last waiter instead of lingering until release().
+        std::atomic<bool> pushed{false};
+        // pop() waiters plus watching selectors.
+        std::atomic<int> waiters{0};
+        std::vector<Selector*> selectors;
+        // Set once the entry left the map, under `mutex`; its waiters look the
+        // topic up again.
+        bool unlinked = false;
+
+        /// Claims room for one payload of `size` under both bounds.
+        bool reserve(size_t size, size_t maxMessages, size_t maxBytes);
+
+        /// Queues `payload` on the deque, making room the policy's way, or
+        /// counts why it could not. Runs under `mutex`.
+        bool offer(Payload&& payload, size_t maxMessages, size_t maxBytes);
+
+        /// Takes the oldest message unless it is larger than `maxSize`, and
+        /// records how long it waited. Needs `mutex` for the deque only.
+        bool take(std::string& out, size_t maxSize = SIZE_MAX);
+
+        /// When the oldest message still waiting was queued; false when none
+        /// is. Takes `mutex` for the deque.
+        bool oldest(Clock::time_point& queuedAt);
+
+        /// Drops the oldest message for `reason`; takes `mutex` for the deque.
+        bool evictOldest(DropReason reason);
+
+        void countDrop(DropReason reason) {
+            dropped[reason].fetch_add(1, std::memory_order_relaxed);
+        }
+        uint64_t droppedTotal() const;
 
         /// Frees the payloads and reports whether the entry still carries a drop
-        /// count worth exporting.
+        /// count worth exporting. Runs under `mutex`.
         bool retire();
+
+    private:
+        /// take() without recording: the oldest message and when it was queued.
+        bool dequeue(std::string& out, Clock::time_point& queuedAt, size_t maxSize = SIZE_MAX);
+        bool expired(const Entry& e, Clock::time_point now) const;
+        /// A message of `size` left the queue; depth is the caller's.
+        void unaccount(size_t size) {
+            bytes.fetch_sub(size, std::memory_order_relaxed);
+            nodeBytes.fetch_sub(size, std::memory_order_relaxed);
+        }
+        /// Pops dead entries off the front. Runs under `mutex`.
+        void skipDead();
+        /// Drops the live front entry for `reason`. Runs under `mutex`.
+        void dropFront(DropReason reason);
+        void forgetKey(const Entry& e);
+        bool keyOf(const std::string& payload, std::string& key) const;
     };
+    using TopicPtr = std::shared_ptr<Topic>;
+
+    // Ahead of the topics, whose logs charge it until they are destroyed.
+    std::atomic<size_t> m_spillBytes{0};
+
+    mutable std::shared_mutex m_mapMutex;
+    // One entry per live topic, plus the ones release() kept for their counter
+    // and the ones a pop() is waiting on.
+    std::unordered_map<std::string, TopicPtr> m_topics;
+
+    std::atomic<size_t> m_totalMaxBytes{256 * 1024 * 1024};
+    // Every queued payload, reserved by push() before the topic takes it.
+    std::atomic<size_t> m_totalBytes{0};
+    std::atomic<size_t> m_spillMaxBytes{0};
+    std::atomic<Backend> m_backend{Backend::Deque};
+    std::atomic<size_t> m_rotation{0};
+    // Under m_mapMutex, read when a topic's entry is created.
+    Policy m_policy;
+    std::map<std::string, Policy> m_topicPolicies;
+    Bounds m_bounds;
+    std::string m_spillDir;
+    uint64_t m_spillLogs = 0;
+    // Keyed by topic name or by `prefix*`.
+    std::map<std::string, Bounds> m_topicBounds;
+
+    /// The wait loop behind pop() and popMany(): calls `take(topic)` on the
+    /// ring without the lock, then under the lock until it returns true or the
+    /// deadline passes.
+    template <class Take>
+    bool waitToTake(const std::string& topic, int64_t timeoutMs, Take&& take);
+
+    /// Reserves `size` bytes of the node budget for a push to `t`, evicting
+    /// for it when the node is full. Runs under the shared map lock.
+    bool admit(Topic& t, size_t size);
+    /// push() for a topic with a spill log, under its `mutex`: the deque while
+    /// nothing is spilled and the message fits, else the log. Returns what
+    /// `admitted` reserved of the node budget when the message went to disk.
+    bool offerOrSpill(Topic& t, Payload&& payload, bool& admitted, size_t maxMessages,
+                      size_t maxBytes);
+    /// One eviction toward fitting `size` more bytes for `t`, from `t` itself
+    /// when it is over its fair share, else from the topic furthest over its.
+    bool evictForBudget(Topic& t, size_t size, size_t budget);
+
+    /// The bounds `topic` gets from the overrides. Runs under the map lock.
+    Bounds boundsFor(const std::string& topic) const;
+    /// Re-resolves every entry's bounds. Runs under the map's exclusive lock.
+    void rebound();
 
-    mutable std::mutex m_mutex;
-    std::condition_variable m_cond;
-    // One entry per live topic, plus the ones release() kept for their counter.
-    std::unordered_map<std::string, Topic> m_topics;
+    TopicPtr findOrAdd(const std::string& topic);
+    /// Erases the entry and wakes its waiters to look the topic up again.
+    /// Runs under the map's exclusive lock.
+    void unlink(std::unordered_map<std::string, TopicPtr>::iterator it);
+    /// Drops a waiter-made entry nobody pushed to or waits on anymore.
+    void forgetIfIdle(const std::string& topic, const TopicPtr& t);
 
-    size_t m_maxMessages = 1024;
-    size_t m_maxBytes = 4 * 1024 * 1024;
+    // Every payload offered to push(), queued or dropped: 64 B to 1 MiB, the
+    // gossipsub message limit.
+    Histogram m_messageBytes{Histogram::exponentialBounds(64, 4, 8)};
 };
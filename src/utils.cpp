@@ -1,53 +1,62 @@
 #include "utils.h"
 
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <stdexcept>
 
-std::string base64Encode(const std::vector<uint8_t>& data) {
-    static constexpr char kAlphabet[] =
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::string out;
-    out.reserve((data.size() + 2) / 3 * 4);
-    size_t i = 0;
-    for (; i + 3 <= data.size(); i += 3) {
-        uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
-        out.push_back(kAlphabet[(n >> 18) & 0x3f]);
-        out.push_back(kAlphabet[(n >> 12) & 0x3f]);
-        out.push_back(kAlphabet[(n >> 6) & 0x3f]);
-        out.push_back(kAlphabet[n & 0x3f]);
-    }
-    if (i < data.size()) {
-        uint32_t n = data[i] << 16;
-        bool hasTwo = i + 1 < data.size();
-        if (hasTwo) n |= data[i + 1] << 8;
-        out.push_back(kAlphabet[(n >> 18) & 0x3f]);
-        out.push_back(kAlphabet[(n >> 12) & 0x3f]);
-        out.push_back(hasTwo ? kAlphabet[(n >> 6) & 0x3f] : '=');
-        out.push_back('=');
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
+// The vector kernels below follow Muła and Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions" (2018). Each handles whole blocks only and
+// leaves the ragged tail, the padding and every error to the scalar loops, so
+// the output and the error messages are the same at every level.
+
+namespace {
+
+constexpr char kBase64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBP2P_BASE64_X86 1
+#endif
+
+// Encodes whole 3-byte groups from in[i..n) into out[o..), then the padded tail.
+void encodeScalar(const uint8_t* in, size_t n, size_t i, char* out, size_t o) {
+    for (; i + 3 <= n; i += 3) {
+        uint32_t v = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+        out[o++] = kBase64Alphabet[(v >> 18) & 0x3f];
+        out[o++] = kBase64Alphabet[(v >> 12) & 0x3f];
+        out[o++] = kBase64Alphabet[(v >> 6) & 0x3f];
+        out[o++] = kBase64Alphabet[v & 0x3f];
+    }
+    if (i < n) {
+        uint32_t v = in[i] << 16;
+        bool hasTwo = i + 1 < n;
+        if (hasTwo) v |= in[i + 1] << 8;
+        out[o++] = kBase64Alphabet[(v >> 18) & 0x3f];
+        out[o++] = kBase64Alphabet[(v >> 12) & 0x3f];
+        out[o++] = hasTwo ? kBase64Alphabet[(v >> 6) & 0x3f] : '=';
+        out[o++] = '=';
     }
-    return out;
 }
 
-std::string base64Decode(const std::string& in) {
+// Decodes in[i..) into out[o..) and returns the output length. `i` must start a
+// 4-char group. Throws on the first malformed char, as documented in utils.h.
+size_t decodeScalar(const std::string& in, size_t i, char* out, size_t o) {
     static const auto lookup = [] {
-        static constexpr char kAlphabet[] =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
         std::array<int, 256> t;
         t.fill(-1);
-        for (int i = 0; i < 64; ++i) t[static_cast<unsigned char>(kAlphabet[i])] = i;
+        for (int k = 0; k < 64; ++k) t[static_cast<unsigned char>(kBase64Alphabet[k])] = k;
         return t;
     }();
 
-    if (in.size() % 4 != 0) {
-        throw std::invalid_argument("base64Decode: length is not a multiple of 4");
-    }
-
-    std::string out;
-    out.reserve(in.size() / 4 * 3);
     uint32_t buf = 0;
     int bits = 0;
     size_t pad = 0;
-    for (size_t i = 0; i < in.size(); ++i) {
+    for (; i < in.size(); ++i) {
         char c = in[i];
         if (c == '=') {
             if (i < in.size() - 2 || ++pad > 2) {
@@ -66,15 +75,400 @@ std::string base64Decode(const std::string& in) {
         bits += 6;
         if (bits >= 8) {
             bits -= 8;
-            out.push_back(static_cast<char>((buf >> bits) & 0xff));
+            out[o++] = static_cast<char>((buf >> bits) & 0xff);
         }
     }
     if ((buf & ((1u << bits) - 1)) != 0) {
         throw std::invalid_argument("base64Decode: non-canonical trailing bits");
     }
+    return o;
+}
+
+#ifdef LIBP2P_BASE64_X86
+
+// 12 bytes in the low lanes of `in` (16 loaded) to 16 chars.
+__attribute__((target("sse4.1"))) inline __m128i encodeBlock128(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i idx = _mm_or_si128(t1, t3);
+
+    // 6-bit index to ASCII: pick an offset per range with one shuffle.
+    const __m128i shiftLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i range = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(shiftLut, range), idx);
+}
+
+__attribute__((target("avx2"))) inline __m256i encodeBlock256(__m256i in) {
+    in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11,
+                                                  10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10,
+                                                  9, 11, 10));
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i idx = _mm256_or_si256(t1, t3);
+
+    const __m256i shiftLut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63,
+        'A', 0, 0);
+    __m256i range = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+    const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+    range = _mm256_or_si256(range, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    return _mm256_add_epi8(_mm256_shuffle_epi8(shiftLut, range), idx);
+}
+
+// Each loop reads a full vector past the 12 or 24 bytes it consumes, so it
+// stops while that much input is left; the narrower loops finish. `i` is where
+// to start and the return value where they take over.
+__attribute__((target("sse4.1"))) size_t encodeSse41(const uint8_t* in, size_t n, size_t i, char* out) {
+    for (; i + 16 <= n; i += 12) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 3 * 4), encodeBlock128(block));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) size_t encodeAvx2(const uint8_t* in, size_t n, size_t i, char* out) {
+    for (; i + 28 <= n; i += 24) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+        const __m256i block = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 3 * 4), encodeBlock256(block));
+    }
+    return i;
+}
+
+// 16 chars to 12 bytes in the low lanes, or false when any char is outside
+// the alphabet ('=' included).
+__attribute__((target("sse4.1"))) inline bool decodeBlock128(__m128i in, __m128i& out) {
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0,
+                                          0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2f);
+
+    const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+    const __m128i loNibbles = _mm_and_si128(in, mask2F);
+    const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+    const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+    if (!_mm_testz_si128(lo, hi)) return false;
+
+    const __m128i eq2F = _mm_cmpeq_epi8(in, mask2F);
+    const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+    const __m128i values = _mm_add_epi8(in, roll);
+
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    out = _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                                -1, -1));
+    return true;
+}
+
+__attribute__((target("avx2"))) inline bool decodeBlock256(__m256i in, __m256i& out) {
+    const __m256i lutLo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B,
+        0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B,
+        0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0,
+                                             0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0,
+                                             0, 0, 0, 0);
+    const __m256i mask2F = _mm256_set1_epi8(0x2f);
+
+    const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+    const __m256i loNibbles = _mm256_and_si256(in, mask2F);
+    const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+    const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+    if (!_mm256_testz_si256(lo, hi)) return false;
+
+    const __m256i eq2F = _mm256_cmpeq_epi8(in, mask2F);
+    const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+    const __m256i values = _mm256_add_epi8(in, roll);
+
+    const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    const __m256i packed = _mm256_shuffle_epi8(
+        words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0,
+                                6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    // Close the gap between the two lanes' 12 bytes.
+    out = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    return true;
+}
+
+// Each loop stores a full vector past the 12 or 24 bytes it produces, and
+// leaves the last quad, which may hold padding, to the scalar loop. Both hold
+// while at least 8 (SSE) or 16 (AVX2) chars follow the block. A block with a
+// char outside the alphabet stops the loop where the scalar one reports it.
+__attribute__((target("sse4.1"))) size_t decodeSse41(const std::string& in, size_t i, char* out) {
+    for (; i + 24 <= in.size(); i += 16) {
+        __m128i bytes;
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.data() + i));
+        if (!decodeBlock128(block, bytes)) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 4 * 3), bytes);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) size_t decodeAvx2(const std::string& in, size_t i, char* out) {
+    for (; i + 48 <= in.size(); i += 32) {
+        __m256i bytes;
+        const __m256i block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.data() + i));
+        if (!decodeBlock256(block, bytes)) break;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 4 * 3), bytes);
+    }
+    return i;
+}
+
+Base64Simd detectBase64Simd() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Base64Simd::Avx2;
+    if (__builtin_cpu_supports("sse4.1")) return Base64Simd::Sse41;
+    return Base64Simd::Scalar;
+}
+
+#else
+
+Base64Simd detectBase64Simd() {
+    return Base64Simd::Scalar;
+}
+
+#endif  // LIBP2P_BASE64_X86
+
+const Base64Simd g_base64Detected = detectBase64Simd();
+std::atomic<Base64Simd> g_base64Cap{Base64Simd::Avx2};
+
+Base64Simd activeBase64Simd() {
+    const Base64Simd cap = g_base64Cap.load(std::memory_order_relaxed);
+    return cap < g_base64Detected ? cap : g_base64Detected;
+}
+
+size_t base64Length(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+// Writes base64Length(len) characters at `out`.
+void base64EncodeInto(const uint8_t* data, size_t len, char* out) {
+    if (len == 0) return;
+    size_t i = 0;
+#ifdef LIBP2P_BASE64_X86
+    switch (activeBase64Simd()) {
+    case Base64Simd::Avx2: i = encodeAvx2(data, len, i, out); [[fallthrough]];
+    case Base64Simd::Sse41: i = encodeSse41(data, len, i, out); break;
+    case Base64Simd::Scalar: break;
+    }
+#endif
+    encodeScalar(data, len, i, out, i / 3 * 4);
+}
+
+}  // namespace
+
+Base64Simd base64Simd() {
+    return activeBase64Simd();
+}
+
+Base64Simd setBase64SimdCap(Base64Simd cap) {
+    return g_base64Cap.exchange(cap, std::memory_order_relaxed);
+}
+
+std::string base64Encode(const uint8_t* data, size_t len) {
+    std::string out(base64Length(len), '\0');
+    base64EncodeInto(data, len, out.data());
+    return out;
+}
+
+std::string base64Encode(const std::vector<uint8_t>& data) {
+    return base64Encode(data.data(), data.size());
+}
+
+std::string base64Decode(const std::string& in) {
+    if (in.size() % 4 != 0) {
+        throw std::invalid_argument("base64Decode: length is not a multiple of 4");
+    }
+
+    // Sized for no padding and trimmed once the padding is known.
+    std::string out(in.size() / 4 * 3, '\0');
+    if (in.empty()) return out;
+    size_t i = 0;
+#ifdef LIBP2P_BASE64_X86
+    switch (activeBase64Simd()) {
+    case Base64Simd::Avx2: i = decodeAvx2(in, i, &out[0]); [[fallthrough]];
+    case Base64Simd::Sse41: i = decodeSse41(in, i, &out[0]); break;
+    case Base64Simd::Scalar: break;
+    }
+#endif
+    out.resize(decodeScalar(in, i, &out[0], i / 4 * 3));
+    return out;
+}
+
+namespace {
+
+// RFC 8949 3.1: the head of an item of major type `major` and length or value
+// `n`. Values below 24 sit in the initial byte, larger ones follow it
+// big-endian in 1, 2, 4 or 8 bytes.
+template <class Out>
+void appendCborHead(Out& out, uint8_t major, uint64_t n) {
+    uint8_t info = static_cast<uint8_t>(n);
+    size_t lenBytes = 0;
+    if (n >= 24) {
+        if (n <= 0xff) { info = 24; lenBytes = 1; }
+        else if (n <= 0xffff) { info = 25; lenBytes = 2; }
+        else if (n <= 0xffffffffu) { info = 26; lenBytes = 4; }
+        else { info = 27; lenBytes = 8; }
+    }
+    out.push_back(static_cast<typename Out::value_type>((major << 5) | info));
+    for (size_t i = 0; i < lenBytes; ++i) {
+        out.push_back(static_cast<typename Out::value_type>(n >> (8 * (lenBytes - 1 - i))));
+    }
+}
+
+void appendCborText(std::string& out, const std::string& text) {
+    appendCborHead(out, 3, text.size());
+    out += text;
+}
+
+}  // namespace
+
+std::vector<uint8_t> cborByteString(const uint8_t* data, size_t len) {
+    std::vector<uint8_t> out;
+    out.reserve(9 + len);
+    appendCborHead(out, 2, len);
+    if (len) out.insert(out.end(), data, data + len);
+    return out;
+}
+
+std::string pubsubMessageCbor(const std::string& topic, const std::string& data) {
+    std::string out;
+    out.reserve(24 + topic.size() + data.size());
+    appendCborHead(out, 5, 2);
+    appendCborText(out, "data");
+    appendCborHead(out, 2, data.size());
+    out += data;
+    appendCborText(out, "topic");
+    appendCborText(out, topic);
     return out;
 }
 
+namespace {
+
+// Length of the UTF-8 sequence at `p`, or 0 when it is not one json::dump()
+// accepts: no overlong forms, surrogates, or code points past U+10FFFF.
+size_t utf8SequenceLength(const unsigned char* p, size_t avail) {
+    const unsigned char c = p[0];
+    size_t len;
+    unsigned char lo = 0x80, hi = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+        len = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        len = 3;
+        if (c == 0xe0) lo = 0xa0;
+        if (c == 0xed) hi = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        len = 4;
+        if (c == 0xf0) lo = 0x90;
+        if (c == 0xf4) hi = 0x8f;
+    } else {
+        return 0;
+    }
+    if (avail < len || p[1] < lo || p[1] > hi) return 0;
+    for (size_t i = 2; i < len; ++i) {
+        if ((p[i] & 0xc0) != 0x80) return 0;
+    }
+    return len;
+}
+
+// Appends `s` as the inside of a JSON string, escaped as json::dump() escapes
+// it, or returns false at the first byte that is not valid UTF-8. Runs that
+// need no escaping are appended whole.
+bool appendJsonEscaped(std::string& out, const std::string& s) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    const auto* p = reinterpret_cast<const unsigned char*>(s.data());
+    const size_t n = s.size();
+    size_t run = 0;
+    size_t i = 0;
+    while (i < n) {
+        const unsigned char c = p[i];
+        if (c >= 0x80) {
+            const size_t len = utf8SequenceLength(p + i, n - i);
+            if (len == 0) return false;
+            i += len;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            ++i;
+            continue;
+        }
+        out.append(s, run, i - run);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += kHex[c >> 4];
+                out += kHex[c & 0x0f];
+        }
+        run = ++i;
+    }
+    out.append(s, run, n - run);
+    return true;
+}
+
+}  // namespace
+
+std::string pubsubMessageJson(const std::string& topic, const std::string& data) {
+    std::string out;
+    // Exact unless something needs escaping.
+    out.reserve(data.size() + topic.size() + 22);
+    out += "{\"data\":\"";
+    bool ok = appendJsonEscaped(out, data);
+    out += "\",\"topic\":\"";
+    ok = ok && appendJsonEscaped(out, topic);
+    out += "\"}";
+    if (ok) return out;
+    // Let json::dump() raise its own error for the bad byte.
+    nlohmann::json j;
+    j["topic"] = topic;
+    j["data"] = data;
+    return j.dump();
+}
+
+std::string pubsubMessageBase64Json(const std::string& topic, const std::string& data) {
+    const size_t encoded = base64Length(data.size());
+    std::string out;
+    out.reserve(encoded + topic.size() + 22);
+    out += "{\"data\":\"";
+    const size_t at = out.size();
+    out.resize(at + encoded);
+    base64EncodeInto(reinterpret_cast<const uint8_t*>(data.data()), data.size(), out.data() + at);
+    out += "\",\"topic\":\"";
+    const bool ok = appendJsonEscaped(out, topic);
+    out += "\"}";
+    if (ok) return out;
+    nlohmann::json j;
+    j["topic"] = topic;
+    j["data"] = out.substr(at, encoded);
+    return j.dump();
+}
+
 std::string hexEncode(const uint8_t* data, size_t len) {
     static constexpr char kDigits[] = "0123456789abcdef";
     std::string out;
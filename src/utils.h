@@ -62,12 +62,41 @@ inline nlohmann::json peerInfoToJson(const PeerInfoResponse& info) {
 }
 
 // Encodes raw bytes as base64.
+std::string base64Encode(const uint8_t* data, size_t len);
 std::string base64Encode(const std::vector<uint8_t>& data);
 
 // Inverse of base64Encode. Throws std::invalid_argument on malformed input
 // (bad chars, misplaced/excess padding, wrong length, non-canonical tail bits).
 std::string base64Decode(const std::string& in);
 
+// Vector kernels the base64 codec runs on, picked once from the CPU at load.
+// Every level yields the same output and the same errors.
+enum class Base64Simd { Scalar, Sse41, Avx2 };
+
+/// The level base64Encode/base64Decode use now.
+Base64Simd base64Simd();
+
+/// Caps the level for tests and benchmarks; the CPU still bounds it. Returns
+/// the previous cap.
+Base64Simd setBase64SimdCap(Base64Simd cap);
+
+// One CBOR byte string (major type 2) holding `len` bytes of `data`: the
+// shortest head, then the bytes, copied once.
+std::vector<uint8_t> cborByteString(const uint8_t* data, size_t len);
+
+// The gossipsubMessage event, {"data": <data>, "topic": <topic>}, escaped the
+// way json::dump() would escape it but written straight from `data`, without
+// first copying it into a json value. Throws nlohmann type_error on invalid
+// UTF-8, as dump() does.
+std::string pubsubMessageJson(const std::string& topic, const std::string& data);
+
+// pubsubMessageJson with `data` base64-encoded, straight into the event.
+std::string pubsubMessageBase64Json(const std::string& topic, const std::string& data);
+
+// The gossipsubMessageCbor event: a CBOR map of the same keys, `data` a byte
+// string holding the payload as it came off the wire.
+std::string pubsubMessageCbor(const std::string& topic, const std::string& data);
+
 // Encodes raw bytes as lowercase hex.
 std::string hexEncode(const uint8_t* data, size_t len);
 
@@ -0,0 +1,65 @@
+// base64Encode/base64Decode throughput at each SIMD level this CPU runs, on
+// inputs from 64 B to 16 MiB (a stream frame is up to 1 MiB). Each size is
+// repeated until about 64 MiB went through, so small inputs measure the per-call
+// overhead too. Not part of ctest; run it by hand:
+//
+//   cmake -S tests -B build-tests -DLIBP2P_MODULE_BENCHMARKS=ON
+//   cmake --build build-tests --target base64_bench && build-tests/base64_bench
+
+#include <utils.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t kBytesPerRun = 64u << 20;
+
+// MiB/s of raw bytes, so encode and decode columns compare directly.
+template <class Fn>
+double mibPerSec(size_t inputBytes, Fn fn) {
+    const size_t reps = kBytesPerRun / inputBytes + 1;
+    const auto start = steady_clock::now();
+    for (size_t r = 0; r < reps; ++r) fn();
+    const double secs = duration<double>(steady_clock::now() - start).count();
+    return double(inputBytes) * reps / secs / (1 << 20);
+}
+
+}  // namespace
+
+int main() {
+    struct Level {
+        Base64Simd level;
+        const char* name;
+    };
+    const Level levels[] = {
+        {Base64Simd::Scalar, "scalar"}, {Base64Simd::Sse41, "sse4.1"}, {Base64Simd::Avx2, "avx2"}};
+    const size_t sizes[] = {64, 1 << 10, 16 << 10, 256 << 10, 1 << 20, 16 << 20};
+
+    std::mt19937 rng(1);
+    std::vector<uint8_t> data(sizes[5]);
+    for (auto& b : data) b = static_cast<uint8_t>(rng());
+
+    std::printf("%-8s %10s %14s %14s\n", "level", "size", "encode MiB/s", "decode MiB/s");
+    for (const auto& l : levels) {
+        setBase64SimdCap(l.level);
+        if (base64Simd() != l.level) {
+            std::printf("%-8s not supported on this CPU\n", l.name);
+            continue;
+        }
+        for (size_t n : sizes) {
+            const std::vector<uint8_t> in(data.begin(), data.begin() + n);
+            const std::string encoded = base64Encode(in);
+            volatile size_t sink = 0;
+            const double enc = mibPerSec(n, [&] { sink = sink + base64Encode(in).size(); });
+            const double dec = mibPerSec(n, [&] { sink = sink + base64Decode(encoded).size(); });
+            std::printf("%-8s %10zu %14.0f %14.0f\n", l.name, n, enc, dec);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Per-op overhead of the sync-over-async hand-off: a heap std::promise +
+// std::future per op (the bridge before Completion) against a pooled
+// Completion. Each op is one acquire, one resolve and one await, first with the
+// reply on the waiting thread and then on a second one, the way a libp2p reply
+// lands. Not part of ctest; run it by hand:
+//
+//   cmake -S tests -B build-tests -DLIBP2P_MODULE_BENCHMARKS=ON
+//   cmake --build build-tests --target completion_bench && build-tests/completion_bench
+
+#include <completion.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <thread>
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kOps = 200000;
+
+struct HeapPromise {
+    std::promise<SyncResult> promise;
+};
+
+double nsPerOp(steady_clock::time_point start) {
+    return double(duration_cast<nanoseconds>(steady_clock::now() - start).count()) / kOps;
+}
+
+double heapSameThread() {
+    const auto start = steady_clock::now();
+    for (int i = 0; i < kOps; ++i) {
+        auto* p = new HeapPromise();
+        auto f = p->promise.get_future();
+        p->promise.set_value({true, {}, {}, {}, nullptr});
+        delete p;
+        f.wait_for(milliseconds(1000));
+        (void)f.get();
+    }
+    return nsPerOp(start);
+}
+
+double pooledSameThread() {
+    const auto start = steady_clock::now();
+    for (int i = 0; i < kOps; ++i) {
+        auto* c = Completion::acquire();
+        c->resolve({true, {}, {}, {}, nullptr});
+        (void)c->await(1000);
+    }
+    return nsPerOp(start);
+}
+
+// One long-lived replier thread, handed each op through an atomic mailbox, so
+// the numbers measure the hand-off and not thread creation.
+template <class Op, class Submit, class Reply, class Wait>
+double crossThread(Submit submit, Reply reply, Wait wait) {
+    std::atomic<Op*> mailbox{nullptr};
+    std::atomic<bool> stop{false};
+    std::thread replier([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (Op* op = mailbox.exchange(nullptr, std::memory_order_acquire)) reply(op);
+        }
+    });
+    const auto start = steady_clock::now();
+    for (int i = 0; i < kOps; ++i) {
+        auto handle = submit();
+        mailbox.store(handle.first, std::memory_order_release);
+        wait(handle);
+    }
+    const double ns = nsPerOp(start);
+    stop = true;
+    replier.join();
+    return ns;
+}
+
+double heapCrossThread() {
+    using Handle = std::pair<HeapPromise*, std::future<SyncResult>>;
+    return crossThread<HeapPromise>(
+        [] {
+            auto* p = new HeapPromise();
+            return Handle{p, p->promise.get_future()};
+        },
+        [](HeapPromise* p) {
+            p->promise.set_value({true, {}, {}, {}, nullptr});
+            delete p;
+        },
+        [](Handle& h) {
+            h.second.wait_for(milliseconds(1000));
+            (void)h.second.get();
+        });
+}
+
+double pooledCrossThread() {
+    using Handle = std::pair<Completion*, int>;
+    return crossThread<Completion>(
+        [] { return Handle{Completion::acquire(), 0}; },
+        [](Completion* c) { c->resolve({true, {}, {}, {}, nullptr}); },
+        [](Handle& h) { (void)h.first->await(1000); });
+}
+
+}  // namespace
+
+int main() {
+    // Warm the pool and the allocator before timing anything.
+    pooledSameThread();
+    heapSameThread();
+
+    std::printf("%-28s %10s %10s\n", "ns/op", "promise", "pooled");
+    std::printf("%-28s %10.1f %10.1f\n", "reply on the waiting thread", heapSameThread(),
+                pooledSameThread());
+    std::printf("%-28s %10.1f %10.1f\n", "reply on another thread", heapCrossThread(),
+                pooledCrossThread());
+    return 0;
+}
@@ -0,0 +1,107 @@
+// TopicQueues push/pop throughput with one consumer blocked in pop() per topic
+// and a few producers spread over all topics, for both backends and against a
+// single-mutex, notify_all baseline shaped like the original implementation. Not part of
+// ctest; run it by hand:
+//
+//   cmake -S tests -B build-tests -DLIBP2P_MODULE_BENCHMARKS=ON
+//   cmake --build build-tests --target topic_queues_bench && build-tests/topic_queues_bench
+
+#include <topic_queues.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+constexpr int kMessagesPerTopic = 20000;
+
+// One lock and one condvar for every topic: each push wakes every waiter.
+class SingleLockQueues {
+public:
+    bool push(const std::string& topic, std::string data) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_topics[topic].push_back(std::move(data));
+        }
+        m_cond.notify_all();
+        return true;
+    }
+
+    bool pop(const std::string& topic, int64_t timeoutMs, std::string& out) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto& q = m_topics[topic];
+        if (!m_cond.wait_for(lock, milliseconds(timeoutMs), [&] { return !q.empty(); })) {
+            return false;
+        }
+        out = std::move(q.front());
+        q.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::unordered_map<std::string, std::deque<std::string>> m_topics;
+};
+
+// Messages per second through `queues`, from push to pop.
+template <class Queues>
+double run(Queues& queues, int topics, int producers) {
+    std::vector<std::string> names;
+    for (int t = 0; t < topics; ++t) names.push_back("topic-" + std::to_string(t));
+
+    std::atomic<int> received{0};
+    const auto start = steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < topics; ++t) {
+        threads.emplace_back([&, t] {
+            std::string out;
+            for (int i = 0; i < kMessagesPerTopic; ++i) {
+                if (!queues.pop(names[t], 5000, out)) return;
+                received.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            const std::string payload(256, 'x');
+            for (int i = 0; i < kMessagesPerTopic; ++i) {
+                for (int t = p; t < topics; t += producers) queues.push(names[t], payload);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    const double secs = duration<double>(steady_clock::now() - start).count();
+    return received.load() / secs;
+}
+
+}  // namespace
+
+int main() {
+    std::printf("%7s %10s %14s %14s %14s\n", "topics", "producers", "single msg/s",
+                "deque msg/s", "ring msg/s");
+    for (int topics : {1, 4, 40}) {
+        for (int producers : {1, 4}) {
+            SingleLockQueues single;
+            TopicQueues deque;
+            TopicQueues ring;
+            ring.setBackend(TopicQueues::Backend::Ring);
+            for (TopicQueues* q : {&deque, &ring}) q->setBounds(kMessagesPerTopic, size_t(1) << 30);
+            const double a = run(single, topics, producers);
+            const double b = run(deque, topics, producers);
+            const double c = run(ring, topics, producers);
+            std::printf("%7d %10d %14.0f %14.0f %14.0f\n", topics, producers, a, b, c);
+        }
+    }
+    return 0;
+}
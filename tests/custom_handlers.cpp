@@ -203,6 +203,84 @@ LOGOS_TEST(protocol_bridge_request_no_response) {
     LOGOS_ASSERT_TRUE(nodeB.stop().success);
 }
 
+// The request's timeoutMs bounds the whole exchange, not each step: a server
+// that never answers fails the request at about timeoutMs.
+LOGOS_TEST(protocol_bridge_request_shares_one_deadline) {
+    const std::string proto = "/test/bridge/silent/1.0.0";
+
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.mountProtocol(proto).success);
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    const std::string request = "anyone there?";
+    std::vector<uint8_t> reqBytes(request.begin(), request.end());
+    const auto start = std::chrono::steady_clock::now();
+    auto resp = nodeA.protocolRequest(json{
+        {"peerId", peerIdB},
+        {"multiaddrs", addrsB},
+        {"proto", proto},
+        {"requestB64", base64Encode(reqBytes)},
+        {"timeoutMs", 1500},
+    }.dump());
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    LOGOS_ASSERT_FALSE(resp.success);
+    LOGOS_ASSERT_TRUE(resp.error.rfind("protocolRequest: read failed", 0) == 0);
+    LOGOS_ASSERT_GE(elapsed, 1000);
+    LOGOS_ASSERT_LT(elapsed, 4000);
+
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
+// A timeoutMs past the default op timeout is honoured by every step: a server
+// that answers after 11 s still gets its response read.
+LOGOS_TEST(protocol_bridge_request_outlasts_the_default_op_timeout) {
+    const std::string proto = "/test/bridge/slow/1.0.0";
+
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.mountProtocol(proto).success);
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    bool serverOk = false;
+    std::thread server([&] {
+        auto acc = nodeB.protocolAcceptStream(json{{"proto", proto}, {"timeoutMs", 5000}}.dump());
+        if (!acc.success) return;
+        uint64_t sid = acc.value["streamId"].get<uint64_t>();
+        if (sid == 0) return;
+        auto rd = nodeB.streamReadLpJson(json{{"streamId", sid}, {"timeoutMs", 5000}}.dump());
+        if (!rd.success) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(kDefaultOpTimeoutMs + 1000));
+        auto w = nodeB.streamWriteLp(sid, "late");
+        serverOk = w.success && nodeB.streamReleaseJson(json{{"streamId", sid}}.dump()).success;
+    });
+
+    const std::string request = "take your time";
+    std::vector<uint8_t> reqBytes(request.begin(), request.end());
+    auto resp = nodeA.protocolRequest(json{
+        {"peerId", peerIdB},
+        {"multiaddrs", addrsB},
+        {"proto", proto},
+        {"requestB64", base64Encode(reqBytes)},
+        {"timeoutMs", kDefaultOpTimeoutMs + 10000},
+    }.dump());
+    server.join();
+
+    LOGOS_ASSERT_TRUE(serverOk);
+    LOGOS_ASSERT_TRUE(resp.success);
+    LOGOS_ASSERT_TRUE(base64Decode(resp.value["responseB64"].get<std::string>()) == "late");
+
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
 LOGOS_TEST(protocol_bridge_release_purges_inbound_queue) {
     const std::string proto = "/test/bridge/purge/1.0.0";
 
@@ -257,3 +335,67 @@ LOGOS_TEST(protocol_bridge_write_requires_dataB64) {
     LOGOS_ASSERT_FALSE(r.success);
     LOGOS_ASSERT_TRUE(node.stop().success);
 }
+
+LOGOS_TEST(protocol_bridge_cbor_request_carries_raw_bytes) {
+    const std::string proto = "/test/bridge/cbor/1.0.0";
+
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.mountProtocol(proto).success);
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+
+    // Every byte value, so nothing survives that a text encoding would mangle.
+    std::vector<uint8_t> request(256);
+    for (size_t i = 0; i < request.size(); ++i) request[i] = static_cast<uint8_t>(i);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    std::vector<uint8_t> serverSawRequest;
+    bool serverOk = false;
+    std::thread server([&] {
+        auto acc = nodeB.protocolAcceptStream(json{{"proto", proto}, {"timeoutMs", 5000}}.dump());
+        if (!acc.success) return;
+        uint64_t sid = acc.value["streamId"].get<uint64_t>();
+
+        auto rd = nodeB.streamReadLpCbor(sid, 4096);
+        if (!rd.success || !rd.value.is_binary()) return;
+        serverSawRequest = json::from_cbor(rd.value.get_binary()).get_binary();
+
+        std::vector<uint8_t> resp(serverSawRequest.rbegin(), serverSawRequest.rend());
+        auto w = nodeB.streamWriteLpCbor(sid, resp);
+        auto r = nodeB.streamRelease(sid);
+        serverOk = w.success && r.success;
+    });
+
+    const json args = {
+        {"peerId", peerIdB},
+        {"multiaddrs", addrsB},
+        {"proto", proto},
+        {"request", json::binary(request)},
+        {"timeoutMs", 5000},
+    };
+    auto resp = nodeA.protocolRequestCbor(json::to_cbor(args));
+    server.join();
+
+    LOGOS_ASSERT_TRUE(serverOk);
+    LOGOS_ASSERT_TRUE(serverSawRequest == request);
+    LOGOS_ASSERT_TRUE(resp.success);
+    LOGOS_ASSERT_TRUE(resp.value.is_binary());
+    const json out = json::from_cbor(resp.value.get_binary());
+    LOGOS_ASSERT_TRUE(std::vector<uint8_t>(out["response"].get_binary()) ==
+                      std::vector<uint8_t>(request.rbegin(), request.rend()));
+
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
+LOGOS_TEST(protocol_bridge_cbor_request_rejects_bad_args) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_FALSE(node.protocolRequestCbor({0xff, 0x00}).success);
+    // The request must be a byte string, not base64 text.
+    auto r = node.protocolRequestCbor(json::to_cbor(
+        json{{"peerId", "p"}, {"proto", "/x/1.0.0"}, {"request", "cGluZw=="}}));
+    LOGOS_ASSERT_FALSE(r.success);
+    LOGOS_ASSERT_TRUE(r.error.rfind("protocolRequestCbor: bad args", 0) == 0);
+}
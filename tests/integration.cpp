@@ -273,6 +273,26 @@ LOGOS_TEST(integration_create_node_then_node_info) {
     LOGOS_ASSERT_TRUE(node.stop().success);
 }
 
+// createNode applies its config over the constructor's; per-topic bounds the
+// second config leaves out must not linger from the first.
+LOGOS_TEST(integration_create_node_replaces_topic_bounds) {
+    Libp2pModuleImpl node(Libp2pModuleOptions{
+        .gossipsubQueueTopicBounds = {{"bounded", {1, 4096}}}});
+    LOGOS_ASSERT_TRUE(node.createNode(R"({"addrs": ["/ip4/127.0.0.1/tcp/0"]})").success);
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe("bounded").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("bounded", "one").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("bounded", "two").success);
+    for (const char* want : {"one", "two"}) {
+        auto res = node.gossipsubNextMessage("bounded", 1000);
+        LOGOS_ASSERT_TRUE(res.success);
+        LOGOS_ASSERT_TRUE(res.value.get<std::string>() == want);
+    }
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
 LOGOS_TEST(integration_create_node_invalid_config_fails) {
     Libp2pModuleImpl node;
     auto res = node.createNode("{not valid json");
@@ -0,0 +1,132 @@
+#include <logos_test.h>
+#include <plugin.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test_helpers.h"
+
+using json = nlohmann::json;
+
+namespace {
+uint64_t opIdOf(const StdLogosResult& res) {
+    return res.value.value("opId", uint64_t(0));
+}
+}
+
+LOGOS_TEST(async_connect_and_dial_complete_through_operation_result) {
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    auto connect = nodeA.connectPeerAsync(peerIdB, addrsB, 500);
+    LOGOS_ASSERT_TRUE(connect.success);
+    LOGOS_ASSERT_NE(opIdOf(connect), uint64_t(0));
+
+    auto connected = nodeA.operationResult(opIdOf(connect), 5000);
+    LOGOS_ASSERT_TRUE(connected.success);
+    LOGOS_ASSERT_TRUE(connected.value["done"].get<bool>());
+    LOGOS_ASSERT_TRUE(connected.value["success"].get<bool>());
+
+    auto dial = nodeA.dialAsync(peerIdB, "/ipfs/ping/1.0.0");
+    LOGOS_ASSERT_TRUE(dial.success);
+    auto dialed = nodeA.operationResult(opIdOf(dial), 5000);
+    LOGOS_ASSERT_TRUE(dialed.value["success"].get<bool>());
+    const uint64_t streamId = dialed.value["value"].get<uint64_t>();
+    LOGOS_ASSERT_NE(streamId, uint64_t(0));
+
+    // The result is handed out once; the id is forgotten after.
+    LOGOS_ASSERT_FALSE(nodeA.operationResult(opIdOf(dial), 0).success);
+
+    LOGOS_ASSERT_TRUE(nodeA.streamRelease(streamId).success);
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
+LOGOS_TEST(async_failure_is_reported_as_the_op_result) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    auto dial = node.dialAsync("12D3KooWInvalidPeerForTest", "/test/1.0.0");
+    LOGOS_ASSERT_TRUE(dial.success);
+    auto res = node.operationResult(opIdOf(dial), 5000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value["done"].get<bool>());
+    LOGOS_ASSERT_FALSE(res.value["success"].get<bool>());
+    LOGOS_ASSERT_TRUE(res.value["error"].get<std::string>().rfind("Failed to dial", 0) == 0);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+LOGOS_TEST(async_without_context_fails_immediately) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_FALSE(node.kadGetValueAsync("key", 1).success);
+}
+
+// One caller thread keeps many ops in flight and collects them as events.
+LOGOS_TEST(async_ops_in_flight_each_emit_one_completion_event) {
+    constexpr int NUM_OPS = 32;
+
+    std::mutex mu;
+    std::vector<uint64_t> completed;
+    Libp2pModuleImpl node;
+    node.emitEvent = [&](const std::string& name, const std::string& data) {
+        if (name != "operationCompleted") return;
+        std::lock_guard<std::mutex> lock(mu);
+        completed.push_back(json::parse(data)["opId"].get<uint64_t>());
+    };
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    std::vector<uint64_t> submitted;
+    for (int i = 0; i < NUM_OPS; ++i) {
+        auto res = node.kadGetProvidersAsync("async-provider-key-" + std::to_string(i));
+        LOGOS_ASSERT_TRUE(res.success);
+        submitted.push_back(opIdOf(res));
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (completed.size() >= submitted.size()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        LOGOS_ASSERT_EQ(completed.size(), submitted.size());
+    }
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+LOGOS_TEST(async_cancel_completes_a_running_op_at_once) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    // A non-routable address keeps the connect pending for its whole timeout.
+    auto connect = node.connectPeerAsync("16Uiu2HAmCancelTestPeerUnreachable",
+                                         {"/ip4/10.255.255.1/tcp/4001"}, 5000);
+    LOGOS_ASSERT_TRUE(connect.success);
+    const uint64_t id = opIdOf(connect);
+
+    const auto start = std::chrono::steady_clock::now();
+    LOGOS_ASSERT_TRUE(node.cancelOperation(id).success);
+    auto res = node.operationResult(id, 1000);
+    const auto waited = std::chrono::steady_clock::now() - start;
+
+    LOGOS_ASSERT_TRUE(res.value["done"].get<bool>());
+    LOGOS_ASSERT_FALSE(res.value["success"].get<bool>());
+    LOGOS_ASSERT_TRUE(res.value["error"].get<std::string>() == "cancelled");
+    LOGOS_ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(waited).count(), 1000);
+
+    // Taken and finished: nothing left to cancel.
+    LOGOS_ASSERT_FALSE(node.cancelOperation(id).success);
+    LOGOS_ASSERT_FALSE(node.cancelOperation(999999).success);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
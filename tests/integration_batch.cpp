@@ -0,0 +1,93 @@
+#include <logos_test.h>
+#include <plugin.h>
+#include <chrono>
+#include <string>
+#include "test_helpers.h"
+
+using json = nlohmann::json;
+
+LOGOS_TEST(batch_fans_out_connects_and_returns_results_in_order) {
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    Libp2pModuleImpl nodeC;
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    LOGOS_ASSERT_TRUE(nodeC.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+    auto [peerIdC, addrsC] = getPeerInfoPair(nodeC);
+
+    auto res = nodeA.batch(json::array({
+        {{"op", "connectPeer"}, {"args", {{"peerId", peerIdB}, {"multiaddrs", addrsB}, {"timeoutMs", 2000}}}},
+        {{"op", "connectPeer"}, {"args", {{"peerId", peerIdC}, {"multiaddrs", addrsC}, {"timeoutMs", 2000}}}},
+        {{"op", "dial"}, {"args", {{"peerId", "12D3KooWInvalidPeerForTest"}, {"proto", "/test/1.0.0"}}}},
+    }).dump());
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_EQ(res.value.size(), size_t(3));
+    LOGOS_ASSERT_TRUE(res.value[0]["success"].get<bool>());
+    LOGOS_ASSERT_TRUE(res.value[1]["success"].get<bool>());
+    LOGOS_ASSERT_FALSE(res.value[2]["success"].get<bool>());
+    LOGOS_ASSERT_TRUE(res.value[2]["error"].get<std::string>().rfind("Failed to dial", 0) == 0);
+
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+    LOGOS_ASSERT_TRUE(nodeC.stop().success);
+}
+
+// Many DHT lookups in one call take about as long as the slowest, not the sum.
+LOGOS_TEST(batch_many_kad_lookups_share_one_wait) {
+    constexpr int NUM_OPS = 32;
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    json ops = json::array();
+    for (int i = 0; i < NUM_OPS; ++i) {
+        ops.push_back({{"op", "kadGetProviders"}, {"args", {{"cid", "batch-key-" + std::to_string(i)}}}});
+    }
+    auto res = node.batch(ops.dump());
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_EQ(res.value.size(), size_t(NUM_OPS));
+    for (const auto& r : res.value) {
+        LOGOS_ASSERT_TRUE(r.contains("success"));
+    }
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+LOGOS_TEST(batch_reports_bad_entries_per_op) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    auto res = node.batch(json::array({
+        {{"op", "noSuchOp"}},
+        {{"op", "dial"}, {"args", {{"peerId", 42}}}},
+        "not an object",
+        {{"op", "streamReadLp"}, {"args", {{"streamId", 1}, {"maxSize", uint64_t(1) << 40}}}},
+    }).dump());
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_EQ(res.value.size(), size_t(4));
+    LOGOS_ASSERT_TRUE(res.value[0]["error"].get<std::string>() == "batch: unknown op: noSuchOp");
+    LOGOS_ASSERT_TRUE(res.value[1]["error"].get<std::string>().rfind("batch: dial: bad args", 0) == 0);
+    LOGOS_ASSERT_FALSE(res.value[2]["success"].get<bool>());
+    // Screened by the op itself before it reaches libp2p.
+    LOGOS_ASSERT_TRUE(res.value[3]["error"].get<std::string>().rfind("Failed to read LP from stream", 0) == 0);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+LOGOS_TEST(batch_rejects_a_non_array) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_FALSE(node.batch("{}").success);
+    LOGOS_ASSERT_FALSE(node.batch("not json").success);
+
+    // An empty batch has nothing to wait for.
+    auto res = node.batch("[]");
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_EQ(res.value.size(), size_t(0));
+}
+
+LOGOS_TEST(batch_without_context_fails_each_op) {
+    Libp2pModuleImpl node;
+    auto res = node.batch(json::array({{{"op", "kadFindNode"}, {"args", {{"peerId", "x"}}}}}).dump());
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value[0]["error"].get<std::string>() == "No libp2p context");
+}
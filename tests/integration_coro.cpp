@@ -0,0 +1,134 @@
+#include <logos_test.h>
+#include <coro_node.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test_helpers.h"
+
+using json = nlohmann::json;
+
+namespace {
+CoroTask<StdLogosResult> dialThenRelease(CoroNode& node, std::string peerId,
+                                         std::vector<std::string> addrs) {
+    auto c = co_await node.connectPeer(peerId, addrs, 500);
+    if (!c.success) co_return c;
+    auto d = co_await node.dial(peerId, "/ipfs/ping/1.0.0");
+    if (!d.success) co_return d;
+    auto r = co_await node.streamRelease(d.value.get<uint64_t>());
+    if (!r.success) co_return r;
+    co_return d;
+}
+
+CoroTask<StdLogosResult> awaitOne(CoroNode::Op op) {
+    co_return co_await op;
+}
+}  // namespace
+
+LOGOS_TEST(coro_connect_dial_release_pipeline) {
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    WorkerExecutor ex;
+    CoroNode node(nodeA, ex);
+    auto res = blockOn(dialThenRelease(node, peerIdB, addrsB));
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_NE(res.value.get<uint64_t>(), uint64_t(0));
+
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
+LOGOS_TEST(coro_request_roundtrip_matches_protocol_request) {
+    const std::string proto = "/test/coro/1.0.0";
+
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.mountProtocol(proto).success);
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    bool serverOk = false;
+    std::thread server([&] {
+        auto acc = nodeB.protocolAcceptStream(json{{"proto", proto}, {"timeoutMs", 5000}}.dump());
+        if (!acc.success) return;
+        uint64_t sid = acc.value["streamId"].get<uint64_t>();
+        auto rd = nodeB.streamReadLp(sid, 1024);
+        if (!rd.success) return;
+        auto w = nodeB.streamWriteLp(sid, "echo:" + base64Decode(rd.value.get<std::string>()));
+        serverOk = w.success && nodeB.streamRelease(sid).success;
+    });
+
+    WorkerExecutor ex;
+    CoroNode node(nodeA, ex);
+    auto resp = blockOn(node.request(peerIdB, proto, addrsB, "ping", 5000, 1024));
+    server.join();
+
+    LOGOS_ASSERT_TRUE(serverOk);
+    LOGOS_ASSERT_TRUE(resp.success);
+    LOGOS_ASSERT_TRUE(base64Decode(resp.value["responseB64"].get<std::string>()) == "echo:ping");
+
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
+// A peer that accepts the stream and never answers fails the request at its
+// deadline, as protocolRequest would, instead of leaving it suspended.
+LOGOS_TEST(coro_request_gives_up_on_a_silent_peer_at_its_deadline) {
+    const std::string proto = "/test/coro-silent/1.0.0";
+
+    Libp2pModuleImpl nodeA;
+    Libp2pModuleImpl nodeB;
+    LOGOS_ASSERT_TRUE(nodeB.start().success);
+    LOGOS_ASSERT_TRUE(nodeB.mountProtocol(proto).success);
+    LOGOS_ASSERT_TRUE(nodeA.start().success);
+    auto [peerIdB, addrsB] = getPeerInfoPair(nodeB);
+
+    uint64_t held = 0;
+    std::thread server([&] {
+        auto acc = nodeB.protocolAcceptStream(json{{"proto", proto}, {"timeoutMs", 5000}}.dump());
+        if (acc.success) held = acc.value["streamId"].get<uint64_t>();
+    });
+
+    WorkerExecutor ex;
+    CoroNode node(nodeA, ex);
+    const auto start = std::chrono::steady_clock::now();
+    auto resp = blockOn(node.request(peerIdB, proto, addrsB, "ping", 1000, 1024));
+    const auto took = std::chrono::steady_clock::now() - start;
+    server.join();
+
+    LOGOS_ASSERT_FALSE(resp.success);
+    LOGOS_ASSERT_TRUE(resp.error == "request: read failed: deadline exceeded");
+    LOGOS_ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(took).count(), 3000);
+
+    if (held) nodeB.streamRelease(held);
+    LOGOS_ASSERT_TRUE(nodeA.stop().success);
+    LOGOS_ASSERT_TRUE(nodeB.stop().success);
+}
+
+// A failure before the op reaches libp2p resumes straight away with it.
+LOGOS_TEST(coro_op_without_context_fails_without_suspending) {
+    Libp2pModuleImpl node;
+    WorkerExecutor ex;
+    CoroNode coro(node, ex);
+    auto res = blockOn(awaitOne(coro.kadGetValue("key", 1)));
+    LOGOS_ASSERT_FALSE(res.success);
+    LOGOS_ASSERT_TRUE(res.error == "No libp2p context");
+}
+
+LOGOS_TEST(coro_op_failure_matches_the_blocking_variant) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    InlineExecutor ex;
+    CoroNode coro(node, ex);
+    auto res = blockOn(awaitOne(coro.dial("12D3KooWInvalidPeerForTest", "/test/1.0.0")));
+    LOGOS_ASSERT_FALSE(res.success);
+    LOGOS_ASSERT_TRUE(res.error.rfind("Failed to dial", 0) == 0);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
@@ -1,22 +1,28 @@
 #include <logos_test.h>
 #include <plugin.h>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 #include <memory>
 #include <set>
 #include <thread>
 #include <chrono>
 #include <string>
+#include <cstdlib>
+#include <unistd.h>
 #include "test_helpers.h"
 
 namespace {
-// -1 when the topic has no drop series yet.
-int64_t droppedCount(Libp2pModuleImpl& node, const std::string& topic) {
+// -1 when the topic has no drop series for `reason` yet.
+int64_t droppedCount(Libp2pModuleImpl& node, const std::string& topic,
+                     const std::string& reason = "full") {
     for (const auto& m : node.collectMetrics()["metrics"]) {
         if (m.value("name", std::string{}) != "libp2p_module_gossipsub_queue_dropped_total") {
             continue;
         }
-        if (m["labels"].value("topic", std::string{}) != topic) {
+        if (m["labels"].value("topic", std::string{}) != topic ||
+            m["labels"].value("reason", std::string{}) != reason) {
             continue;
         }
         return static_cast<int64_t>(m["value"].get<double>());
@@ -190,6 +196,167 @@ LOGOS_TEST(gossipsub_queue_buffers_up_to_cap) {
     LOGOS_ASSERT_TRUE(node.stop().success);
 }
 
+LOGOS_TEST(gossipsub_next_messages_drains_a_backlog_in_batches) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    std::string topic = "queue-batch-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+
+    const int NUM_MSGS = 20;
+    for (int i = 0; i < NUM_MSGS; ++i) {
+        LOGOS_ASSERT_TRUE(
+            node.gossipsubPublish(topic, "batch-" + std::to_string(i)).success);
+    }
+
+    std::set<std::string> drained;
+    while (drained.size() < size_t(NUM_MSGS)) {
+        auto res = node.gossipsubNextMessages(topic, 8, 0, 2000);
+        LOGOS_ASSERT_TRUE(res.success);
+        LOGOS_ASSERT_TRUE(res.value.is_array());
+        LOGOS_ASSERT_TRUE(!res.value.empty() && res.value.size() <= 8);
+        for (const auto& m : res.value) drained.insert(m.get<std::string>());
+    }
+    LOGOS_ASSERT_EQ(drained.size(), size_t(NUM_MSGS));
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessages(topic, 8, 0, 200).success);
+
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessages(topic, 0, 0, 0).success);
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessages(topic, 1, -1, 0).success);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+LOGOS_TEST(gossipsub_next_message_any_names_the_topic) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    const std::vector<std::string> topics = {"any-topic-a", "any-topic-b", "any-topic-c"};
+    for (const auto& t : topics) LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(t).success);
+
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("any-topic-b", "to-b").success);
+    auto res = node.gossipsubNextMessageAny(topics, 2000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value["topic"] == "any-topic-b");
+    LOGOS_ASSERT_TRUE(res.value["data"] == "to-b");
+
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessageAny(topics, 200).success);
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessageAny({}, 0).success);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+LOGOS_TEST(gossipsub_queue_drop_oldest_policy_keeps_the_newest) {
+    Libp2pModuleOptions opts;
+    opts.gossipsubQueueMaxMessages = 4;
+    opts.gossipsubQueuePolicy.overflow = TopicQueues::Overflow::DropOldest;
+    Libp2pModuleImpl node(opts);
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    std::string topic = "drop-oldest-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+    for (int i = 0; i < 8; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubPublish(topic, "m" + std::to_string(i)).success);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (droppedCount(node, topic, "evicted") != 4 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    LOGOS_ASSERT_EQ(droppedCount(node, topic, "evicted"), int64_t(4));
+    LOGOS_ASSERT_EQ(droppedCount(node, topic, "full"), int64_t(0));
+
+    for (int i = 4; i < 8; ++i) {
+        auto res = node.gossipsubNextMessage(topic, 1000);
+        LOGOS_ASSERT_TRUE(res.success);
+        LOGOS_ASSERT_TRUE(res.value == "m" + std::to_string(i));
+    }
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// Bounds set at runtime apply to a topic the node already queues for.
+LOGOS_TEST(gossipsub_set_queue_bounds_applies_at_runtime) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    std::string topic = "bounded/runtime-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+    LOGOS_ASSERT_TRUE(node.gossipsubSetQueueBounds("bounded/*", 2, 4096).success);
+    for (int i = 0; i < 5; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubPublish(topic, "m" + std::to_string(i)).success);
+    }
+    awaitDropped(node, topic, 3);
+    auto res = node.gossipsubNextMessage(topic, 1000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value == "m0");
+
+    LOGOS_ASSERT_FALSE(node.gossipsubSetQueueBounds(topic, -1, 4096).success);
+    LOGOS_ASSERT_TRUE(node.gossipsubClearQueueBounds("bounded/*").success);
+    LOGOS_ASSERT_FALSE(node.gossipsubClearQueueBounds("bounded/*").success);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// Past the in-memory bound messages spill to disk and come back in order.
+LOGOS_TEST(gossipsub_queue_spills_instead_of_dropping) {
+    char dir[] = "/tmp/gossipsub-spill-XXXXXX";
+    LOGOS_ASSERT_TRUE(mkdtemp(dir) != nullptr);
+    Libp2pModuleOptions opts;
+    opts.gossipsubQueueMaxMessages = 2;
+    opts.gossipsubQueueSpillDir = dir;
+    Libp2pModuleImpl node(opts);
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    std::string topic = "spill-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+    for (int i = 0; i < 6; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubPublish(topic, "m" + std::to_string(i)).success);
+    }
+    for (int i = 0; i < 6; ++i) {
+        auto res = node.gossipsubNextMessage(topic, 2000);
+        LOGOS_ASSERT_TRUE(res.success);
+        LOGOS_ASSERT_TRUE(res.value == "m" + std::to_string(i));
+    }
+    LOGOS_ASSERT_EQ(droppedCount(node, topic), int64_t(0));
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+    rmdir(dir);
+}
+
+// Residency is recorded as the poll call takes a message, so the histogram
+// counts exactly what was drained.
+LOGOS_TEST(gossipsub_queue_reports_residency_and_oldest_age) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+    const std::string topic = "queue-residency-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+
+    const int kSent = 3;
+    for (int i = 0; i < kSent; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubPublish(topic, "msg-" + std::to_string(i)).success);
+    }
+    for (int i = 0; i < kSent; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubNextMessage(topic, 2000).success);
+    }
+
+    int64_t taken = -1;
+    double age = -1;
+    for (const auto& m : node.collectMetrics()["metrics"]) {
+        if (m["labels"].value("topic", std::string{}) != topic) continue;
+        const std::string name = m.value("name", std::string{});
+        if (name == "libp2p_module_gossipsub_queue_residency_seconds") {
+            LOGOS_ASSERT_TRUE(m["type"] == "histogram");
+            taken = m["count"].get<int64_t>();
+        } else if (name == "libp2p_module_gossipsub_queue_oldest_age_seconds") {
+            age = m["value"].get<double>();
+        }
+    }
+    LOGOS_ASSERT_EQ(taken, int64_t(kSent));
+    LOGOS_ASSERT_EQ(age, 0.0);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
 LOGOS_TEST(gossipsub_queue_drops_newest_over_message_bound) {
     Libp2pModuleOptions opts;
     opts.gossipsubQueueMaxMessages = 4;
@@ -251,6 +418,244 @@ LOGOS_TEST(gossipsub_queue_disabled_when_a_bound_is_zero) {
     }
 }
 
+// Every subscribe republishes the callback. Replacing it while messages are
+// being delivered must not lose events or free one a worker is still inside.
+LOGOS_TEST(gossipsub_emit_event_can_be_replaced_while_delivering) {
+    Libp2pModuleImpl node;
+    std::atomic<int> delivered{0};
+    auto count = [&](const std::string& name, const std::string&) {
+        if (name == "gossipsubMessage") ++delivered;
+    };
+    node.emitEvent = count;
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    const std::string topic = "emit-swap-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+
+    const int kSent = 200;
+    std::atomic<bool> done{false};
+    std::thread publisher([&] {
+        for (int i = 0; i < kSent; ++i) node.gossipsubPublish(topic, "msg-" + std::to_string(i));
+        done = true;
+    });
+    for (int i = 0; !done; ++i) {
+        node.emitEvent = count;
+        LOGOS_ASSERT_TRUE(node.gossipsubSubscribe("emit-swap-side-" + std::to_string(i)).success);
+    }
+    publisher.join();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (delivered.load() < kSent && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    LOGOS_ASSERT_EQ(delivered.load(), kSent);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// Subscribing republishes the callback; replaced snapshots are freed once no
+// dispatch is using them, so churning topics does not pile up copies.
+LOGOS_TEST(gossipsub_subscribe_churn_keeps_one_emit_event_snapshot) {
+    Libp2pModuleImpl node;
+    auto token = std::make_shared<int>(0);
+    node.emitEvent = [token](const std::string&, const std::string&) {};
+    LOGOS_ASSERT_TRUE(node.start().success);
+    for (int i = 0; i < 100; ++i) {
+        const std::string topic = "emit-churn-" + std::to_string(i);
+        LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+        LOGOS_ASSERT_TRUE(node.gossipsubUnsubscribe(topic).success);
+    }
+    // `token` here, `emitEvent` and the one published snapshot.
+    LOGOS_ASSERT_EQ(token.use_count(), long(3));
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// A consumer stuck inside the event holds up the dispatcher thread only: the
+// network thread keeps filling the topic queue behind it.
+LOGOS_TEST(gossipsub_event_queue_decouples_a_stuck_consumer) {
+    Libp2pModuleOptions opts;
+    opts.eventQueueMaxEvents = 1024;
+    Libp2pModuleImpl node(opts);
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool held = true;
+    int delivered = 0;
+    node.emitEvent = [&](const std::string& name, const std::string&) {
+        if (name != "gossipsubMessage") return;
+        std::unique_lock<std::mutex> lock(mutex);
+        ++delivered;
+        cond.notify_all();
+        cond.wait(lock, [&] { return !held; });
+    };
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    const std::string topic = "event-queue-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+    const int kSent = 20;
+    for (int i = 0; i < kSent; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubPublish(topic, "msg-" + std::to_string(i)).success);
+    }
+    for (int i = 0; i < kSent; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubNextMessage(topic, 2000).success);
+    }
+
+    int depth = -1;
+    for (const auto& m : node.collectMetrics()["metrics"]) {
+        if (m.value("name", std::string{}) == "libp2p_module_event_queue_depth") {
+            depth = static_cast<int>(m["value"].get<double>());
+        }
+    }
+    LOGOS_ASSERT_GE(depth, kSent - 1 - 1);  // one being delivered, maybe one not yet queued
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        held = false;
+    }
+    cond.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(5), [&] { return delivered == kSent; });
+        LOGOS_ASSERT_EQ(delivered, kSent);
+    }
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// Batching replaces the per-message event; the messages arrive in order across
+// one or more arrays, the last of them flushed by the linger.
+LOGOS_TEST(gossipsub_event_batching_coalesces_messages) {
+    Libp2pModuleOptions opts;
+    opts.gossipsubEventBatchMaxMessages = 8;
+    opts.gossipsubEventBatchLingerMs = 5;
+    Libp2pModuleImpl node(opts);
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::string> received;
+    int single = 0;
+    node.emitEvent = [&](const std::string& name, const std::string& data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (name == "gossipsubMessage") ++single;
+        if (name != "gossipsubMessages") return;
+        for (const auto& m : nlohmann::json::parse(data)) {
+            received.push_back(m["data"].get<std::string>());
+        }
+        cond.notify_all();
+    };
+    LOGOS_ASSERT_TRUE(node.start().success);
+
+    const std::string topic = "event-batch-topic";
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe(topic).success);
+    const int kSent = 20;
+    for (int i = 0; i < kSent; ++i) {
+        LOGOS_ASSERT_TRUE(node.gossipsubPublish(topic, "msg-" + std::to_string(i)).success);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(5), [&] { return received.size() >= size_t(kSent); });
+        LOGOS_ASSERT_EQ(received.size(), size_t(kSent));
+        for (int i = 0; i < kSent; ++i) LOGOS_ASSERT_TRUE(received[i] == "msg-" + std::to_string(i));
+        LOGOS_ASSERT_EQ(single, 0);
+    }
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// Each mode skips the path it leaves out: no event for a queue-only topic, no
+// backlog for an event-only one, and neither for "none".
+LOGOS_TEST(gossipsub_delivery_mode_skips_unwanted_paths) {
+    Libp2pModuleImpl node;
+    std::atomic<int> events{0};
+    node.emitEvent = [&](const std::string& name, const std::string&) {
+        if (name == "gossipsubMessage") ++events;
+    };
+    LOGOS_ASSERT_TRUE(node.start().success);
+    LOGOS_ASSERT_FALSE(node.gossipsubSetDelivery("polled", "poll").success);
+    LOGOS_ASSERT_FALSE(node.gossipsubClearDelivery("polled").success);
+
+    LOGOS_ASSERT_TRUE(node.gossipsubSetDelivery("polled", "queue").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe("polled").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("polled", "p").success);
+    auto res = node.gossipsubNextMessage("polled", 2000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value.get<std::string>() == "p");
+
+    LOGOS_ASSERT_TRUE(node.gossipsubSetDelivery("", "none").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe("muted").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("muted", "m").success);
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessage("muted", 500).success);
+
+    LOGOS_ASSERT_TRUE(node.gossipsubSetDelivery("listened", "event").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe("listened").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("listened", "l").success);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (events.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    LOGOS_ASSERT_EQ(events.load(), 1);
+    LOGOS_ASSERT_FALSE(node.gossipsubNextMessage("listened", 200).success);
+    LOGOS_ASSERT_TRUE(node.gossipsubClearDelivery("listened").success);
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
+// Bytes that are not UTF-8 reach an encoded topic's event and queue intact,
+// published through gossipsubPublishCbor without a base64 round trip.
+LOGOS_TEST(gossipsub_encoded_topics_carry_non_utf8_payloads) {
+    Libp2pModuleImpl node;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::pair<std::string, std::string>> events;
+    node.emitEvent = [&](const std::string& name, const std::string& data) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.emplace_back(name, data);
+        cond.notify_all();
+    };
+    LOGOS_ASSERT_TRUE(node.start().success);
+    LOGOS_ASSERT_FALSE(node.gossipsubSubscribeEncoded("b64", "binary").success);
+
+    const std::vector<uint8_t> bytes = {0xff, 0x00, 0xc0, 0xaf, 0x80};
+    const std::string raw(bytes.begin(), bytes.end());
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribeEncoded("b64", "base64").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribeEncoded("cbor", "cbor").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublishCbor("b64", bytes).success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublishCbor("cbor", bytes).success);
+
+    auto res = node.gossipsubNextMessage("b64", 2000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(base64Decode(res.value.get<std::string>()) == raw);
+    res = node.gossipsubNextMessage("cbor", 2000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value.is_binary());
+    const auto polled = nlohmann::json::from_cbor(res.value.get_binary()).get_binary();
+    LOGOS_ASSERT_TRUE(std::string(polled.begin(), polled.end()) == raw);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_for(lock, std::chrono::seconds(5), [&] { return events.size() >= 2; });
+        LOGOS_ASSERT_EQ(events.size(), size_t(2));
+        for (const auto& [name, data] : events) {
+            if (name == "gossipsubMessage") {
+                const auto j = nlohmann::json::parse(data);
+                LOGOS_ASSERT_TRUE(j["topic"] == "b64");
+                LOGOS_ASSERT_TRUE(base64Decode(j["data"].get<std::string>()) == raw);
+            } else {
+                LOGOS_ASSERT_TRUE(name == "gossipsubMessageCbor");
+                const auto j = nlohmann::json::from_cbor(data);
+                LOGOS_ASSERT_TRUE(j["topic"] == "cbor");
+                const auto& got = j["data"].get_binary();
+                LOGOS_ASSERT_TRUE(std::string(got.begin(), got.end()) == raw);
+            }
+        }
+    }
+
+    // Subscribing again without an encoding goes back to text.
+    LOGOS_ASSERT_TRUE(node.gossipsubSubscribe("b64").success);
+    LOGOS_ASSERT_TRUE(node.gossipsubPublish("b64", "plain").success);
+    res = node.gossipsubNextMessage("b64", 2000);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value.get<std::string>() == "plain");
+
+    LOGOS_ASSERT_TRUE(node.stop().success);
+}
+
 LOGOS_TEST(gossipsub_binary_payload) {
     Libp2pModuleImpl nodeA;
     Libp2pModuleImpl nodeB;
@@ -51,3 +51,38 @@ LOGOS_TEST(collect_metrics_entries_match_openmetrics_schema) {
         }
     }
 }
+
+LOGOS_TEST(collect_metrics_reports_late_reply_series) {
+    auto res = collect();
+    std::set<std::string> names;
+    for (const auto& m : res["metrics"]) names.insert(m["name"].get<std::string>());
+    LOGOS_ASSERT_TRUE(names.count("libp2p_module_abandoned_ops"));
+    LOGOS_ASSERT_TRUE(names.count("libp2p_module_late_results_reclaimed_total"));
+}
+
+LOGOS_TEST(collect_metrics_reports_per_op_series) {
+    Libp2pModuleImpl node;
+    LOGOS_ASSERT_TRUE(node.start().success);
+    node.collectMetrics();
+    auto res = node.collectMetrics();
+    LOGOS_ASSERT_TRUE(node.stop().success);
+
+    // The first collect is itself an op, so the second one reports it.
+    bool sawTotal = false, sawBucket = false, sawInFlight = false;
+    for (const auto& m : res["metrics"]) {
+        if (!m.contains("labels") || m["labels"].value("op", "") != "collect_metrics") continue;
+        const auto name = m["name"].get<std::string>();
+        if (name == "libp2p_module_ops_total" && m["labels"]["outcome"] == "success") {
+            sawTotal = m["value"].get<double>() >= 1;
+        }
+        if (name == "libp2p_module_op_duration_seconds") {
+            LOGOS_ASSERT_TRUE(m["type"] == "histogram");
+            sawBucket = m["buckets"].back()["le"] == "+Inf" &&
+                        m["buckets"].back()["count"].get<uint64_t>() >= 1;
+        }
+        if (name == "libp2p_module_ops_in_flight") sawInFlight = true;
+    }
+    LOGOS_ASSERT_TRUE(sawTotal);
+    LOGOS_ASSERT_TRUE(sawBucket);
+    LOGOS_ASSERT_TRUE(sawInFlight);
+}
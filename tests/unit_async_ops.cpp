@@ -0,0 +1,118 @@
+// AsyncOps in isolation (no Libp2pModuleImpl, links without libp2p.so).
+
+#include <logos_test.h>
+#include <async_ops.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace std::chrono;
+
+LOGOS_TEST(async_ops_ids_start_at_one_and_are_unique) {
+    AsyncOps ops;
+    const uint64_t a = ops.begin();
+    const uint64_t b = ops.begin();
+    LOGOS_ASSERT_EQ(a, uint64_t(1));
+    LOGOS_ASSERT_NE(a, b);
+    LOGOS_ASSERT_EQ(ops.pendingCount(), size_t(2));
+}
+
+LOGOS_TEST(async_ops_take_polls_pending_then_returns_result_once) {
+    AsyncOps ops;
+    const uint64_t id = ops.begin();
+
+    StdLogosResult out;
+    LOGOS_ASSERT_TRUE(ops.take(id, 0, out) == AsyncOps::Take::Pending);
+
+    ops.complete(id, {true, "value", ""});
+    LOGOS_ASSERT_TRUE(ops.take(id, 0, out) == AsyncOps::Take::Done);
+    LOGOS_ASSERT_TRUE(out.success);
+    LOGOS_ASSERT_TRUE(out.value.get<std::string>() == "value");
+
+    LOGOS_ASSERT_TRUE(ops.take(id, 0, out) == AsyncOps::Take::Unknown);
+    LOGOS_ASSERT_EQ(ops.pendingCount(), size_t(0));
+    LOGOS_ASSERT_EQ(ops.unclaimedCount(), size_t(0));
+}
+
+LOGOS_TEST(async_ops_take_waits_for_a_late_completion) {
+    AsyncOps ops;
+    const uint64_t id = ops.begin();
+    std::thread replier([&] {
+        std::this_thread::sleep_for(milliseconds(20));
+        ops.complete(id, {false, {}, "Failed to dial: boom"});
+    });
+
+    StdLogosResult out;
+    auto r = ops.take(id, 2000, out);
+    replier.join();
+    LOGOS_ASSERT_TRUE(r == AsyncOps::Take::Done);
+    LOGOS_ASSERT_FALSE(out.success);
+    LOGOS_ASSERT_TRUE(out.error == "Failed to dial: boom");
+}
+
+LOGOS_TEST(async_ops_listener_sees_each_completion_once) {
+    AsyncOps ops;
+    int calls = 0;
+    uint64_t seen = 0;
+    ops.setListener([&](uint64_t opId, const StdLogosResult& res) {
+        ++calls;
+        seen = opId;
+        LOGOS_ASSERT_TRUE(res.success);
+    });
+
+    const uint64_t id = ops.begin();
+    LOGOS_ASSERT_TRUE(ops.complete(id, {true, {}, ""}));
+    LOGOS_ASSERT_FALSE(ops.complete(id, {true, {}, ""}));
+    LOGOS_ASSERT_EQ(calls, 1);
+    LOGOS_ASSERT_EQ(seen, id);
+
+    ops.setListener(nullptr);
+    ops.complete(ops.begin(), {true, {}, ""});
+    LOGOS_ASSERT_EQ(calls, 1);
+}
+
+// An event-only caller never takes its results, so they must not pile up.
+LOGOS_TEST(async_ops_evicts_oldest_unclaimed_results) {
+    AsyncOps ops;
+    const uint64_t first = ops.begin();
+    ops.complete(first, {true, {}, ""});
+    for (size_t i = 0; i < AsyncOps::kMaxUnclaimed; ++i) {
+        ops.complete(ops.begin(), {true, {}, ""});
+    }
+    LOGOS_ASSERT_EQ(ops.unclaimedCount(), AsyncOps::kMaxUnclaimed);
+
+    StdLogosResult out;
+    LOGOS_ASSERT_TRUE(ops.take(first, 0, out) == AsyncOps::Take::Unknown);
+}
+
+// Pending ops are never evicted, however many results pass through.
+LOGOS_TEST(async_ops_keeps_pending_ops_past_the_unclaimed_bound) {
+    AsyncOps ops;
+    const uint64_t slow = ops.begin();
+    for (size_t i = 0; i < 3 * AsyncOps::kMaxUnclaimed; ++i) {
+        StdLogosResult out;
+        const uint64_t id = ops.begin();
+        ops.complete(id, {true, {}, ""});
+        LOGOS_ASSERT_TRUE(ops.take(id, 0, out) == AsyncOps::Take::Done);
+    }
+    LOGOS_ASSERT_EQ(ops.pendingCount(), size_t(1));
+
+    ops.complete(slow, {true, {}, ""});
+    StdLogosResult out;
+    LOGOS_ASSERT_TRUE(ops.take(slow, 0, out) == AsyncOps::Take::Done);
+}
+
+// Cancelling is completing early: the late reply is then refused, so the
+// caller can reclaim what it carries.
+LOGOS_TEST(async_ops_late_reply_after_cancel_is_refused) {
+    AsyncOps ops;
+    const uint64_t id = ops.begin();
+    LOGOS_ASSERT_TRUE(ops.complete(id, {false, {}, "cancelled"}));
+    LOGOS_ASSERT_FALSE(ops.complete(id, {true, 42, ""}));
+
+    StdLogosResult out;
+    LOGOS_ASSERT_TRUE(ops.take(id, 0, out) == AsyncOps::Take::Done);
+    LOGOS_ASSERT_TRUE(out.error == "cancelled");
+    LOGOS_ASSERT_FALSE(ops.complete(id, {true, 42, ""}));
+}
@@ -0,0 +1,106 @@
+// base64Encode/base64Decode at every SIMD level the CPU has, against each other
+// and against the scalar codec, including the strict error cases.
+
+#include <logos_test.h>
+#include <utils.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const Base64Simd kLevels[] = {Base64Simd::Scalar, Base64Simd::Sse41, Base64Simd::Avx2};
+
+// Runs `fn` once per level, restoring the cap after.
+template <class Fn>
+void forEachLevel(Fn fn) {
+    const Base64Simd saved = setBase64SimdCap(Base64Simd::Avx2);
+    for (Base64Simd level : kLevels) {
+        setBase64SimdCap(level);
+        fn(level);
+    }
+    setBase64SimdCap(saved);
+}
+
+std::string decodeError(const std::string& in) {
+    try {
+        base64Decode(in);
+    } catch (const std::invalid_argument& e) {
+        return e.what();
+    }
+    return "";
+}
+
+std::vector<uint8_t> randomBytes(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> out(n);
+    for (auto& b : out) b = static_cast<uint8_t>(rng());
+    return out;
+}
+
+}  // namespace
+
+LOGOS_TEST(base64_known_vectors) {
+    forEachLevel([](Base64Simd) {
+        const std::string plain = "Many hands make light work. Many hands make light work!";
+        const std::string encoded =
+            "TWFueSBoYW5kcyBtYWtlIGxpZ2h0IHdvcmsuIE1hbnkgaGFuZHMgbWFrZSBsaWdodCB3b3JrIQ==";
+        const std::vector<uint8_t> bytes(plain.begin(), plain.end());
+        LOGOS_ASSERT_TRUE(base64Encode(bytes) == encoded);
+        LOGOS_ASSERT_TRUE(base64Decode(encoded) == plain);
+        LOGOS_ASSERT_TRUE(base64Encode(std::vector<uint8_t>{}).empty());
+        LOGOS_ASSERT_TRUE(base64Decode("").empty());
+    });
+}
+
+LOGOS_TEST(base64_levels_agree_on_every_length_around_the_block_sizes) {
+    for (size_t n = 0; n < 200; ++n) {
+        const auto bytes = randomBytes(n, static_cast<uint32_t>(n));
+        setBase64SimdCap(Base64Simd::Scalar);
+        const std::string reference = base64Encode(bytes);
+        forEachLevel([&](Base64Simd) {
+            LOGOS_ASSERT_TRUE(base64Encode(bytes) == reference);
+            const std::string back = base64Decode(reference);
+            LOGOS_ASSERT_TRUE(back == std::string(bytes.begin(), bytes.end()));
+        });
+    }
+}
+
+LOGOS_TEST(base64_round_trips_a_large_frame) {
+    const auto bytes = randomBytes((1 << 20) + 7, 42);
+    forEachLevel([&](Base64Simd) {
+        const std::string back = base64Decode(base64Encode(bytes));
+        LOGOS_ASSERT_TRUE(back == std::string(bytes.begin(), bytes.end()));
+    });
+}
+
+LOGOS_TEST(base64_every_level_reports_the_same_error_wherever_the_bad_char_is) {
+    const std::string good = base64Encode(randomBytes(96, 7));  // 128 chars, no padding
+    const char bad[] = {'!', '=', '-', '_', ' ', '\0', '\x80', '\xff'};
+    for (size_t pos = 0; pos < good.size(); ++pos) {
+        for (char c : bad) {
+            std::string in = good;
+            in[pos] = c;
+            setBase64SimdCap(Base64Simd::Scalar);
+            const std::string expected = decodeError(in);
+            LOGOS_ASSERT_FALSE(expected.empty());
+            forEachLevel([&](Base64Simd) { LOGOS_ASSERT_TRUE(decodeError(in) == expected); });
+        }
+    }
+}
+
+LOGOS_TEST(base64_decode_keeps_strict_validation) {
+    forEachLevel([](Base64Simd) {
+        LOGOS_ASSERT_TRUE(decodeError("QUJD=") == "base64Decode: length is not a multiple of 4");
+        LOGOS_ASSERT_TRUE(decodeError("Q=QQ") == "base64Decode: misplaced padding");
+        LOGOS_ASSERT_TRUE(decodeError("Q===") == "base64Decode: misplaced padding");
+        LOGOS_ASSERT_TRUE(decodeError("QQ=B") == "base64Decode: data after padding");
+        LOGOS_ASSERT_TRUE(decodeError("QR==") == "base64Decode: non-canonical trailing bits");
+        LOGOS_ASSERT_TRUE(decodeError("QUJD\nQUJD") ==
+                          "base64Decode: length is not a multiple of 4");
+        LOGOS_ASSERT_TRUE(decodeError(std::string(64, 'A') + "QUJ?") ==
+                          "base64Decode: invalid character");
+    });
+}
@@ -109,10 +109,190 @@ LOGOS_TEST(apply_wrong_field_type_throws) {
 LOGOS_TEST(apply_reads_gossipsub_queue_bounds) {
     Libp2pModuleOptions opts;
     cfg::apply(json::parse(
-                   R"({"gossipsubQueueMaxMessages": 16, "gossipsubQueueMaxBytes": 0})"),
+                   R"({"gossipsubQueueMaxMessages": 16, "gossipsubQueueMaxBytes": 0,
+                       "gossipsubQueueTotalMaxBytes": 1048576})"),
                opts);
     LOGOS_ASSERT_EQ(opts.gossipsubQueueMaxMessages, size_t(16));
     LOGOS_ASSERT_EQ(opts.gossipsubQueueMaxBytes, size_t(0));
+    LOGOS_ASSERT_EQ(opts.gossipsubQueueTotalMaxBytes, size_t(1048576));
+}
+
+LOGOS_TEST(apply_reads_gossipsub_queue_policies) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({
+        "gossipsubQueuePolicy": {"overflow": "dropOldest", "ttlMs": 5000},
+        "gossipsubQueueTopicPolicies": {
+            "state": {"overflow": "keepLatest", "keyDelimiter": "|"},
+            "alerts": {"ttlMs": 0}
+        }
+    })"),
+               opts);
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueuePolicy.overflow == TopicQueues::Overflow::DropOldest);
+    LOGOS_ASSERT_EQ(opts.gossipsubQueuePolicy.ttlMs, int64_t(5000));
+    LOGOS_ASSERT_EQ(opts.gossipsubQueueTopicPolicies.size(), size_t(2));
+
+    const auto& state = opts.gossipsubQueueTopicPolicies.at("state");
+    LOGOS_ASSERT_TRUE(state.overflow == TopicQueues::Overflow::KeepLatest);
+    LOGOS_ASSERT_TRUE(state.keyDelimiter == "|");
+    LOGOS_ASSERT_EQ(state.ttlMs, int64_t(5000));  // from the default policy
+
+    const auto& alerts = opts.gossipsubQueueTopicPolicies.at("alerts");
+    LOGOS_ASSERT_TRUE(alerts.overflow == TopicQueues::Overflow::DropOldest);
+    LOGOS_ASSERT_EQ(alerts.ttlMs, int64_t(0));
+}
+
+LOGOS_TEST(apply_rejects_bad_gossipsub_queue_policies) {
+    for (const char* raw : {R"({"gossipsubQueuePolicy": "dropOldest"})",
+                            R"({"gossipsubQueuePolicy": {"overflow": "dropRandom"}})",
+                            R"({"gossipsubQueuePolicy": {"ttlMs": -1}})",
+                            R"({"gossipsubQueuePolicy": {"ttlMs": 9223372036854775807}})",
+                            R"({"gossipsubQueuePolicy": {"keyDelimiter": ""}})",
+                            R"({"gossipsubQueueTopicPolicies": []})",
+                            R"({"gossipsubQueueTopicPolicies": {"t": {"overflow": 1}}})"}) {
+        Libp2pModuleOptions opts;
+        bool threw = false;
+        try {
+            cfg::apply(json::parse(raw), opts);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        LOGOS_ASSERT_TRUE(threw);
+    }
+}
+
+LOGOS_TEST(apply_reads_gossipsub_queue_topic_bounds) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({
+        "gossipsubQueueMaxMessages": 64,
+        "gossipsubQueueTopicBounds": {
+            "blocks": {"maxBytes": 67108864},
+            "chat/*": {"maxMessages": 16, "maxBytes": 65536}
+        }
+    })"),
+               opts);
+    LOGOS_ASSERT_EQ(opts.gossipsubQueueTopicBounds.size(), size_t(2));
+
+    const auto& blocks = opts.gossipsubQueueTopicBounds.at("blocks");
+    LOGOS_ASSERT_EQ(blocks.maxMessages, size_t(64));  // from the default bound
+    LOGOS_ASSERT_EQ(blocks.maxBytes, size_t(67108864));
+
+    const auto& chat = opts.gossipsubQueueTopicBounds.at("chat/*");
+    LOGOS_ASSERT_EQ(chat.maxMessages, size_t(16));
+    LOGOS_ASSERT_EQ(chat.maxBytes, size_t(65536));
+
+    for (const char* raw : {R"({"gossipsubQueueTopicBounds": []})",
+                            R"({"gossipsubQueueTopicBounds": {"t": 16}})",
+                            R"({"gossipsubQueueTopicBounds": {"t": {"maxBytes": -1}}})"}) {
+        bool threw = false;
+        try {
+            cfg::apply(json::parse(raw), opts);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        LOGOS_ASSERT_TRUE(threw);
+    }
+}
+
+LOGOS_TEST(apply_reads_gossipsub_queue_spill) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({"gossipsubQueueSpillDir": "/var/tmp/spill",
+                               "gossipsubQueueSpillMaxBytes": 65536})"),
+               opts);
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueSpillDir == "/var/tmp/spill");
+    LOGOS_ASSERT_EQ(opts.gossipsubQueueSpillMaxBytes, size_t(65536));
+
+    bool threw = false;
+    try {
+        cfg::apply(json::parse(R"({"gossipsubQueueSpillMaxBytes": -1})"), opts);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    LOGOS_ASSERT_TRUE(threw);
+}
+
+LOGOS_TEST(apply_reads_event_queue) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({"eventQueueMaxEvents": 4096, "eventQueueMaxBytes": 1048576,
+                               "eventQueueOverflow": "dropOldest"})"),
+               opts);
+    LOGOS_ASSERT_EQ(opts.eventQueueMaxEvents, size_t(4096));
+    LOGOS_ASSERT_EQ(opts.eventQueueMaxBytes, size_t(1048576));
+    LOGOS_ASSERT_TRUE(opts.eventQueueOverflow == EventQueue::Overflow::DropOldest);
+
+    for (const char* bad : {R"({"eventQueueOverflow": "block"})", R"({"eventQueueMaxEvents": -1})"}) {
+        bool threw = false;
+        try {
+            cfg::apply(json::parse(bad), opts);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        LOGOS_ASSERT_TRUE(threw);
+    }
+}
+
+LOGOS_TEST(apply_reads_gossipsub_delivery) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({"gossipsubDelivery": "queue",
+                               "gossipsubTopicDelivery": {"chat": "event", "blocks": "none"}})"),
+               opts);
+    LOGOS_ASSERT_TRUE(opts.gossipsubDelivery == TopicDelivery::kQueue);
+    LOGOS_ASSERT_EQ(opts.gossipsubTopicDelivery.size(), size_t(2));
+    LOGOS_ASSERT_TRUE(opts.gossipsubTopicDelivery.at("chat") == TopicDelivery::kEvent);
+    LOGOS_ASSERT_TRUE(opts.gossipsubTopicDelivery.at("blocks") == TopicDelivery::kNone);
+
+    for (const char* bad : {R"({"gossipsubDelivery": "all"})", R"({"gossipsubDelivery": 1})",
+                            R"({"gossipsubTopicDelivery": {"chat": "poll"}})",
+                            R"({"gossipsubTopicDelivery": ["chat"]})"}) {
+        bool threw = false;
+        try {
+            cfg::apply(json::parse(bad), opts);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        LOGOS_ASSERT_TRUE(threw);
+    }
+}
+
+LOGOS_TEST(apply_reads_gossipsub_event_batching) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({"gossipsubEventBatchMaxMessages": 64,
+                               "gossipsubEventBatchMaxBytes": 65536,
+                               "gossipsubEventBatchLingerMs": 5})"),
+               opts);
+    LOGOS_ASSERT_EQ(opts.gossipsubEventBatchMaxMessages, size_t(64));
+    LOGOS_ASSERT_EQ(opts.gossipsubEventBatchMaxBytes, size_t(65536));
+    LOGOS_ASSERT_EQ(opts.gossipsubEventBatchLingerMs, int64_t(5));
+
+    bool threw = false;
+    try {
+        cfg::apply(json::parse(R"({"gossipsubEventBatchLingerMs": -1})"), opts);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    LOGOS_ASSERT_TRUE(threw);
+}
+
+LOGOS_TEST(apply_reads_gossipsub_queue_backend) {
+    Libp2pModuleOptions opts;
+    cfg::apply(json::parse(R"({"gossipsubQueueBackend": "ring"})"), opts);
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueBackend == TopicQueues::Backend::Ring);
+    cfg::apply(json::parse(R"({"gossipsubQueueBackend": "deque"})"), opts);
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueBackend == TopicQueues::Backend::Deque);
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueuePolicy.overflow == TopicQueues::Overflow::DropNewest);
+    LOGOS_ASSERT_EQ(opts.gossipsubQueuePolicy.ttlMs, int64_t(0));
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueTopicPolicies.empty());
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueTopicBounds.empty());
+
+    for (const char* raw : {R"({"gossipsubQueueBackend": "list"})",
+                            R"({"gossipsubQueueBackend": 1})"}) {
+        bool threw = false;
+        try {
+            cfg::apply(json::parse(raw), opts);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        LOGOS_ASSERT_TRUE(threw);
+    }
 }
 
 LOGOS_TEST(apply_reads_gossipsub_ingress_limits) {
@@ -196,6 +376,7 @@ LOGOS_TEST(apply_validates_nat_config_boundaries) {
 // negative the sign check rejects.
 LOGOS_TEST(apply_rejects_out_of_range_gossipsub_bounds) {
     for (const char* raw : {R"({"gossipsubQueueMaxBytes": -1})",
+                            R"({"gossipsubQueueTotalMaxBytes": -1})",
                             R"({"gossipsubQueueMaxMessages": "many"})",
                             R"({"gossipsubQueueMaxMessages": 1.5})",
                             R"({"gossipsubMaxMessageSize": -1})",
@@ -325,6 +506,18 @@ LOGOS_TEST(options_defaults) {
     LOGOS_ASSERT_TRUE(opts.gossipsubTriggerSelf);
     LOGOS_ASSERT_EQ(opts.gossipsubQueueMaxMessages, size_t(1024));
     LOGOS_ASSERT_EQ(opts.gossipsubQueueMaxBytes, size_t(4 * 1024 * 1024));
+    LOGOS_ASSERT_EQ(opts.gossipsubQueueTotalMaxBytes, size_t(256 * 1024 * 1024));
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueSpillDir.empty());
+    LOGOS_ASSERT_EQ(opts.gossipsubQueueSpillMaxBytes, size_t(1024 * 1024 * 1024));
+    LOGOS_ASSERT_TRUE(opts.gossipsubQueueBackend == TopicQueues::Backend::Deque);
+    LOGOS_ASSERT_EQ(opts.eventQueueMaxEvents, size_t(0));
+    LOGOS_ASSERT_EQ(opts.eventQueueMaxBytes, size_t(64 * 1024 * 1024));
+    LOGOS_ASSERT_TRUE(opts.eventQueueOverflow == EventQueue::Overflow::DropNewest);
+    LOGOS_ASSERT_TRUE(opts.gossipsubDelivery == TopicDelivery::kBoth);
+    LOGOS_ASSERT_TRUE(opts.gossipsubTopicDelivery.empty());
+    LOGOS_ASSERT_EQ(opts.gossipsubEventBatchMaxMessages, size_t(0));
+    LOGOS_ASSERT_EQ(opts.gossipsubEventBatchMaxBytes, size_t(1024 * 1024));
+    LOGOS_ASSERT_EQ(opts.gossipsubEventBatchLingerMs, int64_t(2));
     LOGOS_ASSERT_EQ(opts.gossipsubMaxMessageSize, int64_t(0));
     LOGOS_ASSERT_EQ(opts.gossipsubOverheadRateLimitBytes, int64_t(0));
     LOGOS_ASSERT_EQ(opts.gossipsubOverheadRateLimitIntervalMs, int64_t(0));
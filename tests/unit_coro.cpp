@@ -0,0 +1,142 @@
+// Coroutine plumbing in isolation: CoroTask, the executors, spawn/blockOn. The
+// libp2p-backed awaitables (CoroNode) are covered in integration_coro.cpp.
+
+#include <logos_test.h>
+#include <coro.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace {
+
+// Stands in for a libp2p op: the "reply" lands on another thread after a
+// delay, and resumes the awaiter through the executor like CoroNode::Op does.
+struct FakeReply {
+    CoroExecutor& executor;
+    int value;
+    std::thread::id repliedOn;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        std::thread([this, h] {
+            std::this_thread::sleep_for(milliseconds(5));
+            repliedOn = std::this_thread::get_id();
+            executor.post(h);
+        }).detach();
+    }
+    int await_resume() const { return value; }
+};
+
+CoroTask<int> addOne(CoroExecutor& ex, int v) {
+    co_return co_await FakeReply{ex, v, {}} + 1;
+}
+
+CoroTask<int> pipeline(CoroExecutor& ex) {
+    int a = co_await addOne(ex, 1);
+    int b = co_await addOne(ex, a);
+    co_return co_await addOne(ex, b);
+}
+
+CoroTask<std::thread::id> resumedOn(CoroExecutor& ex) {
+    co_await FakeReply{ex, 0, {}};
+    co_return std::this_thread::get_id();
+}
+
+}  // namespace
+
+LOGOS_TEST(coro_task_chains_awaited_steps) {
+    InlineExecutor ex;
+    LOGOS_ASSERT_EQ(blockOn(pipeline(ex)), 4);
+}
+
+LOGOS_TEST(coro_worker_executor_resumes_on_its_own_thread) {
+    WorkerExecutor ex;
+    const auto caller = std::this_thread::get_id();
+    const auto on = blockOn(resumedOn(ex));
+    LOGOS_ASSERT_TRUE(on != caller);
+
+    // And keeps doing so for every step of a longer pipeline.
+    LOGOS_ASSERT_EQ(blockOn(pipeline(ex)), 4);
+}
+
+LOGOS_TEST(coro_inline_executor_resumes_on_the_replying_thread) {
+    InlineExecutor ex;
+    const auto caller = std::this_thread::get_id();
+    LOGOS_ASSERT_TRUE(blockOn(resumedOn(ex)) != caller);
+}
+
+LOGOS_TEST(coro_spawn_delivers_the_result_once) {
+    WorkerExecutor ex;
+    std::atomic<int> calls{0};
+    std::atomic<int> result{0};
+    spawn(pipeline(ex), [&](int v) {
+        result = v;
+        ++calls;
+    });
+
+    const auto deadline = steady_clock::now() + seconds(5);
+    while (calls.load() == 0 && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    LOGOS_ASSERT_EQ(calls.load(), 1);
+    LOGOS_ASSERT_EQ(result.load(), 4);
+}
+
+// Many pipelines in flight on one worker, none of them blocking it.
+LOGOS_TEST(coro_many_pipelines_share_one_worker) {
+    constexpr int NUM = 64;
+    WorkerExecutor ex;
+    std::atomic<int> sum{0};
+    std::atomic<int> done{0};
+    for (int i = 0; i < NUM; ++i) {
+        spawn(pipeline(ex), [&](int v) {
+            sum += v;
+            ++done;
+        });
+    }
+
+    const auto deadline = steady_clock::now() + seconds(10);
+    while (done.load() < NUM && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    LOGOS_ASSERT_EQ(done.load(), NUM);
+    LOGOS_ASSERT_EQ(sum.load(), 4 * NUM);
+}
+
+// Callbacks fire in deadline order, a cancelled one never fires, and the
+// destructor drops what is still pending.
+LOGOS_TEST(coro_timer_fires_in_order_and_honours_cancel) {
+    std::mutex mutex;
+    std::vector<int> fired;
+    auto record = [&](int i) {
+        return [&, i] {
+            std::lock_guard<std::mutex> lock(mutex);
+            fired.push_back(i);
+        };
+    };
+    {
+        CoroTimer timer;
+        const auto now = CoroTimer::Clock::now();
+        timer.schedule(now + milliseconds(30), record(3));
+        timer.schedule(now + milliseconds(10), record(1));
+        const auto dropped = timer.schedule(now + milliseconds(20), record(2));
+        timer.schedule(now + seconds(60), record(4));
+        timer.cancel(dropped);
+
+        const auto deadline = steady_clock::now() + seconds(5);
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (fired.size() >= 2 || steady_clock::now() >= deadline) break;
+            }
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+    LOGOS_ASSERT_TRUE((fired == std::vector<int>{1, 3}));
+}
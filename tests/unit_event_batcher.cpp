@@ -0,0 +1,193 @@
+// EventBatcher in isolation (no libp2p context; batches land in a vector).
+
+#include <logos_test.h>
+#include <event_batcher.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+using namespace std::chrono;
+
+namespace {
+
+struct Batches {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::string> got;
+
+    EventBatcher::Flush sink() {
+        return [this](std::string batch) {
+            std::lock_guard<std::mutex> lock(mutex);
+            got.push_back(std::move(batch));
+            cond.notify_all();
+        };
+    }
+
+    bool waitFor(size_t n, milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cond.wait_for(lock, timeout, [&] { return got.size() >= n; });
+    }
+};
+
+std::string event(int i) {
+    return R"({"data":"m)" + std::to_string(i) + R"(","topic":"t"})";
+}
+
+}  // namespace
+
+LOGOS_TEST(event_batcher_refuses_events_until_configured) {
+    Batches batches;
+    EventBatcher batcher(batches.sink());
+    std::string e = event(0);
+    LOGOS_ASSERT_FALSE(batcher.add("t", e));
+    LOGOS_ASSERT_TRUE(e == event(0));  // left alone for the caller to send
+
+    batcher.configure(0, 1024, 2);
+    LOGOS_ASSERT_FALSE(batcher.add("t", e));
+}
+
+// A full batch goes out from the adding thread as one JSON array, in order.
+LOGOS_TEST(event_batcher_flushes_a_full_batch_at_once) {
+    Batches batches;
+    EventBatcher batcher(batches.sink());
+    batcher.configure(3, 1 << 20, 60000);
+
+    for (int i = 0; i < 7; ++i) {
+        std::string e = event(i);
+        LOGOS_ASSERT_TRUE(batcher.add("t", e));
+    }
+    LOGOS_ASSERT_EQ(batches.got.size(), size_t(2));
+    for (size_t b = 0; b < 2; ++b) {
+        const auto arr = nlohmann::json::parse(batches.got[b]);
+        LOGOS_ASSERT_EQ(arr.size(), size_t(3));
+        for (size_t i = 0; i < 3; ++i) {
+            LOGOS_ASSERT_TRUE(arr[i]["data"] == "m" + std::to_string(b * 3 + i));
+        }
+    }
+
+    // stop() sends the remainder without waiting out the linger.
+    batcher.stop();
+    LOGOS_ASSERT_EQ(batches.got.size(), size_t(3));
+    LOGOS_ASSERT_TRUE(batches.got[2] == "[" + event(6) + "]");
+}
+
+LOGOS_TEST(event_batcher_flushes_at_the_byte_limit) {
+    Batches batches;
+    EventBatcher batcher(batches.sink());
+    batcher.configure(1000, 2 * event(0).size() + 2, 60000);
+
+    for (int i = 0; i < 2; ++i) {
+        std::string e = event(i);
+        LOGOS_ASSERT_TRUE(batcher.add("t", e));
+    }
+    LOGOS_ASSERT_EQ(batches.got.size(), size_t(1));
+    LOGOS_ASSERT_TRUE(batches.got[0] == "[" + event(0) + "," + event(1) + "]");
+}
+
+// A quiet topic's batch goes out after the linger, from the timer thread, and
+// each topic is batched on its own.
+LOGOS_TEST(event_batcher_flushes_after_the_linger) {
+    Batches batches;
+    EventBatcher batcher(batches.sink());
+    batcher.configure(1000, 1 << 20, 20);
+
+    const auto start = steady_clock::now();
+    std::string a = event(0);
+    std::string b = event(1);
+    LOGOS_ASSERT_TRUE(batcher.add("a", a));
+    LOGOS_ASSERT_TRUE(batcher.add("b", b));
+    LOGOS_ASSERT_TRUE(batches.waitFor(2, seconds(5)));
+    LOGOS_ASSERT_GE(duration_cast<milliseconds>(steady_clock::now() - start).count(), 20);
+
+    std::lock_guard<std::mutex> lock(batches.mutex);
+    LOGOS_ASSERT_EQ(batches.got.size(), size_t(2));
+    for (const auto& batch : batches.got) {
+        LOGOS_ASSERT_TRUE(batch == "[" + event(0) + "]" || batch == "[" + event(1) + "]");
+    }
+}
+
+// A flush stuck on one topic holds up neither adds nor flushes of another, and
+// the stuck topic's later batches queue behind it in order.
+LOGOS_TEST(event_batcher_slow_flush_blocks_only_its_topic) {
+    Batches batches;
+    std::mutex gate;
+    std::unique_lock<std::mutex> held(gate);
+    auto sink = batches.sink();
+    EventBatcher batcher([&](std::string batch) {
+        if (batch.find(R"("data":"m0")") != std::string::npos) {
+            std::lock_guard<std::mutex> wait(gate);
+        }
+        sink(std::move(batch));
+    });
+    batcher.configure(1, 1 << 20, 60000);
+
+    std::thread slow([&] {
+        std::string e = event(0);
+        batcher.add("a", e);
+    });
+    // Give the slow flush time to start before queueing behind it.
+    std::this_thread::sleep_for(milliseconds(20));
+    for (int i = 1; i < 3; ++i) {
+        std::string e = event(i);
+        LOGOS_ASSERT_TRUE(batcher.add("a", e));
+    }
+    std::string b = event(3);
+    LOGOS_ASSERT_TRUE(batcher.add("b", b));
+    {
+        std::lock_guard<std::mutex> lock(batches.mutex);
+        LOGOS_ASSERT_EQ(batches.got.size(), size_t(1));
+        LOGOS_ASSERT_TRUE(batches.got[0] == "[" + event(3) + "]");
+    }
+
+    held.unlock();
+    slow.join();
+    LOGOS_ASSERT_TRUE(batches.waitFor(4, seconds(5)));
+    for (int i = 0; i < 3; ++i) {
+        LOGOS_ASSERT_TRUE(batches.got[i + 1] == "[" + event(i) + "]");
+    }
+}
+
+// The timer thread takes one batch per topic in turn: a topic that piled up
+// batches behind a slow flush does not hold another topic's lingering batch
+// back until it is empty.
+LOGOS_TEST(event_batcher_timer_rotates_between_topics) {
+    Batches batches;
+    std::mutex gate;
+    std::unique_lock<std::mutex> held(gate);
+    std::atomic<bool> stuck{false};
+    auto sink = batches.sink();
+    EventBatcher batcher([&](std::string batch) {
+        if (batch.find(R"("data":"m0")") != std::string::npos) {
+            stuck = true;
+            std::lock_guard<std::mutex> wait(gate);
+        }
+        sink(std::move(batch));
+    });
+    batcher.configure(2, 1 << 20, 10);
+
+    std::string first = event(0);
+    LOGOS_ASSERT_TRUE(batcher.add("a", first));
+    while (!stuck) std::this_thread::sleep_for(milliseconds(1));
+    // Four full batches queue behind the stuck one without blocking.
+    for (int i = 1; i < 9; ++i) {
+        std::string e = event(i);
+        LOGOS_ASSERT_TRUE(batcher.add("a", e));
+    }
+    std::string b = event(9);
+    LOGOS_ASSERT_TRUE(batcher.add("b", b));
+    std::this_thread::sleep_for(milliseconds(40));
+
+    held.unlock();
+    LOGOS_ASSERT_TRUE(batches.waitFor(6, seconds(5)));
+    LOGOS_ASSERT_TRUE(batches.got[0] == "[" + event(0) + "]");
+    LOGOS_ASSERT_TRUE(batches.got[1] == "[" + event(1) + "," + event(2) + "]");
+    LOGOS_ASSERT_TRUE(batches.got[2] == "[" + event(9) + "]");
+    LOGOS_ASSERT_TRUE(batches.got[5] == "[" + event(7) + "," + event(8) + "]");
+}
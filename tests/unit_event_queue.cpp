@@ -0,0 +1,129 @@
+// EventQueue in isolation (no libp2p context; the consumer is a plain callable).
+
+#include <logos_test.h>
+#include <event_queue.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A consumer that records what it gets and can be held inside a delivery, the
+// way a slow application would hold the dispatcher.
+struct Consumer {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::string> got;
+    std::thread::id thread;
+    bool hold = false;
+    bool inside = false;
+
+    void deliver(const std::string&, const std::string& data) {
+        std::unique_lock<std::mutex> lock(mutex);
+        thread = std::this_thread::get_id();
+        got.push_back(data);
+        inside = true;
+        cond.notify_all();
+        cond.wait(lock, [this] { return !hold; });
+        inside = false;
+    }
+
+    void waitInside() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return inside; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        hold = false;
+        cond.notify_all();
+    }
+};
+
+double droppedFor(const EventQueue& queue, const std::string& reason) {
+    for (const auto& m : queue.metrics()) {
+        if (m.name == "libp2p_module_event_queue_dropped_total" &&
+            m.labels.at("reason") == reason) {
+            return m.value;
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+LOGOS_TEST(event_queue_delivers_inline_until_configured) {
+    Consumer consumer;
+    EventQueue queue([&](const std::string& n, const std::string& d) { consumer.deliver(n, d); });
+    LOGOS_ASSERT_TRUE(queue.post("e", "inline"));
+    LOGOS_ASSERT_TRUE(consumer.thread == std::this_thread::get_id());
+    LOGOS_ASSERT_TRUE(queue.metrics().empty());
+
+    // Either bound at 0 keeps delivery inline.
+    queue.configure(0, 1024, EventQueue::Overflow::DropNewest);
+    LOGOS_ASSERT_TRUE(queue.post("e", "still inline"));
+    LOGOS_ASSERT_EQ(consumer.got.size(), size_t(2));
+}
+
+// A held consumer stalls the dispatcher, not the poster; stop() then delivers
+// the backlog in order before it returns.
+LOGOS_TEST(event_queue_decouples_a_slow_consumer) {
+    Consumer consumer;
+    consumer.hold = true;
+    EventQueue queue([&](const std::string& n, const std::string& d) { consumer.deliver(n, d); });
+    queue.configure(64, 1 << 20, EventQueue::Overflow::DropNewest);
+
+    LOGOS_ASSERT_TRUE(queue.post("e", "0"));
+    consumer.waitInside();
+    for (int i = 1; i <= 10; ++i) LOGOS_ASSERT_TRUE(queue.post("e", std::to_string(i)));
+    LOGOS_ASSERT_EQ(queue.depth(), size_t(10));
+    LOGOS_ASSERT_TRUE(consumer.thread != std::this_thread::get_id());
+
+    consumer.release();
+    queue.stop();
+    LOGOS_ASSERT_EQ(consumer.got.size(), size_t(11));
+    for (int i = 0; i <= 10; ++i) LOGOS_ASSERT_TRUE(consumer.got[i] == std::to_string(i));
+    LOGOS_ASSERT_TRUE(queue.metrics().empty());
+}
+
+LOGOS_TEST(event_queue_drop_newest_keeps_the_oldest_backlog) {
+    Consumer consumer;
+    consumer.hold = true;
+    EventQueue queue([&](const std::string& n, const std::string& d) { consumer.deliver(n, d); });
+    queue.configure(3, 1 << 20, EventQueue::Overflow::DropNewest);
+
+    LOGOS_ASSERT_TRUE(queue.post("e", "held"));
+    consumer.waitInside();
+    for (int i = 0; i < 3; ++i) LOGOS_ASSERT_TRUE(queue.post("e", std::to_string(i)));
+    LOGOS_ASSERT_FALSE(queue.post("e", "3"));
+    LOGOS_ASSERT_EQ(droppedFor(queue, "full"), 1.0);
+
+    consumer.release();
+    queue.stop();
+    LOGOS_ASSERT_TRUE((consumer.got == std::vector<std::string>{"held", "0", "1", "2"}));
+}
+
+LOGOS_TEST(event_queue_drop_oldest_keeps_the_newest_within_both_bounds) {
+    Consumer consumer;
+    consumer.hold = true;
+    EventQueue queue([&](const std::string& n, const std::string& d) { consumer.deliver(n, d); });
+    queue.configure(3, 8, EventQueue::Overflow::DropOldest);
+
+    LOGOS_ASSERT_TRUE(queue.post("e", "held"));
+    consumer.waitInside();
+    for (int i = 0; i < 5; ++i) LOGOS_ASSERT_TRUE(queue.post("e", std::to_string(i)));
+    LOGOS_ASSERT_EQ(droppedFor(queue, "evicted"), 2.0);
+    // Seven bytes takes the room of "2" and "3"; nine never fits.
+    LOGOS_ASSERT_TRUE(queue.post("e", "abcdefg"));
+    LOGOS_ASSERT_FALSE(queue.post("e", "123456789"));
+    LOGOS_ASSERT_EQ(droppedFor(queue, "evicted"), 4.0);
+    LOGOS_ASSERT_EQ(droppedFor(queue, "full"), 1.0);
+
+    consumer.release();
+    queue.stop();
+    LOGOS_ASSERT_TRUE((consumer.got == std::vector<std::string>{"held", "4", "abcdefg"}));
+}
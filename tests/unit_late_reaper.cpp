@@ -0,0 +1,91 @@
+// LateReaper in isolation (no libp2p context; jobs are plain callables).
+
+#include <logos_test.h>
+#include <late_reaper.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono;
+
+namespace {
+bool waitIdle(LateReaper& reaper) {
+    const auto deadline = steady_clock::now() + seconds(5);
+    while (reaper.pending() != 0) {
+        if (steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+}  // namespace
+
+LOGOS_TEST(late_reaper_runs_ownerless_jobs_on_one_thread) {
+    auto& reaper = LateReaper::instance();
+    const uint64_t before = reaper.reclaimedTotal();
+    std::atomic<int> ran{0};
+    std::thread::id first;
+    std::atomic<bool> sameThread{true};
+
+    for (int i = 0; i < 100; ++i) {
+        LOGOS_ASSERT_TRUE(reaper.post(nullptr, [&, i] {
+            if (i == 0) first = std::this_thread::get_id();
+            else if (std::this_thread::get_id() != first) sameThread = false;
+            ++ran;
+        }));
+    }
+    LOGOS_ASSERT_TRUE(waitIdle(reaper));
+    LOGOS_ASSERT_EQ(ran.load(), 100);
+    LOGOS_ASSERT_TRUE(sameThread.load());
+    LOGOS_ASSERT_EQ(reaper.reclaimedTotal(), before + 100);
+}
+
+LOGOS_TEST(late_reaper_drops_jobs_for_an_owner_it_does_not_know) {
+    auto& reaper = LateReaper::instance();
+    int owner = 0;
+    bool ran = false;
+    LOGOS_ASSERT_FALSE(reaper.post(&owner, [&] { ran = true; }));
+
+    reaper.adopt(&owner);
+    LOGOS_ASSERT_TRUE(reaper.post(&owner, [&] { ran = true; }));
+    LOGOS_ASSERT_TRUE(waitIdle(reaper));
+    LOGOS_ASSERT_TRUE(ran);
+    reaper.forget(&owner);
+}
+
+// Forgetting an owner drops its queued jobs and waits out the running one, so
+// the owner can be destroyed right after.
+LOGOS_TEST(late_reaper_forget_drops_queued_and_waits_for_running) {
+    auto& reaper = LateReaper::instance();
+    int owner = 0;
+    reaper.adopt(&owner);
+
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    std::atomic<int> laterRan{0};
+    reaper.post(&owner, [&] {
+        started = true;
+        std::this_thread::sleep_for(milliseconds(50));
+        finished = true;
+    });
+    for (int i = 0; i < 10; ++i) reaper.post(&owner, [&] { ++laterRan; });
+
+    while (!started.load()) std::this_thread::yield();
+    reaper.forget(&owner);
+    LOGOS_ASSERT_TRUE(finished.load());
+    LOGOS_ASSERT_TRUE(waitIdle(reaper));
+    LOGOS_ASSERT_EQ(laterRan.load(), 0);
+    LOGOS_ASSERT_FALSE(reaper.post(&owner, [] {}));
+}
+
+// The thread leaves once idle and comes back for the next job.
+LOGOS_TEST(late_reaper_restarts_after_idling_out) {
+    auto& reaper = LateReaper::instance();
+    std::atomic<int> ran{0};
+    reaper.post(nullptr, [&] { ++ran; });
+    LOGOS_ASSERT_TRUE(waitIdle(reaper));
+    std::this_thread::sleep_for(milliseconds(LateReaper::kIdleMs + 200));
+    reaper.post(nullptr, [&] { ++ran; });
+    LOGOS_ASSERT_TRUE(waitIdle(reaper));
+    LOGOS_ASSERT_EQ(ran.load(), 2);
+}
@@ -1,9 +1,15 @@
-// Pure Metric JSON (de)serialization (no Libp2pModuleImpl, links without libp2p.so).
+// Pure Metric JSON (de)serialization and Histogram (no Libp2pModuleImpl, links
+// without libp2p.so).
 
 #include <logos_test.h>
+#include <histogram.h>
 #include <plugin.h>
 
+#include <cmath>
+#include <limits>
 #include <string>
+#include <thread>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -106,3 +112,100 @@ LOGOS_TEST(metric_array_round_trips_through_payload_shape) {
     LOGOS_ASSERT_TRUE(
         payload["metrics"][1]["labels"]["err"].get<std::string>() == "timeout");
 }
+
+LOGOS_TEST(metric_histogram_round_trips_buckets_sum_and_count) {
+    const auto j = json::parse(R"({
+        "name": "libp2p_dial_seconds", "type": "histogram", "help": "dials",
+        "labels": [], "value": 3,
+        "buckets": [{"le": "0.1", "count": 1}, {"le": 1, "count": 2}, {"le": "+Inf", "count": 3}],
+        "sum": 4.5, "count": 3
+    })");
+    const auto m = j.get<Metric>();
+    LOGOS_ASSERT_EQ(m.buckets.size(), size_t(3));
+    LOGOS_ASSERT_EQ(m.buckets[1].upperBound, 1.0);
+    LOGOS_ASSERT_TRUE(std::isinf(m.buckets[2].upperBound));
+    LOGOS_ASSERT_EQ(m.sum, 4.5);
+    LOGOS_ASSERT_EQ(m.count, uint64_t(3));
+
+    const json out = m;
+    LOGOS_ASSERT_TRUE(out["buckets"][0]["le"].get<std::string>() == "0.1");
+    LOGOS_ASSERT_TRUE(out["buckets"][2]["le"].get<std::string>() == "+Inf");
+    LOGOS_ASSERT_EQ(out["buckets"][2]["count"].get<uint64_t>(), uint64_t(3));
+    LOGOS_ASSERT_EQ(out["sum"].get<double>(), 4.5);
+    LOGOS_ASSERT_EQ(out["count"].get<uint64_t>(), uint64_t(3));
+}
+
+// Bounds past six significant digits keep every digit through a round trip.
+LOGOS_TEST(metric_histogram_bounds_round_trip_exactly) {
+    Metric m;
+    m.name = "libp2p_module_gossipsub_message_bytes";
+    m.type = "histogram";
+    m.buckets = {{1048576, 1}, {1048577, 2}, {0.000123456789, 2},
+                 {std::numeric_limits<double>::infinity(), 3}};
+
+    const json out = m;
+    LOGOS_ASSERT_TRUE(out["buckets"][0]["le"].get<std::string>() == "1048576");
+    const auto back = out.get<Metric>();
+    LOGOS_ASSERT_EQ(back.buckets.size(), m.buckets.size());
+    for (size_t i = 0; i < m.buckets.size(); ++i) {
+        LOGOS_ASSERT_EQ(back.buckets[i].upperBound, m.buckets[i].upperBound);
+    }
+}
+
+LOGOS_TEST(metric_summary_emits_quantiles) {
+    Metric m;
+    m.name = "libp2p_rtt_seconds";
+    m.type = "summary";
+    m.quantiles = {{0.5, 0.02}, {0.99, 0.3}};
+    m.sum = 1.0;
+    m.count = 10;
+    const json j = m;
+    LOGOS_ASSERT_EQ(j["quantiles"].size(), 2u);
+    LOGOS_ASSERT_EQ(j["quantiles"][1]["quantile"].get<double>(), 0.99);
+    LOGOS_ASSERT_FALSE(j.contains("buckets"));
+    LOGOS_ASSERT_EQ(j.get<Metric>().quantiles[0].value, 0.02);
+}
+
+LOGOS_TEST(metric_scalar_emits_no_distribution_fields) {
+    Metric m;
+    m.name = "x";
+    m.type = "gauge";
+    const json j = m;
+    LOGOS_ASSERT_FALSE(j.contains("buckets"));
+    LOGOS_ASSERT_FALSE(j.contains("sum"));
+    LOGOS_ASSERT_FALSE(j.contains("count"));
+}
+
+LOGOS_TEST(histogram_snapshot_is_cumulative_with_inclusive_bounds) {
+    Histogram h({1, 10, 100});
+    h.observe(0.5);
+    h.observe(1);    // on a bound: counts in that bucket, like `le`
+    h.observe(50);
+    h.observe(1000);
+
+    const auto m = h.snapshot("h", "test", {{"op", "x"}});
+    LOGOS_ASSERT_TRUE(m.type == "histogram");
+    LOGOS_ASSERT_EQ(m.buckets.size(), size_t(4));
+    LOGOS_ASSERT_EQ(m.buckets[0].count, uint64_t(2));
+    LOGOS_ASSERT_EQ(m.buckets[1].count, uint64_t(2));
+    LOGOS_ASSERT_EQ(m.buckets[2].count, uint64_t(3));
+    LOGOS_ASSERT_TRUE(std::isinf(m.buckets[3].upperBound));
+    LOGOS_ASSERT_EQ(m.buckets[3].count, uint64_t(4));
+    LOGOS_ASSERT_EQ(m.count, uint64_t(4));
+    LOGOS_ASSERT_EQ(m.value, 4.0);
+    LOGOS_ASSERT_EQ(m.sum, 1051.5);
+}
+
+LOGOS_TEST(histogram_observe_from_many_threads_loses_nothing) {
+    Histogram h(Histogram::exponentialBounds(1, 2, 10));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&h] {
+            for (int i = 0; i < 10000; ++i) h.observe(i % 2000);
+        });
+    }
+    for (auto& t : threads) t.join();
+    const auto m = h.snapshot("h", "test");
+    LOGOS_ASSERT_EQ(m.count, uint64_t(80000));
+    LOGOS_ASSERT_EQ(m.sum, 8.0 * 5.0 * 1999.0 * 1000.0);
+}
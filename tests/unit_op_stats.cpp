@@ -0,0 +1,90 @@
+// OpStats in isolation: series lookup, outcome counting and bucket layout.
+
+#include <logos_test.h>
+#include <op_stats.h>
+
+#include <chrono>
+#include <string>
+
+namespace {
+const Metric* find(const std::vector<Metric>& series, const std::string& name,
+                   const std::string& op, const std::string& key = "", const std::string& val = "") {
+    for (const auto& m : series) {
+        if (m.name != name) continue;
+        auto it = m.labels.find("op");
+        if (it == m.labels.end() || it->second != op) continue;
+        if (!key.empty()) {
+            auto kv = m.labels.find(key);
+            if (kv == m.labels.end() || kv->second != val) continue;
+        }
+        return &m;
+    }
+    return nullptr;
+}
+}  // namespace
+
+LOGOS_TEST(op_stats_names_ops_after_their_error_prefix) {
+    LOGOS_ASSERT_TRUE(OpStats::opName("Failed to dial") == "dial");
+    LOGOS_ASSERT_TRUE(OpStats::opName("Failed to read LP from stream") == "read_lp_from_stream");
+    LOGOS_ASSERT_TRUE(OpStats::opName("kadGetValue") == "kadgetvalue");
+}
+
+LOGOS_TEST(op_stats_same_text_at_two_addresses_shares_a_series) {
+    static const char a[] = "Failed to unit op shared";
+    static const char b[] = "Failed to unit op shared";
+    auto& stats = OpStats::instance();
+    LOGOS_ASSERT_TRUE(&stats.series(a) == &stats.series(b));
+    LOGOS_ASSERT_TRUE(&stats.series(a) != &stats.series("Failed to unit op other"));
+}
+
+LOGOS_TEST(op_stats_counts_outcomes_and_in_flight) {
+    auto& s = OpStats::instance().series("Failed to unit op outcomes");
+    auto first = s.begin();
+    auto second = s.begin();
+    auto third = s.begin();
+
+    auto snapshot = OpStats::instance().metrics();
+    const Metric* inFlight = find(snapshot, "libp2p_module_ops_in_flight", "unit_op_outcomes");
+    LOGOS_ASSERT_TRUE(inFlight != nullptr);
+    LOGOS_ASSERT_EQ(inFlight->value, 3.0);
+
+    s.end(first, OpStats::Outcome::Success);
+    s.end(second, OpStats::Outcome::Failure);
+    s.end(third, OpStats::Outcome::Timeout);
+
+    snapshot = OpStats::instance().metrics();
+    LOGOS_ASSERT_EQ(find(snapshot, "libp2p_module_ops_in_flight", "unit_op_outcomes")->value, 0.0);
+    for (const char* outcome : {"success", "failure", "timeout"}) {
+        const Metric* m = find(snapshot, "libp2p_module_ops_total", "unit_op_outcomes", "outcome", outcome);
+        LOGOS_ASSERT_TRUE(m != nullptr);
+        LOGOS_ASSERT_TRUE(m->type == "counter");
+        LOGOS_ASSERT_EQ(m->value, 1.0);
+    }
+    LOGOS_ASSERT_EQ(find(snapshot, "libp2p_module_op_duration_seconds", "unit_op_outcomes")->count,
+                    uint64_t(3));
+}
+
+LOGOS_TEST(op_stats_latency_is_one_histogram_series_in_seconds) {
+    using namespace std::chrono;
+    auto& s = OpStats::instance().series("Failed to unit op buckets");
+    const auto now = steady_clock::now();
+    s.begin();
+    s.end(now, OpStats::Outcome::Success);                     // well under 1 ms
+    s.begin();
+    s.end(now - milliseconds(30), OpStats::Outcome::Success);  // the 50 ms bucket
+    s.begin();
+    s.end(now - seconds(20), OpStats::Outcome::Timeout);       // past the last bound
+
+    auto snapshot = OpStats::instance().metrics();
+    const Metric* m = find(snapshot, "libp2p_module_op_duration_seconds", "unit_op_buckets");
+    LOGOS_ASSERT_TRUE(m != nullptr);
+    LOGOS_ASSERT_TRUE(m->type == "histogram");
+    LOGOS_ASSERT_EQ(m->buckets.size(), size_t(13));
+    LOGOS_ASSERT_EQ(m->buckets[0].upperBound, 0.001);
+    LOGOS_ASSERT_EQ(m->buckets[0].count, uint64_t(1));
+    LOGOS_ASSERT_EQ(m->buckets[3].count, uint64_t(1));   // le 0.025
+    LOGOS_ASSERT_EQ(m->buckets[4].count, uint64_t(2));   // le 0.05
+    LOGOS_ASSERT_EQ(m->buckets[11].count, uint64_t(2));  // le 10
+    LOGOS_ASSERT_EQ(m->buckets[12].count, uint64_t(3));  // +Inf
+    LOGOS_ASSERT_TRUE(m->sum >= 20.03 && m->sum < 21.0);
+}
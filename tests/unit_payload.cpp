@@ -0,0 +1,179 @@
+// Payload sharing and the copies a delivered gossipsub message costs, counted
+// by a global operator new that tallies large allocations on this thread.
+
+#include <logos_test.h>
+#include <event_batcher.h>
+#include <payload.h>
+#include <pubsub_delivery.h>
+#include <topic_delivery.h>
+#include <topic_queues.h>
+#include <utils.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// Only allocations at least this large count, so the deque's nodes and the
+// shared_ptr control block stay out of the tally.
+thread_local size_t t_countFrom = 0;
+thread_local size_t t_large = 0;
+
+// Tallies allocations of at least `from` bytes on this thread while alive.
+struct CountLarge {
+    explicit CountLarge(size_t from) {
+        t_countFrom = from;
+        t_large = 0;
+    }
+    ~CountLarge() { t_countFrom = 0; }
+    size_t count() const { return t_large; }
+};
+
+}  // namespace
+
+void* operator new(size_t n) {
+    if (t_countFrom != 0 && n >= t_countFrom) ++t_large;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+LOGOS_TEST(payload_take_moves_out_of_the_last_reference_only) {
+    const std::string bytes(4096, 'p');
+    Payload shared = makePayload(bytes);
+    Payload held = shared;
+    LOGOS_ASSERT_TRUE(takePayload(std::move(shared)) == bytes);
+    LOGOS_ASSERT_TRUE(*held == bytes);  // copied, since `held` still reads it
+
+    const char* buffer = held->data();
+    std::string out = takePayload(std::move(held));
+    LOGOS_ASSERT_TRUE(out.data() == buffer);
+}
+
+LOGOS_TEST(pubsub_message_json_matches_json_dump) {
+    for (const std::string data : {std::string(), std::string("plain"),
+                                   std::string("quote\" slash\\ nl\n tab\t \x01"),
+                                   std::string("\x1f\x7f"),
+                                   std::string("\xc3\xa9t\xc3\xa9 \xe2\x9c\x93 \xf0\x9f\x98\x80")}) {
+        nlohmann::json j;
+        j["topic"] = "t/\"x\"";
+        j["data"] = data;
+        LOGOS_ASSERT_TRUE(pubsubMessageJson("t/\"x\"", data) == j.dump());
+    }
+    // Stray bytes, a truncated sequence, an overlong form, a surrogate.
+    for (const std::string bad : {std::string("\xff\xfe"), std::string("ok \xe2\x9c"),
+                                  std::string("\xc0\xaf"), std::string("\xed\xa0\x80")}) {
+        bool threw = false;
+        try {
+            pubsubMessageJson("t", bad);
+        } catch (const nlohmann::json::type_error&) {
+            threw = true;
+        }
+        LOGOS_ASSERT_TRUE(threw);
+    }
+}
+
+LOGOS_TEST(pubsub_message_base64_json_matches_json_dump) {
+    for (const std::string data : {std::string(), std::string("a"), std::string("ab"),
+                                   std::string("\xff\xfe\x00\xc0\xaf", 5),
+                                   std::string(1000, '\x80')}) {
+        nlohmann::json j;
+        j["topic"] = "t/\"x\"";
+        j["data"] = base64Encode(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+        LOGOS_ASSERT_TRUE(pubsubMessageBase64Json("t/\"x\"", data) == j.dump());
+    }
+}
+
+// The gossipsubMessageCbor event decodes to the same keys, with the payload's
+// bytes intact where pubsubMessageJson would throw.
+LOGOS_TEST(pubsub_message_cbor_carries_any_bytes) {
+    for (const std::string data : {std::string(), std::string("plain"),
+                                   std::string("\xff\xfe\x00\xc0\xaf", 5),
+                                   std::string(300, '\x80')}) {
+        const std::string event = pubsubMessageCbor("t/x", data);
+        const auto j = nlohmann::json::from_cbor(event);
+        LOGOS_ASSERT_EQ(j.size(), size_t(2));
+        LOGOS_ASSERT_TRUE(j["topic"] == "t/x");
+        LOGOS_ASSERT_TRUE(j["data"].is_binary());
+        const auto& bytes = j["data"].get_binary();
+        LOGOS_ASSERT_TRUE(std::string(bytes.begin(), bytes.end()) == data);
+    }
+}
+
+namespace {
+
+// Runs one message through PubsubDelivery, the body of onPubsubMessage, on a
+// topic with `mode` and `encoding`, then polls it when it was queued. Returns
+// the payload-sized allocations that took.
+size_t deliveryCopies(TopicDelivery::Mode mode, TopicDelivery::Encoding encoding,
+                      const std::string& wire, std::vector<std::string>& events,
+                      std::string& polled) {
+    TopicDelivery routes;
+    routes.set("t", mode);
+    routes.setEncoding("t", encoding);
+    TopicQueues queues;
+    queues.setBounds(16, 1 << 20);
+    EventBatcher batcher([](std::string) {});
+    events.reserve(1);
+    const PubsubDelivery delivery{routes, queues, batcher, [&](const char*, std::string event) {
+        events.push_back(std::move(event));
+    }};
+
+    CountLarge large(wire.size());
+    delivery.deliver("t", reinterpret_cast<const uint8_t*>(wire.data()), wire.size());
+    if (mode & TopicDelivery::kQueue) queues.pop("t", 0, polled);
+    return large.count();
+}
+
+}  // namespace
+
+// Whatever the route: one copy off the wire, one into the event, none into
+// the queue, and none out of it to the poller.
+LOGOS_TEST(pubsub_delivery_copies_a_payload_at_most_twice) {
+    const std::string wire(1 << 16, 'w');
+    const struct {
+        TopicDelivery::Mode mode;
+        TopicDelivery::Encoding encoding;
+        size_t copies;
+    } cases[] = {
+        {TopicDelivery::kBoth, TopicDelivery::kText, 2},
+        {TopicDelivery::kBoth, TopicDelivery::kBase64, 2},
+        {TopicDelivery::kBoth, TopicDelivery::kCbor, 2},
+        {TopicDelivery::kEvent, TopicDelivery::kText, 2},
+        {TopicDelivery::kQueue, TopicDelivery::kText, 1},
+        {TopicDelivery::kNone, TopicDelivery::kText, 0},
+    };
+    for (const auto& c : cases) {
+        std::vector<std::string> events;
+        std::string polled;
+        LOGOS_ASSERT_EQ(deliveryCopies(c.mode, c.encoding, wire, events, polled), c.copies);
+        LOGOS_ASSERT_EQ(events.size(), size_t((c.mode & TopicDelivery::kEvent) ? 1 : 0));
+        LOGOS_ASSERT_TRUE(polled == ((c.mode & TopicDelivery::kQueue) ? wire : std::string()));
+    }
+
+    // The ring hands the buffer through the same way.
+    TopicQueues ring;
+    ring.setBackend(TopicQueues::Backend::Ring);
+    ring.setBounds(16, 1 << 20);
+    std::string out;
+    size_t delivered;
+    {
+        CountLarge large(wire.size());
+        Payload payload = makePayload(reinterpret_cast<const uint8_t*>(wire.data()), wire.size());
+        LOGOS_ASSERT_TRUE(ring.push("t", std::move(payload)));
+        LOGOS_ASSERT_TRUE(ring.pop("t", 0, out));
+        delivered = large.count();
+    }
+    LOGOS_ASSERT_EQ(delivered, size_t(1));
+}
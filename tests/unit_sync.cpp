@@ -1,33 +1,33 @@
-// Pure sync-over-async primitives: awaitResult / parseJsonResponse.
+// Pure sync-over-async primitives: Completion / awaitResult / parseJsonResponse /
+// the buffer transforms.
 
 #include <logos_test.h>
 #include <plugin.h>
 
+#include <algorithm>
 #include <chrono>
-#include <future>
 #include <thread>
+#include <vector>
 
 using namespace std::chrono;
 
 LOGOS_TEST(await_result_returns_ready_value) {
-    SyncPromise p;
-    auto f = p.get_future();
-    p.set_value({true, "done", {}, nullptr});
+    auto* c = Completion::acquire();
+    c->resolve({true, "done", {}, nullptr});
 
-    auto r = awaitResult(f, 1000);
+    auto r = awaitResult(c, 1000);
     LOGOS_ASSERT_TRUE(r.ok);
     LOGOS_ASSERT_TRUE(r.message == "done");
 }
 
 LOGOS_TEST(await_result_waits_for_late_value) {
-    SyncPromise p;
-    auto f = p.get_future();
-    std::thread setter([&p] {
+    auto* c = Completion::acquire();
+    std::thread setter([c] {
         std::this_thread::sleep_for(milliseconds(20));
-        p.set_value({true, "late", {}, nullptr});
+        c->resolve({true, "late", {}, nullptr});
     });
 
-    auto r = awaitResult(f, 2000);
+    auto r = awaitResult(c, 2000);
     setter.join();
     LOGOS_ASSERT_TRUE(r.ok);
     LOGOS_ASSERT_TRUE(r.message == "late");
@@ -37,11 +37,10 @@ LOGOS_TEST(await_result_waits_for_late_value) {
 // timeout-mismatch pin: callSyncWith hardcodes the default timeout, so a caller's
 // connect timeout never widens (or shortens) the wrapper's actual wait.
 LOGOS_TEST(await_result_times_out_at_its_own_timeout) {
-    SyncPromise p;  // never satisfied
-    auto f = p.get_future();
+    auto* c = Completion::acquire();
 
     auto start = steady_clock::now();
-    auto r = awaitResult(f, 50);
+    auto r = awaitResult(c, 50);
     auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
 
     LOGOS_ASSERT_FALSE(r.ok);
@@ -49,6 +48,102 @@ LOGOS_TEST(await_result_times_out_at_its_own_timeout) {
     // Returns at roughly the requested timeout, not later.
     LOGOS_ASSERT_GE(elapsed, 40);
     LOGOS_ASSERT_LT(elapsed, 2000);
+
+    c->resolve({true, "too late", {}, nullptr});
+}
+
+// A reply landing after the waiter gave up recycles the slot, and hands what it
+// carries to onLate.
+LOGOS_TEST(completion_late_reply_after_timeout_is_reaped) {
+    static int reaped = 0;
+    reaped = 0;
+    const size_t before = Completion::inUse();
+
+    const size_t abandonedBefore = Completion::abandonedPending();
+
+    static int tag = 0;
+    auto* c = Completion::acquire();
+    c->onLate = [](SyncResult&& late, void* arg) {
+        if (late.message == "late ctx" && arg == &tag) ++reaped;
+    };
+    c->lateArg = &tag;
+    LOGOS_ASSERT_EQ(Completion::inUse(), before + 1);
+
+    auto r = awaitResult(c, 10);
+    LOGOS_ASSERT_FALSE(r.ok);
+    LOGOS_ASSERT_EQ(Completion::inUse(), before + 1);
+    LOGOS_ASSERT_EQ(Completion::abandonedPending(), abandonedBefore + 1);
+
+    c->resolve({true, "late ctx", {}, nullptr});
+    LOGOS_ASSERT_EQ(reaped, 1);
+    LOGOS_ASSERT_EQ(Completion::inUse(), before);
+    LOGOS_ASSERT_EQ(Completion::abandonedPending(), abandonedBefore);
+}
+
+// A failed submit reclaims the slot whether or not the callback already ran.
+LOGOS_TEST(completion_cancel_submit_reports_whether_the_reply_ran) {
+    const size_t before = Completion::inUse();
+
+    auto* ran = Completion::acquire();
+    ran->resolve({false, "encode failed", {}, nullptr});
+    LOGOS_ASSERT_TRUE(ran->cancelSubmit());
+
+    auto* silent = Completion::acquire();
+    LOGOS_ASSERT_FALSE(silent->cancelSubmit());
+
+    LOGOS_ASSERT_EQ(Completion::inUse(), before);
+}
+
+LOGOS_TEST(completion_on_reply_runs_on_the_replying_thread) {
+    const size_t before = Completion::inUse();
+    std::thread::id ranOn;
+    std::string seen;
+
+    auto* c = Completion::acquire();
+    c->onReply = [&](SyncResult& r) {
+        ranOn = std::this_thread::get_id();
+        seen = r.message;
+        return true;
+    };
+    c->detach();
+    std::thread replier([c] { c->resolve({true, "async", {}, nullptr}); });
+    const auto replierId = replier.get_id();
+    replier.join();
+
+    LOGOS_ASSERT_TRUE(ranOn == replierId);
+    LOGOS_ASSERT_TRUE(seen == "async");
+    LOGOS_ASSERT_EQ(Completion::inUse(), before);
+}
+
+// An async reply its consumer declines is reclaimed like an abandoned one.
+LOGOS_TEST(completion_declined_async_reply_goes_to_on_late) {
+    static int reaped = 0;
+    reaped = 0;
+    const size_t before = Completion::inUse();
+
+    auto* c = Completion::acquire();
+    c->onReply = [](SyncResult&) { return false; };
+    c->onLate = [](SyncResult&& late, void*) {
+        if (late.message == "stream 7") ++reaped;
+    };
+    c->detach();
+    c->resolve({true, "stream 7", {}, nullptr});
+
+    LOGOS_ASSERT_EQ(reaped, 1);
+    LOGOS_ASSERT_EQ(Completion::inUse(), before);
+}
+
+// Slots go back to the pool, so a steady stream of ops does not accumulate any.
+LOGOS_TEST(completion_slots_are_recycled) {
+    const size_t before = Completion::inUse();
+    for (int i = 0; i < 10000; ++i) {
+        auto* c = Completion::acquire();
+        std::thread replier([c] { c->resolve({true, {}, {}, nullptr}); });
+        auto r = awaitResult(c, 1000);
+        replier.join();
+        LOGOS_ASSERT_TRUE(r.ok);
+    }
+    LOGOS_ASSERT_EQ(Completion::inUse(), before);
 }
 
 LOGOS_TEST(parse_json_response_valid) {
@@ -69,3 +164,40 @@ LOGOS_TEST(parse_json_response_empty_fails) {
     LOGOS_ASSERT_FALSE(r.success);
     LOGOS_ASSERT_TRUE(r.error == "peerInfo: invalid JSON");
 }
+
+LOGOS_TEST(cbor_byte_string_uses_the_shortest_head) {
+    const std::vector<uint8_t> data(70000, 0xab);
+    struct Case {
+        size_t len;
+        std::vector<uint8_t> head;
+    };
+    const Case cases[] = {
+        {0, {0x40}},
+        {23, {0x57}},
+        {24, {0x58, 24}},
+        {255, {0x58, 0xff}},
+        {256, {0x59, 0x01, 0x00}},
+        {65536, {0x5a, 0x00, 0x01, 0x00, 0x00}},
+    };
+    for (const auto& c : cases) {
+        const auto out = cborByteString(data.data(), c.len);
+        LOGOS_ASSERT_EQ(out.size(), c.head.size() + c.len);
+        LOGOS_ASSERT_TRUE(std::equal(c.head.begin(), c.head.end(), out.begin()));
+        // nlohmann's own decoder agrees on every length.
+        const auto back = nlohmann::json::from_cbor(out);
+        LOGOS_ASSERT_TRUE(back.is_binary());
+        LOGOS_ASSERT_EQ(back.get_binary().size(), c.len);
+    }
+}
+
+LOGOS_TEST(buffer_to_cbor_result_carries_raw_bytes) {
+    SyncResult r;
+    r.ok = true;
+    r.buffer = {0x00, 0xff, 0x10, 0x80};
+    const auto res = bufferToCborResult(r);
+    LOGOS_ASSERT_TRUE(res.success);
+    LOGOS_ASSERT_TRUE(res.value.is_binary());
+    const auto payload = nlohmann::json::from_cbor(res.value.get_binary());
+    LOGOS_ASSERT_TRUE(std::vector<uint8_t>(payload.get_binary()) == r.buffer);
+    LOGOS_ASSERT_TRUE(bufferTransform(BytesFormat::Base64)(r).value == base64Encode(r.buffer));
+}
@@ -0,0 +1,79 @@
+// TopicDelivery in isolation.
+
+#include <logos_test.h>
+#include <topic_delivery.h>
+
+#include <string>
+
+LOGOS_TEST(topic_delivery_parses_every_mode_and_nothing_else) {
+    TopicDelivery::Mode mode;
+    LOGOS_ASSERT_TRUE(TopicDelivery::parse("both", mode) && mode == TopicDelivery::kBoth);
+    LOGOS_ASSERT_TRUE(TopicDelivery::parse("event", mode) && mode == TopicDelivery::kEvent);
+    LOGOS_ASSERT_TRUE(TopicDelivery::parse("queue", mode) && mode == TopicDelivery::kQueue);
+    LOGOS_ASSERT_TRUE(TopicDelivery::parse("none", mode) && mode == TopicDelivery::kNone);
+    LOGOS_ASSERT_FALSE(TopicDelivery::parse("Both", mode));
+    LOGOS_ASSERT_FALSE(TopicDelivery::parse("", mode));
+}
+
+LOGOS_TEST(topic_delivery_topic_mode_overrides_the_default) {
+    TopicDelivery delivery;
+    LOGOS_ASSERT_TRUE(delivery.forTopic("t") == TopicDelivery::kBoth);
+
+    delivery.setDefault(TopicDelivery::kQueue);
+    delivery.set("events", TopicDelivery::kEvent);
+    LOGOS_ASSERT_TRUE(delivery.forTopic("t") == TopicDelivery::kQueue);
+    LOGOS_ASSERT_TRUE(delivery.forTopic("events") == TopicDelivery::kEvent);
+
+    LOGOS_ASSERT_TRUE(delivery.clear("events"));
+    LOGOS_ASSERT_FALSE(delivery.clear("events"));
+    LOGOS_ASSERT_TRUE(delivery.forTopic("events") == TopicDelivery::kQueue);
+}
+
+// Replacing the modes drops the ones left out, as a second config does, and
+// leaves every encoding alone.
+LOGOS_TEST(topic_delivery_set_modes_replaces_every_topic_mode) {
+    TopicDelivery delivery;
+    delivery.setModes({{"a", TopicDelivery::kEvent}, {"b", TopicDelivery::kNone}});
+    delivery.setEncoding("b", TopicDelivery::kCbor);
+
+    delivery.setModes({{"c", TopicDelivery::kQueue}});
+    LOGOS_ASSERT_TRUE(delivery.forTopic("a") == TopicDelivery::kBoth);
+    LOGOS_ASSERT_TRUE(delivery.forTopic("c") == TopicDelivery::kQueue);
+    auto route = delivery.routeFor("b");
+    LOGOS_ASSERT_TRUE(route.mode == TopicDelivery::kBoth && route.encoding == TopicDelivery::kCbor);
+
+    delivery.setModes({});
+    LOGOS_ASSERT_TRUE(delivery.forTopic("c") == TopicDelivery::kBoth);
+    LOGOS_ASSERT_FALSE(delivery.clear("b"));
+}
+
+LOGOS_TEST(topic_delivery_parses_every_encoding_and_nothing_else) {
+    TopicDelivery::Encoding encoding;
+    LOGOS_ASSERT_TRUE(TopicDelivery::parseEncoding("text", encoding) && encoding == TopicDelivery::kText);
+    LOGOS_ASSERT_TRUE(TopicDelivery::parseEncoding("base64", encoding) &&
+                      encoding == TopicDelivery::kBase64);
+    LOGOS_ASSERT_TRUE(TopicDelivery::parseEncoding("cbor", encoding) && encoding == TopicDelivery::kCbor);
+    LOGOS_ASSERT_FALSE(TopicDelivery::parseEncoding("binary", encoding));
+}
+
+// A topic's encoding and mode are kept apart: clearing one leaves the other.
+LOGOS_TEST(topic_delivery_encoding_lives_beside_the_mode) {
+    TopicDelivery delivery;
+    LOGOS_ASSERT_TRUE(delivery.routeFor("t").encoding == TopicDelivery::kText);
+
+    delivery.setEncoding("t", TopicDelivery::kCbor);
+    delivery.set("t", TopicDelivery::kQueue);
+    auto route = delivery.routeFor("t");
+    LOGOS_ASSERT_TRUE(route.mode == TopicDelivery::kQueue && route.encoding == TopicDelivery::kCbor);
+
+    LOGOS_ASSERT_TRUE(delivery.clear("t"));
+    LOGOS_ASSERT_FALSE(delivery.clear("t"));
+    delivery.setDefault(TopicDelivery::kEvent);
+    route = delivery.routeFor("t");
+    LOGOS_ASSERT_TRUE(route.mode == TopicDelivery::kEvent && route.encoding == TopicDelivery::kCbor);
+
+    delivery.setEncoding("t", TopicDelivery::kText);
+    delivery.setEncoding("never-set", TopicDelivery::kText);
+    route = delivery.routeFor("t");
+    LOGOS_ASSERT_TRUE(route.mode == TopicDelivery::kEvent && route.encoding == TopicDelivery::kText);
+}
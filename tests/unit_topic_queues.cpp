@@ -1,9 +1,18 @@
 // TopicQueues bounds in isolation (no Libp2pModuleImpl, links without libp2p.so).
 
 #include <logos_test.h>
+#include <spill_log.h>
 #include <topic_queues.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 LOGOS_TEST(topic_queues_drops_newest_over_message_bound) {
     TopicQueues queues;
@@ -73,6 +82,106 @@ LOGOS_TEST(topic_queues_bounds_are_per_topic) {
     LOGOS_ASSERT_TRUE(queues.push("b", "first"));
 }
 
+// A topic's own override wins over any prefix, and a longer prefix over a
+// shorter one; everything else keeps the defaults.
+LOGOS_TEST(topic_queues_topic_bounds_resolve_name_then_longest_prefix) {
+    TopicQueues queues;
+    queues.setBounds(1, 4096);
+    queues.setTopicBounds("chat/*", {2, 4096});
+    queues.setTopicBounds("chat/ops/*", {3, 4096});
+    queues.setTopicBounds("chat/ops/pager", {4, 4096});
+
+    auto accepted = [&](const std::string& topic) {
+        size_t n = 0;
+        while (n < 8 && queues.push(topic, "m")) ++n;
+        return n;
+    };
+    LOGOS_ASSERT_EQ(accepted("blocks"), size_t(1));
+    LOGOS_ASSERT_EQ(accepted("chat/general"), size_t(2));
+    LOGOS_ASSERT_EQ(accepted("chat/ops/alerts"), size_t(3));
+    LOGOS_ASSERT_EQ(accepted("chat/ops/pager"), size_t(4));
+    // The prefix is literal, not a path segment.
+    LOGOS_ASSERT_EQ(accepted("chatter"), size_t(1));
+}
+
+LOGOS_TEST(topic_queues_topic_bounds_apply_to_existing_topics) {
+    TopicQueues queues;
+    queues.setBounds(2, 4096);
+    LOGOS_ASSERT_TRUE(queues.push("t", "one"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "two"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "three"));
+
+    queues.setTopicBounds("t", {3, 4096});
+    LOGOS_ASSERT_TRUE(queues.push("t", "three"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "four"));
+
+    // Shrinking keeps what is queued and refuses until the topic drains.
+    queues.setTopicBounds("t", {1, 4096});
+    LOGOS_ASSERT_FALSE(queues.push("t", "four"));
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_FALSE(queues.push("t", "four"));
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(out == "three");
+    LOGOS_ASSERT_TRUE(queues.push("t", "four"));
+
+    LOGOS_ASSERT_TRUE(queues.clearTopicBounds("t"));
+    LOGOS_ASSERT_FALSE(queues.clearTopicBounds("t"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "five"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "six"));
+}
+
+// Replacing the overrides drops the ones left out, as a second config does.
+LOGOS_TEST(topic_queues_topic_bounds_replace_drops_stale_patterns) {
+    TopicQueues queues;
+    queues.setBounds(2, 4096);
+    queues.setTopicBounds({{"a", {1, 4096}}, {"b/*", {1, 4096}}});
+    LOGOS_ASSERT_TRUE(queues.push("a", "one"));
+    LOGOS_ASSERT_FALSE(queues.push("a", "two"));
+
+    queues.setTopicBounds({{"b/*", {3, 4096}}});
+    LOGOS_ASSERT_TRUE(queues.push("a", "two"));
+    LOGOS_ASSERT_FALSE(queues.push("a", "three"));
+    for (const char* m : {"one", "two", "three"}) LOGOS_ASSERT_TRUE(queues.push("b/x", m));
+    LOGOS_ASSERT_FALSE(queues.push("b/x", "four"));
+}
+
+// A topic whose override disables its backlog never gets an entry, while the
+// others keep theirs.
+LOGOS_TEST(topic_queues_topic_bounds_can_disable_one_topic) {
+    TopicQueues queues;
+    queues.setBounds(1024, 4096);
+    queues.setTopicBounds("noisy/*", {0, 0});
+
+    LOGOS_ASSERT_FALSE(queues.push("noisy/a", "dropped"));
+    LOGOS_ASSERT_EQ(queues.topicCount(), size_t(0));
+    LOGOS_ASSERT_TRUE(queues.push("quiet", "kept"));
+    LOGOS_ASSERT_EQ(queues.topicCount(), size_t(1));
+}
+
+// A ring keeps the cells it was created with, so only the message bound below
+// its capacity moves.
+LOGOS_TEST(topic_queues_topic_bounds_within_ring_capacity) {
+    TopicQueues queues;
+    queues.setBackend(TopicQueues::Backend::Ring);
+    queues.setBounds(4, 4096);
+    for (int i = 0; i < 4; ++i) LOGOS_ASSERT_TRUE(queues.push("t", "m"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "m"));
+
+    std::string out;
+    for (int i = 0; i < 4; ++i) LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    queues.setTopicBounds("t", {2, 4096});
+    LOGOS_ASSERT_TRUE(queues.push("t", "m"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "m"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "m"));
+
+    queues.setTopicBounds("t", {64, 4096});
+    LOGOS_ASSERT_TRUE(queues.push("t", "m"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "m"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "m"));
+}
+
 // A node that cycles topics must not grow a map entry and two metric series per
 // topic it ever subscribed to, so an entry that counted no drop is erased.
 LOGOS_TEST(topic_queues_release_forgets_a_topic_that_dropped_nothing) {
@@ -85,7 +194,10 @@ LOGOS_TEST(topic_queues_release_forgets_a_topic_that_dropped_nothing) {
         queues.release(topic);
     }
     LOGOS_ASSERT_EQ(queues.topicCount(), size_t(0));
-    LOGOS_ASSERT_TRUE(queues.metrics().empty());
+    // Only the node-wide message size histogram and queued-bytes gauge are left.
+    const auto series = queues.metrics();
+    LOGOS_ASSERT_EQ(series.size(), size_t(2));
+    for (const auto& m : series) LOGOS_ASSERT_TRUE(m.labels.count("topic") == 0);
 }
 
 LOGOS_TEST(topic_queues_release_all_forgets_topics_that_dropped_nothing) {
@@ -121,3 +233,844 @@ LOGOS_TEST(topic_queues_release_frees_payloads_and_keeps_the_drop_counter) {
     LOGOS_ASSERT_EQ(depth, 0.0);
     LOGOS_ASSERT_EQ(dropped, 1.0);
 }
+
+LOGOS_TEST(topic_queues_histogram_counts_offered_message_sizes) {
+    TopicQueues queues;
+    queues.setBounds(1, 1 << 20);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", std::string(10, 'x')));
+    LOGOS_ASSERT_FALSE(queues.push("t", std::string(5000, 'x')));  // dropped, still offered
+
+    const Metric* sizes = nullptr;
+    const auto series = queues.metrics();
+    for (const auto& m : series) {
+        if (m.name == "libp2p_module_gossipsub_message_bytes") sizes = &m;
+    }
+    LOGOS_ASSERT_TRUE(sizes != nullptr);
+    LOGOS_ASSERT_TRUE(sizes->type == "histogram");
+    LOGOS_ASSERT_EQ(sizes->count, uint64_t(2));
+    LOGOS_ASSERT_EQ(sizes->sum, 5010.0);
+    LOGOS_ASSERT_EQ(sizes->buckets.front().upperBound, 64.0);
+    LOGOS_ASSERT_EQ(sizes->buckets.front().count, uint64_t(1));
+    LOGOS_ASSERT_EQ(sizes->buckets.back().count, uint64_t(2));
+}
+
+LOGOS_TEST(topic_queues_waiter_is_woken_by_its_own_topic_only) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+
+    std::atomic<bool> got{false};
+    std::string out;
+    std::thread waiter([&] { got = queues.pop("a", 5000, out); });
+
+    for (int i = 0; i < 100; ++i) LOGOS_ASSERT_TRUE(queues.push("b", "other"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    LOGOS_ASSERT_FALSE(got.load());
+
+    LOGOS_ASSERT_TRUE(queues.push("a", "mine"));
+    waiter.join();
+    LOGOS_ASSERT_TRUE(got.load());
+    LOGOS_ASSERT_TRUE(out == "mine");
+}
+
+// A timed-out wait on a topic nothing was ever pushed to leaves no entry.
+LOGOS_TEST(topic_queues_waiting_on_an_unknown_topic_leaves_no_entry) {
+    TopicQueues queues;
+    std::string out;
+    LOGOS_ASSERT_FALSE(queues.pop("ghost", 10, out));
+    LOGOS_ASSERT_FALSE(queues.pop("ghost", 0, out));
+    LOGOS_ASSERT_EQ(queues.topicCount(), size_t(0));
+}
+
+// release() unlinks the entry a waiter sleeps on; the waiter follows the topic
+// to its next entry instead of sleeping on the old one until its timeout.
+LOGOS_TEST(topic_queues_waiter_survives_a_release_of_its_topic) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+    LOGOS_ASSERT_TRUE(queues.push("t", "before"));
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+
+    std::atomic<bool> got{false};
+    std::string late;
+    std::thread waiter([&] { got = queues.pop("t", 5000, late); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queues.release("t");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    LOGOS_ASSERT_TRUE(queues.push("t", "after"));
+    waiter.join();
+    LOGOS_ASSERT_TRUE(got.load());
+    LOGOS_ASSERT_TRUE(late == "after");
+}
+
+LOGOS_TEST(topic_queues_consumers_per_topic_get_every_message_once) {
+    constexpr int kTopics = 8;
+    constexpr int kPerTopic = 2000;
+    TopicQueues queues;
+    queues.setBounds(kPerTopic, 1 << 24);
+
+    std::atomic<int> received{0};
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < kTopics; ++t) {
+        for (int c = 0; c < 2; ++c) {
+            consumers.emplace_back([&, t] {
+                std::string out;
+                while (queues.pop("topic-" + std::to_string(t), 200, out)) ++received;
+            });
+        }
+    }
+    std::thread producer([&] {
+        for (int i = 0; i < kPerTopic; ++i) {
+            for (int t = 0; t < kTopics; ++t) queues.push("topic-" + std::to_string(t), "m");
+        }
+    });
+    producer.join();
+    for (auto& c : consumers) c.join();
+    LOGOS_ASSERT_EQ(received.load(), kTopics * kPerTopic);
+}
+
+LOGOS_TEST(message_ring_is_fifo_and_bounded_by_its_capacity) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t0 = Clock::now();
+    const auto at = [&](int i) { return t0 + std::chrono::milliseconds(i); };
+    MessageRing ring(3);
+    LOGOS_ASSERT_EQ(ring.capacity(), size_t(4));
+    Clock::time_point queuedAt;
+    LOGOS_ASSERT_FALSE(ring.oldest(queuedAt));
+    for (int i = 0; i < 4; ++i) LOGOS_ASSERT_TRUE(ring.tryPush(makePayload(std::to_string(i)), at(i)));
+    Payload extra = makePayload("x");
+    LOGOS_ASSERT_FALSE(ring.tryPush(std::move(extra), t0));
+    LOGOS_ASSERT_TRUE(extra != nullptr);  // refused, so left alone
+
+    // Twice round, so the second lap reuses cells the first one freed.
+    Payload out;
+    for (int lap = 0; lap < 2; ++lap) {
+        for (int i = 0; i < 4; ++i) {
+            const int n = lap * 4 + i;
+            LOGOS_ASSERT_TRUE(ring.oldest(queuedAt) && queuedAt == at(n));
+            LOGOS_ASSERT_TRUE(ring.tryPop(out, queuedAt));
+            LOGOS_ASSERT_TRUE(*out == std::to_string(n));
+            LOGOS_ASSERT_TRUE(queuedAt == at(n));
+            LOGOS_ASSERT_TRUE(ring.tryPush(makePayload(std::to_string(n + 4)), at(n + 4)));
+        }
+    }
+    for (int i = 0; i < 4; ++i) LOGOS_ASSERT_TRUE(ring.tryPop(out, queuedAt));
+    LOGOS_ASSERT_FALSE(ring.tryPop(out, queuedAt));
+    LOGOS_ASSERT_FALSE(ring.oldest(queuedAt));
+}
+
+// The ring rounds its capacity up, but the message bound is still exact, and
+// the byte bound and drop counter behave as on the deque.
+LOGOS_TEST(topic_queues_ring_backend_keeps_both_bounds) {
+    TopicQueues queues;
+    queues.setBackend(TopicQueues::Backend::Ring);
+    queues.setBounds(3, 12);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", "one"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "two"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "six"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "t"));
+
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(out == "one");
+    LOGOS_ASSERT_FALSE(queues.push("t", std::string(7, 'b')));
+    LOGOS_ASSERT_TRUE(queues.push("t", std::string(6, 'c')));
+
+    double dropped = -1;
+    for (const auto& m : queues.metrics()) {
+        if (m.name == "libp2p_module_gossipsub_queue_dropped_total") dropped = m.value;
+    }
+    LOGOS_ASSERT_EQ(dropped, 2.0);
+
+    queues.release("t");
+    LOGOS_ASSERT_FALSE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(queues.push("t", "again"));
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(out == "again");
+}
+
+LOGOS_TEST(topic_queues_ring_backend_delivers_every_message_once) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 5000;
+    TopicQueues queues;
+    queues.setBackend(TopicQueues::Backend::Ring);
+    queues.setBounds(64, 1 << 20);
+
+    std::atomic<int> received{0};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < 3; ++c) {
+        threads.emplace_back([&] {
+            std::string out;
+            while (queues.pop("t", 200, out)) {
+                ++received;
+                sum += std::stoll(out);
+            }
+        });
+    }
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                const std::string m = std::to_string(p * kPerProducer + i);
+                // A full ring drops, so retry the way a slow consumer would see it.
+                while (!queues.push("t", m)) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    const long long n = kProducers * kPerProducer;
+    LOGOS_ASSERT_EQ(received.load(), int(n));
+    LOGOS_ASSERT_EQ(sum.load(), n * (n - 1) / 2);
+}
+
+LOGOS_TEST(topic_queues_pop_many_stops_at_either_limit) {
+    for (auto backend : {TopicQueues::Backend::Deque, TopicQueues::Backend::Ring}) {
+        TopicQueues queues;
+        queues.setBackend(backend);
+        queues.setBounds(1024, 1 << 20);
+        for (int i = 0; i < 6; ++i) LOGOS_ASSERT_TRUE(queues.push("t", std::string(4, 'a' + i)));
+
+        std::vector<std::string> out;
+        LOGOS_ASSERT_EQ(queues.popMany("t", 0, 2, 0, out), size_t(2));
+        LOGOS_ASSERT_TRUE(out[0] == "aaaa" && out[1] == "bbbb");
+
+        // 10 bytes fit two 4-byte messages; the third stays queued.
+        LOGOS_ASSERT_EQ(queues.popMany("t", 0, 100, 10, out), size_t(2));
+        LOGOS_ASSERT_TRUE(out[2] == "cccc" && out[3] == "dddd");
+
+        LOGOS_ASSERT_EQ(queues.popMany("t", 0, 100, 0, out), size_t(2));
+        LOGOS_ASSERT_TRUE(out[5] == "ffff");
+        LOGOS_ASSERT_EQ(queues.popMany("t", 0, 100, 0, out), size_t(0));
+        LOGOS_ASSERT_EQ(queues.popMany("t", 0, 0, 0, out), size_t(0));
+    }
+}
+
+// A first message over the byte limit still comes out, or it would block the
+// topic for every later call with the same limit.
+LOGOS_TEST(topic_queues_pop_many_returns_an_oversized_first_message) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+    LOGOS_ASSERT_TRUE(queues.push("t", std::string(64, 'x')));
+    LOGOS_ASSERT_TRUE(queues.push("t", "y"));
+
+    std::vector<std::string> out;
+    LOGOS_ASSERT_EQ(queues.popMany("t", 0, 10, 16, out), size_t(1));
+    LOGOS_ASSERT_EQ(out[0].size(), size_t(64));
+    LOGOS_ASSERT_EQ(queues.popMany("t", 0, 10, 16, out), size_t(1));
+    LOGOS_ASSERT_TRUE(out[1] == "y");
+}
+
+LOGOS_TEST(topic_queues_pop_many_waits_for_the_first_message_only) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+
+    std::vector<std::string> out;
+    std::thread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queues.push("t", "late");
+    });
+    const auto start = std::chrono::steady_clock::now();
+    LOGOS_ASSERT_EQ(queues.popMany("t", 5000, 10, 0, out), size_t(1));
+    LOGOS_ASSERT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+    LOGOS_ASSERT_TRUE(out[0] == "late");
+    producer.join();
+}
+
+LOGOS_TEST(topic_queues_pop_any_wakes_on_any_listed_topic) {
+    for (auto backend : {TopicQueues::Backend::Deque, TopicQueues::Backend::Ring}) {
+        TopicQueues queues;
+        queues.setBackend(backend);
+        queues.setBounds(1024, 1 << 20);
+
+        std::string topic;
+        std::string out;
+        bool got = false;
+        std::thread waiter([&] { got = queues.popAny({"a", "b", "c"}, 5000, topic, out); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        LOGOS_ASSERT_TRUE(queues.push("x", "unwatched"));
+        LOGOS_ASSERT_TRUE(queues.push("c", "on c"));
+        waiter.join();
+        LOGOS_ASSERT_TRUE(got);
+        LOGOS_ASSERT_TRUE(topic == "c" && out == "on c");
+    }
+}
+
+// A topic that always has a message still leaves room for the others: every
+// listed topic is served within one pass over the list.
+LOGOS_TEST(topic_queues_pop_any_rotates_between_busy_topics) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+    for (int i = 0; i < 100; ++i) LOGOS_ASSERT_TRUE(queues.push("hot", "h"));
+    LOGOS_ASSERT_TRUE(queues.push("cold1", "c1"));
+    LOGOS_ASSERT_TRUE(queues.push("cold2", "c2"));
+
+    const std::vector<std::string> topics = {"hot", "cold1", "cold2"};
+    std::set<std::string> served;
+    std::string topic;
+    std::string out;
+    for (int i = 0; i < 3; ++i) {
+        LOGOS_ASSERT_TRUE(queues.popAny(topics, 0, topic, out));
+        served.insert(topic);
+    }
+    LOGOS_ASSERT_EQ(served.size(), size_t(3));
+}
+
+LOGOS_TEST(topic_queues_pop_any_times_out_and_leaves_no_entries) {
+    TopicQueues queues;
+    std::string topic;
+    std::string out;
+    LOGOS_ASSERT_FALSE(queues.popAny({"a", "b"}, 20, topic, out));
+    LOGOS_ASSERT_FALSE(queues.popAny({"a", "b"}, 0, topic, out));
+    LOGOS_ASSERT_FALSE(queues.popAny({}, 0, topic, out));
+    LOGOS_ASSERT_EQ(queues.topicCount(), size_t(0));
+}
+
+// release() replaces the entry a selector watches; it follows the topic.
+LOGOS_TEST(topic_queues_pop_any_survives_a_release_of_a_watched_topic) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+
+    std::string topic;
+    std::string out;
+    bool got = false;
+    std::thread waiter([&] { got = queues.popAny({"a", "b"}, 5000, topic, out); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queues.release("a");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    LOGOS_ASSERT_TRUE(queues.push("a", "after"));
+    waiter.join();
+    LOGOS_ASSERT_TRUE(got);
+    LOGOS_ASSERT_TRUE(topic == "a" && out == "after");
+}
+
+namespace {
+
+// The drop counter for one reason, or -1 when it has no series.
+double droppedFor(const TopicQueues& queues, const std::string& topic, const std::string& reason) {
+    for (const auto& m : queues.metrics()) {
+        if (m.name != "libp2p_module_gossipsub_queue_dropped_total") continue;
+        if (m.labels.at("topic") == topic && m.labels.at("reason") == reason) return m.value;
+    }
+    return -1;
+}
+
+TopicQueues::Policy policyOf(TopicQueues::Overflow overflow, int64_t ttlMs = 0) {
+    TopicQueues::Policy p;
+    p.overflow = overflow;
+    p.ttlMs = ttlMs;
+    return p;
+}
+
+}  // namespace
+
+LOGOS_TEST(topic_queues_drop_oldest_keeps_the_freshest_messages) {
+    for (auto backend : {TopicQueues::Backend::Deque, TopicQueues::Backend::Ring}) {
+        TopicQueues queues;
+        queues.setBackend(backend);
+        queues.setPolicy(policyOf(TopicQueues::Overflow::DropOldest));
+        queues.setBounds(2, 4096);
+
+        for (const char* m : {"one", "two", "three", "four"}) LOGOS_ASSERT_TRUE(queues.push("t", m));
+        std::string out;
+        LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+        LOGOS_ASSERT_TRUE(out == "three");
+        LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+        LOGOS_ASSERT_TRUE(out == "four");
+        LOGOS_ASSERT_EQ(droppedFor(queues, "t", "evicted"), 2.0);
+        LOGOS_ASSERT_EQ(droppedFor(queues, "t", "full"), 0.0);
+
+        // Evicting everything still leaves no room for a payload over the bound.
+        LOGOS_ASSERT_FALSE(queues.push("t", std::string(5000, 'x')));
+        LOGOS_ASSERT_EQ(droppedFor(queues, "t", "full"), 1.0);
+    }
+}
+
+LOGOS_TEST(topic_queues_ttl_expires_old_messages) {
+    TopicQueues queues;
+    queues.setPolicy(policyOf(TopicQueues::Overflow::DropNewest, 20));
+    queues.setBounds(1024, 4096);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", "stale"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    LOGOS_ASSERT_TRUE(queues.push("t", "fresh"));
+
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(out == "fresh");
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "expired"), 1.0);
+    LOGOS_ASSERT_FALSE(queues.pop("t", 0, out));
+}
+
+// Expired messages free their room for the next push, even under DropNewest.
+LOGOS_TEST(topic_queues_ttl_makes_room_before_the_bounds_apply) {
+    TopicQueues queues;
+    queues.setPolicy(policyOf(TopicQueues::Overflow::DropNewest, 20));
+    queues.setBounds(1, 4096);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", "stale"));
+    LOGOS_ASSERT_FALSE(queues.push("t", "too soon"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    LOGOS_ASSERT_TRUE(queues.push("t", "fresh"));
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "full"), 1.0);
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "expired"), 1.0);
+}
+
+LOGOS_TEST(topic_queues_keep_latest_holds_one_message_per_key) {
+    TopicQueues queues;
+    queues.setPolicy(policyOf(TopicQueues::Overflow::KeepLatest));
+    queues.setBounds(1024, 4096);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", "a:1"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "b:1"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "a:2"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "no key"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "no key"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "a:3"));
+
+    std::vector<std::string> out;
+    LOGOS_ASSERT_EQ(queues.popMany("t", 0, 100, 0, out), size_t(4));
+    LOGOS_ASSERT_TRUE(out[0] == "b:1" && out[1] == "no key" && out[2] == "no key" &&
+                      out[3] == "a:3");
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "superseded"), 2.0);
+
+    // The key is forgotten once taken, so it starts afresh.
+    LOGOS_ASSERT_TRUE(queues.push("t", "a:4"));
+    std::string one;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, one));
+    LOGOS_ASSERT_TRUE(one == "a:4");
+}
+
+// One hot key rewritten without a reader must not grow the queue.
+LOGOS_TEST(topic_queues_keep_latest_sweeps_superseded_entries) {
+    TopicQueues queues;
+    queues.setPolicy(policyOf(TopicQueues::Overflow::KeepLatest));
+    queues.setBounds(4, 1 << 20);
+
+    for (int i = 0; i < 10000; ++i) {
+        LOGOS_ASSERT_TRUE(queues.push("t", "hot:" + std::to_string(i)));
+    }
+    LOGOS_ASSERT_TRUE(queues.push("t", "cold:0"));
+    std::vector<std::string> out;
+    LOGOS_ASSERT_EQ(queues.popMany("t", 0, 100, 0, out), size_t(2));
+    LOGOS_ASSERT_TRUE(out[0] == "hot:9999" && out[1] == "cold:0");
+}
+
+LOGOS_TEST(topic_queues_topic_policy_overrides_the_default) {
+    TopicQueues queues;
+    queues.setTopicPolicy("state", policyOf(TopicQueues::Overflow::DropOldest));
+    queues.setBounds(1, 4096);
+
+    LOGOS_ASSERT_TRUE(queues.push("state", "old"));
+    LOGOS_ASSERT_TRUE(queues.push("state", "new"));
+    LOGOS_ASSERT_TRUE(queues.push("log", "old"));
+    LOGOS_ASSERT_FALSE(queues.push("log", "new"));
+
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("state", 0, out));
+    LOGOS_ASSERT_TRUE(out == "new");
+    LOGOS_ASSERT_TRUE(queues.pop("log", 0, out));
+    LOGOS_ASSERT_TRUE(out == "old");
+}
+
+// Replacing the policies drops the ones left out, as a second config does.
+LOGOS_TEST(topic_queues_topic_policies_replace_drops_stale_topics) {
+    TopicQueues queues;
+    queues.setBounds(1, 4096);
+    queues.setTopicPolicies({{"state", policyOf(TopicQueues::Overflow::DropOldest)}});
+    queues.setTopicPolicies({{"other", policyOf(TopicQueues::Overflow::DropOldest)}});
+
+    LOGOS_ASSERT_TRUE(queues.push("state", "old"));
+    LOGOS_ASSERT_FALSE(queues.push("state", "new"));
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("state", 0, out));
+    LOGOS_ASSERT_TRUE(out == "old");
+}
+
+namespace {
+
+double queuedBytes(const TopicQueues& queues) {
+    for (const auto& m : queues.metrics()) {
+        if (m.name == "libp2p_module_gossipsub_queued_bytes") return m.value;
+    }
+    return -1;
+}
+
+}  // namespace
+
+LOGOS_TEST(topic_queues_gauge_tracks_bytes_across_topics) {
+    TopicQueues queues;
+    queues.setBounds(1024, 4096);
+    LOGOS_ASSERT_EQ(queuedBytes(queues), 0.0);
+
+    LOGOS_ASSERT_TRUE(queues.push("a", std::string(100, 'a')));
+    LOGOS_ASSERT_TRUE(queues.push("b", std::string(50, 'b')));
+    LOGOS_ASSERT_FALSE(queues.push("b", std::string(5000, 'b')));  // over the topic bound
+    LOGOS_ASSERT_EQ(queuedBytes(queues), 150.0);
+
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("a", 0, out));
+    LOGOS_ASSERT_EQ(queuedBytes(queues), 50.0);
+    queues.release("b");
+    LOGOS_ASSERT_EQ(queuedBytes(queues), 0.0);
+}
+
+// At the budget, a topic under its fair share takes room from the topic
+// furthest over its own, instead of being starved by it.
+LOGOS_TEST(topic_queues_budget_evicts_from_the_topic_over_its_share) {
+    for (auto backend : {TopicQueues::Backend::Deque, TopicQueues::Backend::Ring}) {
+        TopicQueues queues;
+        queues.setBackend(backend);
+        queues.setBounds(1024, 1000);
+        queues.setTotalMaxBytes(1000);
+
+        for (int i = 0; i < 10; ++i) LOGOS_ASSERT_TRUE(queues.push("hot", std::string(100, 'h')));
+        LOGOS_ASSERT_EQ(queuedBytes(queues), 1000.0);
+
+        // The hot topic is now over its half; more of it is refused.
+        LOGOS_ASSERT_FALSE(queues.push("hot", std::string(100, 'h')));
+        LOGOS_ASSERT_TRUE(queues.push("cold", std::string(100, 'c')));
+        LOGOS_ASSERT_TRUE(queues.push("cold", std::string(100, 'c')));
+        LOGOS_ASSERT_EQ(queuedBytes(queues), 1000.0);
+        LOGOS_ASSERT_EQ(droppedFor(queues, "hot", "budget"), 3.0);
+
+        std::vector<std::string> out;
+        LOGOS_ASSERT_EQ(queues.popMany("cold", 0, 100, 0, out), size_t(2));
+        out.clear();
+        LOGOS_ASSERT_EQ(queues.popMany("hot", 0, 100, 0, out), size_t(8));
+    }
+}
+
+// A topic over its share that drops its oldest anyway makes room from itself.
+LOGOS_TEST(topic_queues_budget_lets_drop_oldest_topics_roll_over) {
+    TopicQueues queues;
+    queues.setPolicy(policyOf(TopicQueues::Overflow::DropOldest));
+    queues.setBounds(1024, 1000);
+    queues.setTotalMaxBytes(300);
+
+    for (int i = 0; i < 5; ++i) LOGOS_ASSERT_TRUE(queues.push("t", std::to_string(i) + std::string(99, 'x')));
+    LOGOS_ASSERT_EQ(queuedBytes(queues), 300.0);
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(out[0] == '2');
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "budget"), 2.0);
+}
+
+LOGOS_TEST(topic_queues_budget_of_zero_is_unlimited) {
+    TopicQueues queues;
+    queues.setBounds(1024, 1 << 20);
+    queues.setTotalMaxBytes(0);
+    for (int i = 0; i < 64; ++i) {
+        LOGOS_ASSERT_TRUE(queues.push("t" + std::to_string(i), std::string(1 << 16, 'x')));
+    }
+    LOGOS_ASSERT_EQ(queuedBytes(queues), double(64 << 16));
+}
+
+namespace {
+
+// A fresh directory for segment files, removed with everything in it.
+struct SpillDir {
+    std::string path;
+    SpillDir() {
+        char tmpl[] = "/tmp/topic-queues-spill-XXXXXX";
+        path = mkdtemp(tmpl);
+    }
+    ~SpillDir() { std::filesystem::remove_all(path); }
+    size_t files() const {
+        auto it = std::filesystem::directory_iterator(path);
+        return static_cast<size_t>(std::distance(it, std::filesystem::directory_iterator()));
+    }
+};
+
+// Bytes this process has mapped from files under `dir`; the files are unlinked,
+// so this is the disk they take.
+size_t mappedUnder(const std::string& dir) {
+    std::ifstream maps("/proc/self/maps");
+    size_t total = 0;
+    std::string line;
+    while (std::getline(maps, line)) {
+        if (line.find(dir + "/") == std::string::npos) continue;
+        const size_t dash = line.find('-');
+        const size_t space = line.find(' ');
+        total += std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16) -
+                 std::stoull(line.substr(0, dash), nullptr, 16);
+    }
+    return total;
+}
+
+double spillMetric(const TopicQueues& queues, const std::string& name, const std::string& topic) {
+    for (const auto& m : queues.metrics()) {
+        if (m.name != name) continue;
+        if (topic.empty() || m.labels.at("topic") == topic) return m.value;
+    }
+    return -1;
+}
+
+}  // namespace
+
+// Small segments, so the log rolls over and maps one oversized record on its
+// own.
+LOGOS_TEST(spill_log_is_fifo_across_segments_and_leaves_no_files) {
+    SpillDir dir;
+    std::atomic<size_t> diskBytes{0};
+    {
+        SpillLog log(dir.path + "/t", diskBytes, 64);
+        const SpillLog::TimePoint t0 = std::chrono::steady_clock::now();
+        std::vector<std::string> sent;
+        for (int i = 0; i < 20; ++i) {
+            sent.push_back(std::to_string(i) + std::string(static_cast<size_t>(i * 3), 'x'));
+        }
+        sent.push_back(std::string(200, 'y'));
+        for (size_t i = 0; i < sent.size(); ++i) {
+            LOGOS_ASSERT_TRUE(log.append(sent[i], t0 + std::chrono::milliseconds(i), SIZE_MAX));
+        }
+        LOGOS_ASSERT_EQ(log.count(), sent.size());
+        LOGOS_ASSERT_EQ(dir.files(), size_t(0));
+
+        std::string out;
+        SpillLog::TimePoint queuedAt;
+        LOGOS_ASSERT_FALSE(log.pop(out, queuedAt, 0));  // too large, and stays put
+        for (size_t i = 0; i < sent.size(); ++i) {
+            LOGOS_ASSERT_TRUE(log.oldest(queuedAt) && queuedAt == t0 + std::chrono::milliseconds(i));
+            LOGOS_ASSERT_TRUE(log.pop(out, queuedAt));
+            LOGOS_ASSERT_TRUE(out == sent[i]);
+            LOGOS_ASSERT_TRUE(queuedAt == t0 + std::chrono::milliseconds(i));
+        }
+        LOGOS_ASSERT_FALSE(log.pop(out, queuedAt));
+        LOGOS_ASSERT_FALSE(log.oldest(queuedAt));
+        LOGOS_ASSERT_EQ(diskBytes.load(), size_t(0));
+        LOGOS_ASSERT_EQ(mappedUnder(dir.path), size_t(0));
+
+        LOGOS_ASSERT_TRUE(log.append("again", t0, SpillLog::recordBytes(5)));
+        LOGOS_ASSERT_EQ(diskBytes.load(), SpillLog::recordBytes(5));
+    }
+    LOGOS_ASSERT_EQ(diskBytes.load(), size_t(0));
+}
+
+// The budget counts whole segments, and the last one is cut short to fit it.
+LOGOS_TEST(spill_log_charges_segments_against_the_budget) {
+    SpillDir dir;
+    std::atomic<size_t> diskBytes{0};
+    {
+        SpillLog log(dir.path + "/t", diskBytes, 64);
+        const auto now = std::chrono::steady_clock::now();
+        LOGOS_ASSERT_TRUE(log.append("abcd", now, 100));
+        LOGOS_ASSERT_EQ(diskBytes.load(), size_t(64));
+
+        // Four records fill the first segment and two the 36 bytes left.
+        size_t appended = 1;
+        while (log.append("abcd", now, 100)) ++appended;
+        LOGOS_ASSERT_EQ(appended, size_t(6));
+        LOGOS_ASSERT_EQ(diskBytes.load(), size_t(100));
+
+        // A partly read head keeps its segment.
+        std::string out;
+        SpillLog::TimePoint queuedAt;
+        LOGOS_ASSERT_TRUE(log.pop(out, queuedAt));
+        LOGOS_ASSERT_EQ(diskBytes.load(), size_t(100));
+        for (int i = 0; i < 3; ++i) LOGOS_ASSERT_TRUE(log.pop(out, queuedAt));
+        LOGOS_ASSERT_EQ(diskBytes.load(), size_t(36));
+    }
+    LOGOS_ASSERT_EQ(diskBytes.load(), size_t(0));
+}
+
+LOGOS_TEST(spill_log_fails_cleanly_without_its_directory) {
+    std::atomic<size_t> diskBytes{0};
+    SpillLog log("/nonexistent/topic-queues-spill/t", diskBytes);
+    LOGOS_ASSERT_FALSE(log.append("m", std::chrono::steady_clock::now(), SIZE_MAX));
+    LOGOS_ASSERT_TRUE(log.empty());
+    LOGOS_ASSERT_EQ(diskBytes.load(), size_t(0));
+}
+
+// A stalled consumer loses nothing while the disk budget lasts, and gets the
+// topic back in order: memory first, then the log, then memory again.
+LOGOS_TEST(topic_queues_spill_keeps_order_through_a_stall) {
+    for (auto backend : {TopicQueues::Backend::Deque, TopicQueues::Backend::Ring}) {
+        SpillDir dir;
+        TopicQueues queues;
+        queues.setBackend(backend);
+        queues.setSpill(dir.path, 1 << 20);
+        queues.setBounds(2, 4096);
+
+        for (int i = 0; i < 6; ++i) LOGOS_ASSERT_TRUE(queues.push("t", "m" + std::to_string(i)));
+        LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_queue_depth", "t"), 2.0);
+        LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_queue_spilled", "t"), 4.0);
+        // One segment, cut to the budget.
+        LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_spilled_bytes", ""),
+                        double(1 << 20));
+        LOGOS_ASSERT_EQ(droppedFor(queues, "t", "full"), 0.0);
+
+        std::string out;
+        for (int i = 0; i < 3; ++i) {
+            LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+            LOGOS_ASSERT_TRUE(out == "m" + std::to_string(i));
+        }
+        // Still behind the log, though the deque has room again.
+        LOGOS_ASSERT_TRUE(queues.push("t", "m6"));
+        std::vector<std::string> rest;
+        LOGOS_ASSERT_EQ(queues.popMany("t", 0, 16, 0, rest), size_t(4));
+        for (size_t i = 0; i < rest.size(); ++i) {
+            LOGOS_ASSERT_TRUE(rest[i] == "m" + std::to_string(i + 3));
+        }
+        LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_spilled_bytes", ""), 0.0);
+
+        LOGOS_ASSERT_TRUE(queues.push("t", "m7"));
+        LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_queue_depth", "t"), 1.0);
+        LOGOS_ASSERT_EQ(dir.files(), size_t(0));
+    }
+}
+
+LOGOS_TEST(topic_queues_spill_drops_once_the_disk_budget_is_spent) {
+    SpillDir dir;
+    TopicQueues queues;
+    queues.setSpill(dir.path, 2 * SpillLog::recordBytes(2));
+    queues.setBounds(1, 4096);
+
+    for (int i = 0; i < 3; ++i) LOGOS_ASSERT_TRUE(queues.push("t", "m" + std::to_string(i)));
+    LOGOS_ASSERT_FALSE(queues.push("t", "m3"));
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "full"), 1.0);
+    // Over the byte bound never spills either.
+    LOGOS_ASSERT_FALSE(queues.push("big", std::string(5000, 'x')));
+    LOGOS_ASSERT_EQ(droppedFor(queues, "big", "full"), 1.0);
+
+    queues.release("t");
+    LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_spilled_bytes", ""), 0.0);
+}
+
+// Stalled topics share the budget: each one's segments count against it in
+// full, so the disk in use never passes it however many topics spill.
+LOGOS_TEST(topic_queues_spill_budget_bounds_the_disk_many_topics_use) {
+    SpillDir dir;
+    TopicQueues queues;
+    const size_t budget = 10 << 20;
+    queues.setSpill(dir.path, budget);
+    queues.setBounds(1, 4096);
+
+    const int kTopics = 8;
+    for (int t = 0; t < kTopics; ++t) {
+        const std::string topic = "t" + std::to_string(t);
+        for (int i = 0; i < 3; ++i) queues.push(topic, "m" + std::to_string(i));
+    }
+    // Two full segments and one cut to the 2 MiB left, then nothing.
+    LOGOS_ASSERT_EQ(mappedUnder(dir.path), budget);
+    LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_spilled_bytes", ""), double(budget));
+    LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_queue_spilled", "t2"), 2.0);
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t2", "full"), 0.0);
+    for (int t = 3; t < kTopics; ++t) {
+        LOGOS_ASSERT_EQ(droppedFor(queues, "t" + std::to_string(t), "full"), 2.0);
+    }
+
+    // A drained topic hands its segment back for the next stall.
+    std::string out;
+    for (int i = 0; i < 3; ++i) LOGOS_ASSERT_TRUE(queues.pop("t0", 0, out));
+    LOGOS_ASSERT_EQ(mappedUnder(dir.path), budget - (4 << 20));
+    LOGOS_ASSERT_TRUE(queues.push("t3", "late"));
+    LOGOS_ASSERT_TRUE(queues.push("t3", "later"));
+    LOGOS_ASSERT_EQ(mappedUnder(dir.path), budget);
+}
+
+// What the node budget refuses goes to disk too, while a policy that discards
+// on purpose keeps doing so.
+LOGOS_TEST(topic_queues_spill_takes_what_the_budget_refuses) {
+    SpillDir dir;
+    TopicQueues queues;
+    queues.setSpill(dir.path, 1 << 20);
+    queues.setBounds(1024, 4096);
+    queues.setTotalMaxBytes(200);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", std::string(100, 'a')));
+    LOGOS_ASSERT_TRUE(queues.push("t", std::string(100, 'b')));
+    LOGOS_ASSERT_TRUE(queues.push("t", std::string(100, 'c')));
+    LOGOS_ASSERT_EQ(queuedBytes(queues), 200.0);
+    LOGOS_ASSERT_EQ(spillMetric(queues, "libp2p_module_gossipsub_queue_spilled", "t"), 1.0);
+    LOGOS_ASSERT_EQ(droppedFor(queues, "t", "budget"), -1.0);  // none, so no series
+
+    std::string out;
+    for (char c : {'a', 'b', 'c'}) {
+        LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+        LOGOS_ASSERT_TRUE(out == std::string(100, c));
+    }
+
+    TopicQueues evicting;
+    evicting.setSpill(dir.path, 1 << 20);
+    evicting.setBounds(1, 4096);
+    evicting.setPolicy(policyOf(TopicQueues::Overflow::DropOldest));
+    LOGOS_ASSERT_TRUE(evicting.push("t", "old"));
+    LOGOS_ASSERT_TRUE(evicting.push("t", "new"));
+    LOGOS_ASSERT_EQ(spillMetric(evicting, "libp2p_module_gossipsub_queue_spilled", "t"), -1.0);
+    LOGOS_ASSERT_EQ(droppedFor(evicting, "t", "evicted"), 1.0);
+}
+
+namespace {
+
+const Metric* seriesFor(const std::vector<Metric>& series, const std::string& name,
+                        const std::string& topic) {
+    for (const auto& m : series) {
+        if (m.name == name && m.labels.at("topic") == topic) return &m;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+// Only what a consumer takes is timed; the age gauge follows the oldest message
+// still waiting, and goes back to 0 once the topic is drained.
+LOGOS_TEST(topic_queues_time_messages_from_push_to_take) {
+    for (auto backend : {TopicQueues::Backend::Deque, TopicQueues::Backend::Ring}) {
+        TopicQueues queues;
+        queues.setBackend(backend);
+        queues.setBounds(2, 4096);
+        queues.setPolicy(policyOf(TopicQueues::Overflow::DropOldest));
+
+        LOGOS_ASSERT_TRUE(queues.push("t", "evicted"));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        LOGOS_ASSERT_TRUE(queues.push("t", "a"));
+        LOGOS_ASSERT_TRUE(queues.push("t", "b"));
+        auto series = queues.metrics();
+        const Metric* age = seriesFor(series, "libp2p_module_gossipsub_queue_oldest_age_seconds", "t");
+        LOGOS_ASSERT_TRUE(age != nullptr);
+        // "evicted" is gone, so the age is that of "a", pushed after the sleep.
+        LOGOS_ASSERT_LT(age->value, 0.1);
+        const Metric* residency =
+            seriesFor(series, "libp2p_module_gossipsub_queue_residency_seconds", "t");
+        LOGOS_ASSERT_TRUE(residency != nullptr && residency->type == "histogram");
+        LOGOS_ASSERT_EQ(residency->count, uint64_t(0));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        series = queues.metrics();
+        LOGOS_ASSERT_GE(seriesFor(series, "libp2p_module_gossipsub_queue_oldest_age_seconds", "t")->value,
+                        0.02);
+
+        std::string out;
+        LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+        LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+        series = queues.metrics();
+        LOGOS_ASSERT_EQ(seriesFor(series, "libp2p_module_gossipsub_queue_oldest_age_seconds", "t")->value,
+                        0.0);
+        residency = seriesFor(series, "libp2p_module_gossipsub_queue_residency_seconds", "t");
+        LOGOS_ASSERT_EQ(residency->count, uint64_t(2));
+        LOGOS_ASSERT_GE(residency->sum, 0.04);
+    }
+}
+
+// A spilled message keeps the stamp it was pushed with.
+LOGOS_TEST(topic_queues_time_spilled_messages_from_their_push) {
+    SpillDir dir;
+    TopicQueues queues;
+    queues.setSpill(dir.path, 1 << 20);
+    queues.setBounds(1, 4096);
+
+    LOGOS_ASSERT_TRUE(queues.push("t", "memory"));
+    LOGOS_ASSERT_TRUE(queues.push("t", "disk"));
+    std::string out;
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    LOGOS_ASSERT_GE(spillMetric(queues, "libp2p_module_gossipsub_queue_oldest_age_seconds", "t"),
+                    0.02);
+    LOGOS_ASSERT_TRUE(queues.pop("t", 0, out));
+    LOGOS_ASSERT_TRUE(out == "disk");
+    const auto series = queues.metrics();
+    const Metric* residency = seriesFor(series, "libp2p_module_gossipsub_queue_residency_seconds", "t");
+    LOGOS_ASSERT_EQ(residency->count, uint64_t(2));
+    LOGOS_ASSERT_GE(residency->sum, 0.02);
+}